@@ -0,0 +1,64 @@
+// GatewayTCPtoRTU.ino
+// Demonstrates a pass-through Modbus TCP to RTU gateway: up to four SCADA clients
+// share one RS-485 bus through ModbusRTUMaster. Requests are queued per connection
+// and served round-robin, identical concurrent reads are answered by one RTU transaction.
+// Uses an Ethernet shield for Modbus TCP and Serial1 for Modbus RTU.
+
+// Include Arduino core and Ethernet libraries
+#include <Arduino.h>
+#include <Ethernet.h>
+
+// Include the Modbus RTU master and gateway libraries
+#include <ModbusGateway.h>
+#include <ModbusRTUMaster.h>
+
+// Network settings of the gateway
+byte mac[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xED};
+IPAddress ip(192, 168, 1, 177);
+
+// Modbus TCP server on the standard port
+EthernetServer server(502);
+
+// Storage for the accepted upstream connections
+EthernetClient clients[4];
+
+// Initialize the Modbus RTU master and the gateway
+ModbusRTUMaster master;
+ModbusGateway gateway;
+
+void setup() {
+  // Initialize Serial1 for Modbus RTU communication at 19200 baud
+  Serial1.begin(19200);
+  Ethernet.begin(mac, ip);
+  server.begin();
+
+  // Initialize the RTU master: max PDU size, queue size 2, Serial stream, baud rate, UART config,
+  //                            RS485 receive enable pin (3), transmit enable pin (4)
+  master.begin(MB_PDU_MAX_SIZE, 2, &Serial1, 19200, UartConfig::Mode_8E1, 3, 4);
+
+  // Initialize the gateway: 4 upstream connections, 4 queued requests per connection
+  gateway.begin(&master, 4, 4);
+  // Allow each SCADA client 20 requests per second with bursts of 5
+  gateway.setRateLimit(20, 5);
+}
+
+void loop() {
+  // Hand over new connections to a free slot
+  EthernetClient client = server.accept();
+  if (client) {
+    for (uint8_t i = 0; i < 4; i++) {
+      if (!clients[i].connected()) {
+        // Release the slot of the previous connection before its client object is reused
+        gateway.removeUpstream(&clients[i]);
+        clients[i].stop();
+        clients[i] = client;
+        if (!gateway.addUpstream(&clients[i])) clients[i].stop();
+        break;
+      }
+    }
+  }
+
+  // Process the gateway and the RTU bus
+  gateway.loop();
+  master.loop();
+}
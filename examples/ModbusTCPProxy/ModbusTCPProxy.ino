@@ -0,0 +1,71 @@
+// ModbusTCPProxy.ino
+// Demonstrates a Modbus TCP to TCP proxy: any number of SCADA clients read a PLC that
+// accepts only a few Modbus TCP connections. The proxy keeps two pooled connections to
+// the PLC, pipelines up to four requests on each and maps every response back to the
+// transaction ID of the client that asked for it.
+// Uses an Ethernet shield for both sides.
+
+// Include Arduino core and Ethernet libraries
+#include <Arduino.h>
+#include <Ethernet.h>
+
+// Include the Modbus TCP client and gateway libraries
+#include <ModbusGateway.h>
+#include <ModbusTCPClient.h>
+
+// Network settings of the proxy
+byte mac[] = {0xDE, 0xAD, 0xBE, 0xEF, 0xFE, 0xEE};
+IPAddress ip(192, 168, 1, 178);
+
+// Address of the PLC
+IPAddress plcIp(192, 168, 1, 10);
+
+// Modbus TCP server on the standard port
+EthernetServer server(502);
+
+// Storage for the accepted upstream connections
+EthernetClient clients[4];
+
+// The pooled connections to the PLC
+EthernetClient plcConnections[2];
+
+// Initialize the Modbus TCP client and the gateway
+ModbusTCPClient plc;
+ModbusGateway gateway;
+
+void setup() {
+  Ethernet.begin(mac, ip);
+  server.begin();
+
+  // Initialize the TCP client: 8 ADUs, max PDU size, 2 connection slots
+  plc.begin(8, MB_PDU_MAX_SIZE, 2);
+  // Open two connections to unit 1 of the PLC, each with 4 pipelined requests and a queue of 4
+  plc.addPooledClient(1, 4, 4, &plcConnections[0], plcIp);
+  plc.addPooledClient(1, 4, 4, &plcConnections[1], plcIp);
+
+  // Initialize the gateway: 1 route, 4 upstream connections, 4 queued requests per connection
+  gateway.begin(1, 4, 4);
+  // Unit 1 goes to the PLC, up to 8 requests in flight (2 connections x window 4)
+  gateway.addRoute(1, 1, &plc, 8);
+}
+
+void loop() {
+  // Hand over new connections to a free slot
+  EthernetClient client = server.accept();
+  if (client) {
+    for (uint8_t i = 0; i < 4; i++) {
+      if (!clients[i].connected()) {
+        // Release the slot of the previous connection before its client object is reused
+        gateway.removeUpstream(&clients[i]);
+        clients[i].stop();
+        clients[i] = client;
+        if (!gateway.addUpstream(&clients[i])) clients[i].stop();
+        break;
+      }
+    }
+  }
+
+  // Process the gateway and the PLC connections
+  gateway.loop();
+  plc.loop();
+}
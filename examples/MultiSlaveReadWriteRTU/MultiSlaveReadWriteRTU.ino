@@ -1,6 +1,7 @@
 // MultiSlaveReadWriteRTU.ino
 // Demonstrates Modbus RTU communication with multiple slaves, writing and reading
-// a custom data structure (MyData) using Serial1 for Modbus and Serial for debugging.
+// a custom data structure (MyData) mapped onto registers by a RegisterSchema,
+// using Serial1 for Modbus and Serial for debugging.
 // Compatible with Arduino Mega or boards with multiple serial ports.
 
 // Include Arduino core library for basic functionality
@@ -16,15 +17,23 @@ struct MyData {
   uint16_t val16;  // 16-bit value
 };
 
+// Register map of MyData on the slaves, independent of the struct padding:
+// val8 in register 0, val32 in registers 1-2 (high word first), val16 in register 3
+using MyDataSchema = RegisterSchema<MyData,
+                                    MB_FIELD(MyData, val8, 0),
+                                    MB_FIELD(MyData, val32, 1),
+                                    MB_FIELD(MyData, val16, 3)>;
+
 // Array to store data for three slaves
 MyData data[3];
 
+// Record decoded from the last read response
+MyData received;
+
 // Initialize the Modbus RTU master
 ModbusRTUMaster master;
 
-// Initialize Slaves objects for writing and reading
-// slavesWrite: Slaves 1, 2, 3 for writing, no delays
-Slaves slavesWrite({1, 2, 3});
+// Initialize the Slaves object for reading
 // slavesRead: Slaves 1, 2, 3 for reading, 0 ms item delay, 1000 ms repeat delay
 Slaves slavesRead({1, 2, 3}, 0, 1000);
 
@@ -39,16 +48,12 @@ void callback(PDU& pdu) {
       Serial.print("Received from slaveID: ");
       Serial.println(pdu.getSlaveId());  // Print the responding slave ID
 
-      // Retrieve the array of MyData structures from the PDU
-      const MyData* data = pdu.getDataArray<MyData>();
-      for (size_t i = 0; i < 3; i++) {
-        // Print each MyData instance's fields
-        Serial.print(data[i].val8);
-        Serial.print(' ');
-        Serial.print(data[i].val32);
-        Serial.print(' ');
-        Serial.println(data[i].val16);
-      }
+      // The response was decoded into received before the callback
+      Serial.print(received.val8);
+      Serial.print(' ');
+      Serial.print(received.val32);
+      Serial.print(' ');
+      Serial.println(received.val16);
     }
   } else {
     // Handle error cases
@@ -82,11 +87,13 @@ void setup() {
   // Create a callback object for asynchronous operations
   modbusCallback cb(callback);
 
-  // Write holding registers to slaves 1, 2, 3 at address 0
-  master.writeHoldingRegisters(slavesWrite, 0, data, 3, cb);
+  // Write one record to each of the slaves 1, 2, 3 at address 0
+  for (uint8_t i = 0; i < 3; i++) {
+    master.writeRecord<MyDataSchema>(i + 1, 0, &data[i], cb);
+  }
 
-  // Read holding registers from slaves 1, 2, 3 at address 0, repeating every 1000 ms
-  master.readHoldingRegisters<MyData>(slavesRead, 0, 3, cb);
+  // Read the record from slaves 1, 2, 3 at address 0, repeating every 1000 ms
+  master.readRecord<MyDataSchema>(slavesRead, 0, &received, cb);
 }
 
 void loop() {
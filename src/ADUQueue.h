@@ -17,11 +17,12 @@
 template <typename T>
 class ADUQueue {
  private:
-  uint8_t _head = 0;       ///< Index of the first item in the queue.
-  uint8_t _tail = 0;       ///< Index where the next item will be added.
-  uint8_t _count = 0;      ///< Number of items in the queue.
-  uint8_t _queueSize = 0;  ///< Maximum queue capacity (set by init).
-  T** _items = nullptr;    ///< Array of pointers to ADU objects.
+  uint8_t _head = 0;        ///< Index of the first item in the queue.
+  uint8_t _tail = 0;        ///< Index where the next item will be added.
+  uint8_t _count = 0;       ///< Number of items in the queue.
+  uint8_t _queueSize = 0;   ///< Maximum queue capacity (set by init).
+  T** _items = nullptr;     ///< Array of pointers to ADU objects.
+  bool _ownsItems = false;  ///< _items was allocated by init().
 
  public:
   /**
@@ -42,6 +43,13 @@ class ADUQueue {
    */
   void init(uint8_t queueSize);
 
+  /**
+   * @brief Initializes the queue on caller-provided storage.
+   * @param queueSize Maximum number of ADUs the queue can hold.
+   * @param items Array of queueSize pointers, owned by the caller.
+   */
+  void init(uint8_t queueSize, T** items);
+
   /**
    * @brief Adds an ADU to the queue.
    * @param item Pointer to the ADU to add.
@@ -94,6 +102,26 @@ class ADUQueue {
    * @return uint8_t Number of ADUs in the queue.
    */
   uint8_t count() const;
+
+  /**
+   * @brief Checks if the queue is full.
+   * @return bool True if no more ADUs can be added.
+   */
+  bool isFull() const;
+
+  /**
+   * @brief Returns the ADU at a position without removing it.
+   * @param ix Position counted from the head (0 to count() - 1).
+   * @return T* The ADU, or nullptr if out of range.
+   */
+  T* at(uint8_t ix) const;
+
+  /**
+   * @brief Removes the ADU at a position, keeping the order of the others.
+   * @param ix Position counted from the head (0 to count() - 1).
+   * @return bool True if removed, false if out of range.
+   */
+  bool removeAt(uint8_t ix);
 };
 
 #include "ADUQueue.tpp"
\ No newline at end of file
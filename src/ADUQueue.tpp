@@ -7,13 +7,22 @@ ADUQueue<T>::ADUQueue() {}
 
 template <typename T>
 ADUQueue<T>::~ADUQueue() {
-  delete[] _items;  // Note: T* pointers are managed by the caller (e.g., ModbusRTUMaster)
+  if (_ownsItems) delete[] _items;  // Note: T* pointers are managed by the caller (e.g., ModbusRTUMaster)
 }
 
 template <typename T>
 void ADUQueue<T>::init(uint8_t queueSize) {
   _queueSize = queueSize;
   _items = new T* [_queueSize] {};  // Allocate and initialize to nullptr
+  _ownsItems = true;
+}
+
+template <typename T>
+void ADUQueue<T>::init(uint8_t queueSize, T** items) {
+  _queueSize = queueSize;
+  _items = items;
+  _ownsItems = false;
+  for (uint8_t i = 0; i < _queueSize; i++) _items[i] = nullptr;
 }
 
 template <typename T>
@@ -100,4 +109,28 @@ void ADUQueue<T>::clear() {
 template <typename T>
 uint8_t ADUQueue<T>::count() const {
   return _count;
+}
+
+template <typename T>
+bool ADUQueue<T>::isFull() const {
+  return _count >= _queueSize;
+}
+
+template <typename T>
+T* ADUQueue<T>::at(uint8_t ix) const {
+  if (ix >= _count) return nullptr;
+  return _items[(_head + ix) % _queueSize];
+}
+
+template <typename T>
+bool ADUQueue<T>::removeAt(uint8_t ix) {
+  if (ix >= _count) return false;
+  // Shift the following items one position towards the head
+  for (uint8_t i = ix; i + 1 < _count; ++i) {
+    _items[(_head + i) % _queueSize] = _items[(_head + i + 1) % _queueSize];
+  }
+  _tail = (_tail + _queueSize - 1) % _queueSize;
+  _items[_tail] = nullptr;
+  _count--;
+  return true;
 }
\ No newline at end of file
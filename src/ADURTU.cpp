@@ -6,8 +6,7 @@
 ADURTU::ADURTU() {}
 
 ADURTU::~ADURTU() {
-  delete[] _TXADURTUframe;
-  delete[] _RXADURTUframe;
+  if (_ownsFrame) delete[] _TXADURTUframe;
 }
 
 void ADURTU::clear() {
@@ -16,19 +15,35 @@ void ADURTU::clear() {
 }
 
 void ADURTU::init(uint8_t PDUSize) {
-  _PDUSize = PDUSize;  // Set PDU size (16-253 bytes, excluding RTU header and CRC)
   _TXADURTUframe = new uint8_t[MB_ADU_RTU_HEADER_LEN + PDUSize + MB_ADU_RTU_CRC_LEN];
-  _RXADURTUframe = new uint8_t[MB_ADU_RTU_HEADER_LEN + PDUSize + MB_ADU_RTU_CRC_LEN];
+  _ownsFrame = true;
+  setFrame(PDUSize);
+}
+
+void ADURTU::init(uint8_t PDUSize, uint8_t* frame) {
+  _TXADURTUframe = frame;
+  _ownsFrame = false;
+  setFrame(PDUSize);
+}
+
+void ADURTU::setFrame(uint8_t PDUSize) {
+  _PDUSize = PDUSize;  // Set PDU size (16-253 bytes, excluding RTU header and CRC)
   _TXPDUbuffer = _TXADURTUframe + MB_ADU_RTU_HEADER_LEN;        // Offset for PDU data
-  _RXPDUbuffer = _RXADURTUframe + MB_ADU_RTU_HEADER_LEN;        // Offset for PDU data
   _PDUresponseHead = _responseRTUHead + MB_ADU_RTU_HEADER_LEN;  // Offset for response header
 }
 
+void ADURTU::setReceiveFrame(uint8_t* rxFrame, uint8_t* spare) {
+  _RXADURTUframe = rxFrame;
+  _RXPDUbuffer = _RXADURTUframe + MB_ADU_RTU_HEADER_LEN;  // Offset for PDU data
+  _sparePDUbuffer = spare;
+}
+
 void ADURTU::setHead(uint8_t slave) {
   _TXADURTUframe[0] = _responseRTUHead[0] = slave;
 }
 
 void ADURTU::setCRC() {
+  if (_payload) return;  // Computed while the payload is sent
   crc16Set(_TXADURTUframe, _TXPDUbufferLen + MB_ADU_RTU_HEADER_LEN);
 }
 
@@ -58,6 +73,10 @@ uint16_t ADURTU::getExpectedResponseLen() const {
   return (uint16_t)_expectedResponseLen + MB_ADU_RTU_HEADER_LEN + MB_ADU_RTU_CRC_LEN;
 }
 
+bool ADURTU::isRepeating() const {
+  return _slaves.valid();
+}
+
 bool ADURTU::repeatIfNeeded() {
   if (!_slaves.valid()) return false;
   uint8_t prev = _slaves.getActive();
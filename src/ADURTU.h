@@ -25,11 +25,12 @@ class ADURTU : public PDU {
 
  private:
   uint8_t* _TXADURTUframe = nullptr;                                            ///< Transmit buffer for RTU ADU (slave ID + PDU + CRC).
-  uint8_t* _RXADURTUframe = nullptr;                                            ///< Receive buffer for RTU ADU.
+  uint8_t* _RXADURTUframe = nullptr;                                            ///< Receive buffer for RTU ADU, shared by the ADUs of a master.
   uint8_t _responseRTUHead[MB_ADU_RTU_HEADER_LEN + MB_PDU_MAX_RESPONSE_LEN]{};  ///< Expected response header.
   uint16_t _responseLen = 0;                                                    ///< Length of received ADU.
   Slaves _slaves;                                                               ///< Manages slave IDs for cyclic iteration.
   ModbusRTUMaster* _modbusRTUMaster = nullptr;                                  ///< Pointer to RTU master for repeat logic.
+  bool _ownsFrame = false;                                                      ///< TX frame was allocated by init().
 
   /**
    * @brief Resets the ADURTU state and clears buffers.
@@ -55,6 +56,20 @@ class ADURTU : public PDU {
    */
   uint8_t getSlaveId() const override;
 
+  /**
+   * @brief Sets the PDU size and the PDU view of the TX frame.
+   * @param PDUSize PDU size (16-253 bytes).
+   */
+  void setFrame(uint8_t PDUSize);
+
+  /**
+   * @brief Sets the receive buffers owned by the master.
+   * @details Only one RTU transaction is on the wire at a time, so all ADUs of a master receive into one frame.
+   * @param rxFrame Receive frame, PDUSize + 3 bytes.
+   * @param spare Spare PDU buffer for serving merged requests, PDUSize bytes.
+   */
+  void setReceiveFrame(uint8_t* rxFrame, uint8_t* spare);
+
  protected:
   /**
    * @brief Sets the RTU header with the specified slave ID.
@@ -86,6 +101,12 @@ class ADURTU : public PDU {
    */
   bool repeatIfNeeded() override;
 
+  /**
+   * @brief Checks if the ADU iterates over Slaves.
+   * @return bool True if a Slaves set is active.
+   */
+  bool isRepeating() const override;
+
  public:
   /**
    * @brief Default constructor.
@@ -95,13 +116,20 @@ class ADURTU : public PDU {
 
   /**
    * @brief Destructor.
-   * @details Frees dynamically allocated buffers.
+   * @details Frees the TX frame if it was allocated.
    */
   ~ADURTU();
 
   /**
-   * @brief Initializes buffers with user-defined PDU size.
+   * @brief Allocates the TX frame with user-defined PDU size.
    * @param PDUSize PDU size (16-253 bytes).
    */
   void init(uint8_t PDUSize);
+
+  /**
+   * @brief Initializes the TX frame on caller-provided storage.
+   * @param PDUSize PDU size (16-253 bytes).
+   * @param frame TX frame, PDUSize + 3 bytes owned by the caller.
+   */
+  void init(uint8_t PDUSize, uint8_t* frame);
 };
\ No newline at end of file
@@ -7,15 +7,28 @@ ADUTCP::ADUTCP() {}
 uint16_t ADUTCP::_transactionId = 0;
 
 void ADUTCP::init(uint8_t PDUSize) {
-  _PDUSize = PDUSize;  // Set PDU size (16-253 bytes, excluding MBAP header)
   _TXADUTCPframe = new uint8_t[MB_ADU_MBAP_LEN + PDUSize];
   _RXADUTCPframe = new uint8_t[MB_ADU_MBAP_LEN + PDUSize];
+  _ownsFrames = true;
+  setFrames(PDUSize);
+}
+
+void ADUTCP::init(uint8_t PDUSize, uint8_t* frames) {
+  _TXADUTCPframe = frames;
+  _RXADUTCPframe = frames + MB_ADU_MBAP_LEN + PDUSize;
+  _ownsFrames = false;
+  setFrames(PDUSize);
+}
+
+void ADUTCP::setFrames(uint8_t PDUSize) {
+  _PDUSize = PDUSize;  // Set PDU size (16-253 bytes, excluding MBAP header)
   _TXPDUbuffer = _TXADUTCPframe + MB_ADU_MBAP_LEN;        // Offset for PDU data
   _RXPDUbuffer = _RXADUTCPframe + MB_ADU_MBAP_LEN;        // Offset for PDU data
   _PDUresponseHead = _responseTCPHead + MB_ADU_MBAP_LEN;  // Offset for response header
 }
 
 ADUTCP::~ADUTCP() {
+  if (!_ownsFrames) return;
   delete[] _TXADUTCPframe;
   delete[] _RXADUTCPframe;
 }
@@ -28,6 +41,10 @@ uint8_t ADUTCP::getId() const {
   return _TXADUTCPframe[6];
 }
 
+uint8_t ADUTCP::getSlaveId() const {
+  return _TXADUTCPframe[6];
+}
+
 void ADUTCP::setMBAP(uint8_t slave) {
   _transactionId++;
   _TXADUTCPframe[0] = _responseTCPHead[0] = highByte(_transactionId);
@@ -39,6 +56,10 @@ void ADUTCP::setMBAP(uint8_t slave) {
   _TXADUTCPframe[6] = _responseTCPHead[6] = slave;                // Unit ID (slave ID)
 }
 
+void ADUTCP::setMBAPLength() {
+  _TXADUTCPframe[5] = _responseTCPHead[5] = _TXPDUbufferLen + 1;
+}
+
 bool ADUTCP::checkResponseMBAP() {
   if (_RXADUTCPframe[0] != _responseTCPHead[0] || _RXADUTCPframe[1] != _responseTCPHead[1]) {
     _err = MB_EX_LIB_INVALID_MBAP_TRANSACTION_ID;
@@ -66,6 +87,10 @@ uint16_t ADUTCP::getExpectedResponseLen() const {
   return (uint16_t)_expectedResponseLen + MB_ADU_MBAP_LEN;
 }
 
+bool ADUTCP::isRepeating() const {
+  return _slaves.valid();
+}
+
 bool ADUTCP::repeatIfNeeded() {
   if (!_slaves.valid()) return false;
   uint8_t prev = _slaves.getActive();
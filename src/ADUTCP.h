@@ -30,6 +30,13 @@ class ADUTCP : public PDU {
   Slaves _slaves;                                                         ///< Manages slave IDs for cyclic iteration.
   uint8_t _slave = 0xFF;                                                  ///< Slave ID for the current ADU.
   ModbusTCPClient* _modbusTCPClient = nullptr;                            ///< Pointer to TCP client for repeat logic.
+  bool _ownsFrames = false;                                               ///< Frames were allocated by init().
+
+  /**
+   * @brief Sets the PDU size and the PDU views of the frames.
+   * @param PDUSize PDU size (16-253 bytes).
+   */
+  void setFrames(uint8_t PDUSize);
 
  protected:
   /**
@@ -38,6 +45,11 @@ class ADUTCP : public PDU {
    */
   void setMBAP(uint8_t slave);
 
+  /**
+   * @brief Updates the MBAP length after the PDU was changed (e.g. merged by RequestCoalescer).
+   */
+  void setMBAPLength();
+
   /**
    * @brief Validates the response MBAP header.
    * @details Checks transaction ID, protocol ID, and unit ID.
@@ -76,6 +88,12 @@ class ADUTCP : public PDU {
    */
   bool repeatIfNeeded() override;
 
+  /**
+   * @brief Checks if the ADU iterates over Slaves.
+   * @return bool True if a Slaves set is active.
+   */
+  bool isRepeating() const override;
+
  public:
   /**
    * @brief Default constructor.
@@ -94,4 +112,17 @@ class ADUTCP : public PDU {
    * @param PDUSize PDU size (16-253 bytes).
    */
   void init(uint8_t PDUSize);
+
+  /**
+   * @brief Initializes buffers on caller-provided storage.
+   * @param PDUSize PDU size (16-253 bytes).
+   * @param frames TX and RX frame, 2 * (PDUSize + 7) bytes owned by the caller.
+   */
+  void init(uint8_t PDUSize, uint8_t* frames);
+
+  /**
+   * @brief Returns the slave ID from the MBAP header.
+   * @return uint8_t Slave ID.
+   */
+  uint8_t getSlaveId() const override;
 };
\ No newline at end of file
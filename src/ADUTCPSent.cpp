@@ -6,12 +6,20 @@
 ADUTCPSent::ADUTCPSent() {}
 
 ADUTCPSent::~ADUTCPSent() {
-  delete[] _adu;
+  if (_ownsAdu) delete[] _adu;
 }
 
 void ADUTCPSent::init(uint8_t size) {
   _size = size;
   _adu = new ADUTCP*[size]();  // Elements initialized to nullptr
+  _ownsAdu = true;
+}
+
+void ADUTCPSent::init(uint8_t size, ADUTCP** adu) {
+  _size = size;
+  _adu = adu;
+  _ownsAdu = false;
+  for (uint8_t i = 0; i < _size; ++i) _adu[i] = nullptr;
 }
 
 bool ADUTCPSent::add(ADUTCP* adu) {
@@ -55,9 +63,25 @@ bool ADUTCPSent::isEmpty() const {
   return true;
 }
 
+uint8_t ADUTCPSent::count() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < _size; ++i) {
+    if (_adu[i]) n++;
+  }
+  return n;
+}
+
 bool ADUTCPSent::hasFree() const {
   for (uint8_t i = 0; i < _size; ++i) {
     if (!_adu[i]) return true;
   }
   return false;
-}
\ No newline at end of file
+}
+
+uint8_t ADUTCPSent::size() const {
+  return _size;
+}
+
+ADUTCP* ADUTCPSent::at(uint8_t ix) const {
+  return ix < _size ? _adu[ix] : nullptr;
+}
@@ -34,6 +34,13 @@ class ADUTCPSent {
    */
   void init(uint8_t size);
 
+  /**
+   * @brief Initializes the buffer on caller-provided storage.
+   * @param size Maximum number of ADUs the buffer can hold.
+   * @param adu Array of size pointers, owned by the caller.
+   */
+  void init(uint8_t size, ADUTCP** adu);
+
   /**
    * @brief Adds a sent ADU to the buffer.
    * @param adu Pointer to the ADUTCP object to add.
@@ -63,13 +70,33 @@ class ADUTCPSent {
    */
   bool isEmpty() const;
 
+  /**
+   * @brief Returns the number of ADUs awaiting response.
+   * @return uint8_t Number of stored ADUs.
+   */
+  uint8_t count() const;
+
   /**
    * @brief Checks if there is free space in the buffer.
    * @return bool True if the buffer has free space, false otherwise.
    */
   bool hasFree() const;
 
+  /**
+   * @brief Returns the capacity of the buffer.
+   * @return uint8_t Number of slots.
+   */
+  uint8_t size() const;
+
+  /**
+   * @brief Returns the ADU stored in a slot without removing it.
+   * @param ix Slot index (0 to size() - 1).
+   * @return ADUTCP* The ADU, or nullptr if the slot is free.
+   */
+  ADUTCP* at(uint8_t ix) const;
+
  private:
   ADUTCP** _adu = nullptr;  ///< Array of pointers to sent ADUTCP objects.
   uint8_t _size = 0;        ///< Buffer capacity.
+  bool _ownsAdu = false;    ///< _adu was allocated by init().
 };
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "BlockTransfer.h"
+
+BlockTransfer::BlockTransfer() {}
+
+void BlockTransfer::reset() {
+  _next = 0;
+  _pending = 0;
+  _pumping = false;
+  _err = 0;
+  _failed = 0;
+  _failureCount = 0;
+}
+
+void BlockTransfer::fail(uint16_t offset, uint16_t count, uint16_t err) {
+  if (_err == 0) _err = err;
+  _failed += count;
+  const uint16_t address = _address + offset;
+  for (uint8_t i = 0; i < _failureCount; i++) {  // Merge with an adjacent range of the same error
+    BlockFailure& f = _failures[i];
+    if (f._err != err) continue;
+    if (f._address + f._count == address) {
+      f._count += count;
+      return;
+    }
+    if (address + count == f._address) {
+      f._address = address;
+      f._count += count;
+      return;
+    }
+  }
+  if (_failureCount == MB_BLOCK_MAX_FAILURES) return;  // Still counted in _failed
+  BlockFailure& f = _failures[_failureCount++];
+  f._address = address;
+  f._count = count;
+  f._err = err;
+}
+
+void BlockTransfer::setChunkSize(uint16_t count) { _chunk = count; }
+
+void BlockTransfer::setWindow(uint8_t window) { _window = window ? window : 1; }
+
+bool BlockTransfer::isBusy() const { return _busy; }
+
+uint16_t BlockTransfer::getErr() const { return _err; }
+
+uint16_t BlockTransfer::getFailedCount() const { return _failed; }
+
+uint8_t BlockTransfer::getFailureCount() const { return _failureCount; }
+
+bool BlockTransfer::getFailure(uint8_t ix, uint16_t& address, uint16_t& count, uint16_t& err) const {
+  if (ix >= _failureCount) return false;
+  address = _failures[ix]._address;
+  count = _failures[ix]._count;
+  err = _failures[ix]._err;
+  return true;
+}
+
+uint8_t BlockTransfer::getSlaveId() const { return _slave; }
+
+uint16_t BlockTransfer::getAddress() const { return _address; }
+
+uint16_t BlockTransfer::getCount() const { return _count; }
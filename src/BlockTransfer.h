@@ -0,0 +1,161 @@
+/**
+ * @file BlockTransfer.h
+ * @brief State of a read or write of a register or coil block larger than one Modbus transaction.
+ * @details Used by ModbusMaster::readBlock() and ModbusMaster::writeBlock(), which split the block into
+ *          max-size transactions, pipeline them and report the result with a single callback.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <Callback.h>
+
+#include "ModbusDef.h"
+
+class BlockTransfer;
+class ModbusMaster;
+
+/**
+ * @typedef blockCallback
+ * @brief Callback type for the completion of a block transfer.
+ */
+using blockCallback = Callback<void, BlockTransfer&>;
+
+/**
+ * @def MB_BLOCK_MAX_FAILURES
+ * @brief Number of failed sub-ranges recorded per block transfer (default: 4).
+ */
+#ifndef MB_BLOCK_MAX_FAILURES
+#define MB_BLOCK_MAX_FAILURES 4
+#endif
+
+/**
+ * @class BlockFailure
+ * @brief Sub-range of a block transfer that failed with the same error.
+ */
+class BlockFailure {
+  friend class BlockTransfer;  ///< Access to private members for recording.
+
+ private:
+  uint16_t _address = 0;  ///< First failed address.
+  uint16_t _count = 0;    ///< Failed registers or coils.
+  uint16_t _err = 0;      ///< Error code (MB_EX_*).
+};
+
+/**
+ * @class BlockTransfer
+ * @brief Owns the progress and the result of one block transfer.
+ * @details The object and the data buffer must stay valid until the completion callback was called.
+ *          Chunks may complete out of order on pipelining TCP connections, every chunk is copied to its place.
+ */
+class BlockTransfer {
+  friend class ModbusMaster;  ///< Access to private members for chunk handling.
+
+ private:
+  ModbusMaster* _master = nullptr;                  ///< Master running the transfer.
+  uint8_t _slave = 0;                               ///< Slave ID.
+  uint8_t _fn = 0;                                  ///< Function code of every chunk.
+  uint16_t _address = 0;                            ///< First address of the block.
+  uint16_t _count = 0;                              ///< Registers or coils in the block.
+  uint8_t* _dst = nullptr;                          ///< Read destination (uint16_t registers or packed bits).
+  const uint8_t* _src = nullptr;                    ///< Write source (uint16_t registers or packed bits).
+  uint16_t _next = 0;                               ///< Offset of the next chunk to send.
+  uint16_t _chunk = 0;                              ///< Max registers or coils per chunk (0 = protocol maximum).
+  uint8_t _window = 1;                              ///< Max chunks in progress at once.
+  uint8_t _pending = 0;                             ///< Chunks in progress.
+  bool _busy = false;                               ///< Transfer running.
+  bool _pumping = false;                            ///< Chunks are being issued (guards re-entry).
+  uint16_t _err = 0;                                ///< First error, 0 if every chunk succeeded.
+  uint16_t _failed = 0;                             ///< Total failed registers or coils.
+  uint8_t _failureCount = 0;                        ///< Recorded failed sub-ranges.
+  BlockFailure _failures[MB_BLOCK_MAX_FAILURES];    ///< Failed sub-ranges, adjacent ones with the same error merged.
+  blockCallback _callback;                          ///< Completion callback.
+
+  /**
+   * @brief Resets the result before a new transfer.
+   */
+  void reset();
+
+  /**
+   * @brief Records a failed sub-range.
+   * @param offset Offset of the sub-range from the block address.
+   * @param count Registers or coils in the sub-range.
+   * @param err Error code (MB_EX_*).
+   */
+  void fail(uint16_t offset, uint16_t count, uint16_t err);
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Chunks use the protocol maximum, one chunk is in progress at a time.
+   */
+  BlockTransfer();
+
+  /**
+   * @brief Limits the size of every chunk, for devices that accept less than the protocol maximum.
+   * @details Coil chunks are rounded down to a multiple of 8 so they start on a byte of the buffer, coil transfers
+   *          with a chunk size below 8 are rejected.
+   * @param count Max registers or coils per transaction (0 = protocol maximum).
+   */
+  void setChunkSize(uint16_t count);
+
+  /**
+   * @brief Sets how many chunks may be in progress at once.
+   * @details Chunks beyond the first are queued by ModbusRTUMaster and sent back-to-back by ModbusTCPClient in
+   *          allAtOnce mode. The master needs one free PDU more than the window.
+   * @param window Max chunks in progress (default: 1).
+   */
+  void setWindow(uint8_t window);
+
+  /**
+   * @brief Checks if the transfer is still running.
+   * @return bool True until the completion callback was called.
+   */
+  bool isBusy() const;
+
+  /**
+   * @brief Returns the first error of the transfer.
+   * @return uint16_t Error code (MB_EX_*) or 0 if every chunk succeeded.
+   */
+  uint16_t getErr() const;
+
+  /**
+   * @brief Returns the number of registers or coils that failed.
+   * @return uint16_t Failed registers or coils (0 if successful).
+   */
+  uint16_t getFailedCount() const;
+
+  /**
+   * @brief Returns the number of recorded failed sub-ranges.
+   * @details At most MB_BLOCK_MAX_FAILURES sub-ranges are recorded, getFailedCount() always covers all of them.
+   * @return uint8_t Number of sub-ranges.
+   */
+  uint8_t getFailureCount() const;
+
+  /**
+   * @brief Returns a failed sub-range.
+   * @param ix Index (0 to getFailureCount() - 1).
+   * @param address Set to the first failed address.
+   * @param count Set to the number of failed registers or coils.
+   * @param err Set to the error code (MB_EX_*).
+   * @return bool True if ix is valid.
+   */
+  bool getFailure(uint8_t ix, uint16_t& address, uint16_t& count, uint16_t& err) const;
+
+  /**
+   * @brief Returns the slave ID of the transfer.
+   * @return uint8_t Slave ID.
+   */
+  uint8_t getSlaveId() const;
+
+  /**
+   * @brief Returns the first address of the block.
+   * @return uint16_t Address.
+   */
+  uint16_t getAddress() const;
+
+  /**
+   * @brief Returns the size of the block.
+   * @return uint16_t Registers or coils.
+   */
+  uint16_t getCount() const;
+};
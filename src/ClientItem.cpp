@@ -3,12 +3,13 @@
 #include "ADUQueue.h"
 #include "ADUTCP.h"
 #include "ModbusUtility.h"
+#include "RequestCoalescer.h"
 
 ClientItem::ClientItem() {}
 
 ClientItem::~ClientItem() {}
 
-void ClientItem::set(uint8_t id, bool allAtOnce, uint8_t maxCount, Client* client, IPAddress ip, uint16_t port, bool keepAlive) {
+void ClientItem::set(uint8_t id, bool allAtOnce, uint8_t maxCount, Client* client, IPAddress ip, uint16_t port, bool keepAlive, ADUTCP** slots) {
   _id = id;
   _allAtOnce = allAtOnce;
   _maxCount = maxCount;
@@ -16,11 +17,25 @@ void ClientItem::set(uint8_t id, bool allAtOnce, uint8_t maxCount, Client* clien
   _ip = ip;
   _port = port;
   _keepAlive = keepAlive;
-  _sent.init(_maxCount);
-  _queue.init(_maxCount);
+  if (slots) {
+    _sent.init(_maxCount, slots);
+    _queue.init(_maxCount, slots + _maxCount);
+  } else {
+    _sent.init(_maxCount);
+    _queue.init(_maxCount);
+  }
+  _window = 0;
   _lastReconnectAttempt = millis();
 }
 
+void ClientItem::setWindow(uint8_t window) {
+  _window = window > _maxCount ? _maxCount : window;
+}
+
+uint8_t ClientItem::load() const {
+  return _queue.count() + _sent.count() + (_currentADU ? 1 : 0);
+}
+
 bool ClientItem::reconnect() {
   if (!_client->connected()) {
     if (on_ms(&_lastReconnectAttempt, _reconnectInterval, true)) {
@@ -40,31 +55,36 @@ bool ClientItem::keepAlive() {
   return _client->connected();
 }
 
+bool ClientItem::readReady(ADUTCP*& adu) {
+  return _coalescer ? _coalescer->readReady(_queue, adu) : _queue.readReady(adu);
+}
+
+bool ClientItem::hasReady() const {
+  return _coalescer ? _coalescer->hasReady(_queue) : _queue.hasReady();
+}
+
 void ClientItem::loop() {
   if (!keepAlive()) return;  // Ensure connection is active
   if (_allAtOnce) {          // Send all ready ADUs at once
-    if (_queue.hasReady() && reconnect()) {
+    if (hasReady() && reconnect()) {
+      const uint8_t window = _window ? _window : _maxCount;
       ADUTCP* adu;
-      while (_queue.hasReady()) {
-        if (_queue.readReady(adu)) {
-          if (_sent.hasFree()) {
-            send(adu);
-            _sent.add(adu);
-          } else {
-            adu->_err = MB_EX_LIB_TCP_SENT_BUFFER_FULL;
-            adu->callCallback();
-            return;
-          }
-        } else {
-          break;  // No more ADUs to send
+      // ADUs beyond the window stay queued until a response frees a slot
+      while (_sent.count() < window) {
+        if (!readReady(adu)) break;  // No more ADUs to send
+        if (_coalescer && _coalescer->coalesce(adu, _queue)) adu->setMBAPLength();
+        send(adu);
+        if (!_sent.add(adu)) {
+          adu->_err = MB_EX_LIB_TCP_SENT_BUFFER_FULL;
+          adu->callCallback();
+          return;
         }
       }
     }
   } else {  // Send one ADU at a time
-    if (!_currentADU && _queue.hasReady()) {
-      if (_queue.readReady(_currentADU)) {
-        send(_currentADU);
-      }
+    if (!_currentADU && readReady(_currentADU)) {
+      if (_coalescer && _coalescer->coalesce(_currentADU, _queue)) _currentADU->setMBAPLength();
+      send(_currentADU);
     }
   }
   if (!_currentADU && _sent.isEmpty()) return;  // No ADU awaiting response
@@ -96,8 +116,9 @@ void ClientItem::loop() {
   }
   if (_incomingByte && _client->available() >= _incomingByte) {
     _client->read(_currentADU->_RXADUTCPframe + MB_ADU_MBAP_LEN, _incomingByte);
-    _currentADU->invoke();
-    reset();
+    ADUTCP* adu = _currentADU;
+    reset();  // Callbacks may queue identical reads, they must not be attached to the finished ADU
+    adu->invoke();
   }
   // Check timeouts
   if (_allAtOnce && !_sent.isEmpty()) {
@@ -108,20 +129,41 @@ void ClientItem::loop() {
     }
   } else if (_currentADU) {
     if (on_ms(&_currentADU->_sentTime, _responseTimeout, false)) {
-      _currentADU->_err = MB_EX_LIB_RESPONSE_TIMEOUT;
-      _currentADU->callCallback();
+      ADUTCP* adu = _currentADU;
       reset();
+      adu->_err = MB_EX_LIB_RESPONSE_TIMEOUT;
+      adu->callCallback();
     }
   }
 }
 
+bool ClientItem::deduplicate(ADUTCP* adu) {
+  if (!_coalescer) return false;
+  if (_coalescer->deduplicate(adu, static_cast<ADUTCP*>(nullptr), _queue)) return true;
+  if (_coalescer->hasQueuedBarrier(adu, _queue)) return false;  // In-flight reads predate the queued write
+  if (RequestCoalescer::isBarrier(_currentADU, adu)) return false;
+  for (uint8_t i = 0; i < _sent.size(); i++) {  // In-flight order is unknown, any write in flight rules them out
+    if (RequestCoalescer::isBarrier(_sent.at(i), adu)) return false;
+  }
+  if (_coalescer->attach(_currentADU, adu)) return true;
+  for (uint8_t i = 0; i < _sent.size(); i++) {
+    if (_coalescer->attach(_sent.at(i), adu)) return true;
+  }
+  return false;
+}
+
 bool ClientItem::isValid() const {
   return _id != 0;
 }
 
 void ClientItem::send(ADUTCP* adu) {
   if (_client && _client->connected()) {
-    _client->write(adu->_TXADUTCPframe, adu->getTXADULen());
+    if (adu->_payload) {  // Header from the TX buffer, payload from the caller's data
+      _client->write(adu->_TXADUTCPframe, MB_ADU_MBAP_LEN + MB_PDU_WRITE_HEADER_LEN);
+      adu->sendPayload(*_client, nullptr);
+    } else {
+      _client->write(adu->_TXADUTCPframe, adu->getTXADULen());
+    }
     adu->_sentTime = millis();
   }
 }
@@ -13,6 +13,7 @@
 #include "ModbusDef.h"
 
 class ADUTCP;
+class RequestCoalescer;
 
 /**
  * @class ClientItem
@@ -34,9 +35,11 @@ class ClientItem {
   uint32_t _responseTimeout = MB_TCP_RESPONSE_TIMEOUT;  ///< Response timeout (ms).
   ADUTCP* _currentADU = nullptr;                        ///< Currently processed ADU.
   bool _allAtOnce = false;                              ///< Send all ready ADUs at once.
+  uint8_t _window = 0;                                  ///< Max ADUs awaiting response in allAtOnce mode (0 = queue size).
   int16_t _incomingByte = 0;                            ///< Expected incoming bytes for response.
   ADUTCPSent _sent;                                     ///< Buffer for sent ADUs awaiting response.
   ADUQueue<ADUTCP> _queue;                              ///< Queue for pending ADUs.
+  const RequestCoalescer* _coalescer = nullptr;         ///< Request merging settings of the owning client, nullptr if disabled.
 
   /**
    * @brief Sends an ADU over the TCP connection.
@@ -44,6 +47,13 @@ class ClientItem {
    */
   void send(ADUTCP* adu);
 
+  /**
+   * @brief Attaches a read to an identical in-flight or queued ADU of this connection.
+   * @param adu New read, not queued yet.
+   * @return bool True if attached, the ADU must not be queued.
+   */
+  bool deduplicate(ADUTCP* adu);
+
   /**
    * @brief Clears the TCP client buffer.
    * @return uint16_t Number of bytes cleared.
@@ -62,11 +72,30 @@ class ClientItem {
    */
   bool reconnect();
 
+  /**
+   * @brief Takes the next ADU to send from the queue, honouring the coil write hold window.
+   * @param adu Output: the ADU to send.
+   * @return bool True if an ADU was taken.
+   */
+  bool readReady(ADUTCP*& adu);
+
+  /**
+   * @brief Checks if an ADU is ready to send, honouring the coil write hold window.
+   * @return bool True if readReady() would take an ADU.
+   */
+  bool hasReady() const;
+
   /**
    * @brief Resets current ADU and incoming byte count.
    */
   void reset();
 
+  /**
+   * @brief Returns the number of ADUs queued or awaiting response.
+   * @return uint8_t Current load of the connection.
+   */
+  uint8_t load() const;
+
  public:
   /**
    * @brief Default constructor.
@@ -89,9 +118,18 @@ class ClientItem {
    * @param ip Slave IP address.
    * @param port TCP port (default: 502).
    * @param keepAlive Reconnect if connection lost.
+   * @param slots Storage of the sent buffer and the queue, 2 * maxCount pointers owned by the caller (default: nullptr,
+   *        allocated).
    */
   void set(uint8_t id, bool allAtOnce, uint8_t maxCount, Client* client, IPAddress ip,
-           uint16_t port = 502, bool keepAlive = true);
+           uint16_t port = 502, bool keepAlive = true, ADUTCP** slots = nullptr);
+
+  /**
+   * @brief Limits the ADUs awaiting response in allAtOnce mode.
+   * @details ADUs beyond the window stay queued until a response or timeout frees a slot.
+   * @param window Max pipelined ADUs (0 = queue size).
+   */
+  void setWindow(uint8_t window);
 
   /**
    * @brief Main loop for connection, sending, and response handling.
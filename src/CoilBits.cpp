@@ -0,0 +1,77 @@
+#include "CoilBits.h"
+
+#include "ModbusUtility.h"
+
+CoilBits::CoilBits(const uint8_t* data, uint16_t size) : _data(data), _size(data ? size : 0) {}
+
+uint16_t CoilBits::size() const { return _size; }
+
+const uint8_t* CoilBits::data() const { return _data; }
+
+bool CoilBits::test(uint16_t ix) const { return ix < _size && (*this)[ix]; }
+
+uint16_t CoilBits::count() const {
+  const uint16_t full = _size >> 3;
+  uint16_t n = 0;
+  uint16_t i = 0;
+#if UINTPTR_MAX > 0xFFFF
+  for (; i + 4 <= full; i += 4) {
+    uint32_t w;
+    memcpy(&w, _data + i, 4);
+    n += __builtin_popcountl(w);
+  }
+#endif
+  for (; i < full; i++) n += __builtin_popcount(_data[i]);
+  if (_size & 7) n += __builtin_popcount(_data[full] & ((1 << (_size & 7)) - 1));
+  return n;
+}
+
+uint16_t CoilBits::next(uint16_t from) const {
+  if (from >= _size) return _size;
+  uint16_t byte = from >> 3;
+  uint8_t b = _data[byte] & (0xFF << (from & 7));
+  const uint16_t bytes = (_size + 7) >> 3;
+  while (!b) {
+    if (++byte >= bytes) return _size;
+#if UINTPTR_MAX > 0xFFFF
+    for (uint32_t w; byte + 4 <= bytes; byte += 4) {  // Skip empty words
+      memcpy(&w, _data + byte, 4);
+      if (w) break;
+    }
+    if (byte >= bytes) return _size;
+#endif
+    b = _data[byte];
+  }
+  const uint16_t ix = (byte << 3) + __builtin_ctz(b);
+  return ix < _size ? ix : _size;
+}
+
+uint16_t CoilBits::copyTo(bool* dst, uint16_t count, uint16_t first) const {
+  if (!dst || first >= _size) return 0;
+  if (count > _size - first) count = _size - first;
+  uint16_t i = 0;
+  for (; i < count && ((first + i) & 7); i++) dst[i] = (*this)[first + i];  // Up to a byte boundary
+  unpackBits(dst + i, _data + ((first + i) >> 3), count - i);
+  return count;
+}
+
+uint16_t CoilBits::copyTo(uint64_t* dst, uint16_t wordCount) const {
+  if (!dst) return 0;
+  const uint16_t bytes = (_size + 7) >> 3;
+  uint16_t words = (_size + 63) >> 6;
+  if (words > wordCount) words = wordCount;
+  for (uint16_t k = 0; k < words; k++) {
+    const uint16_t begin = k << 3;
+    const uint8_t n = bytes - begin < 8 ? bytes - begin : 8;
+    uint64_t w = 0;
+    if (hostIsBigEndian) {
+      for (uint8_t j = 0; j < n; j++) w |= (uint64_t)_data[begin + j] << (j * 8);
+    } else {
+      memcpy(&w, _data + begin, n);  // Packed bits are the little-endian image of the words
+    }
+    const uint16_t valid = _size - (k << 6);
+    if (valid < 64) w &= (1ULL << valid) - 1;
+    dst[k] = w;
+  }
+  return words;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file CoilBits.h
+ * @brief Read-only bitset view over the packed bits of a coil or discrete input response.
+ * @details Returned by PDU::getBits(), valid while the PDU is (i.e. inside the callback).
+ */
+
+#pragma once
+#include <Arduino.h>
+
+/**
+ * @class CoilBits
+ * @brief Bitset view over packed bits (LSB first), without copying them.
+ * @details Counting, searching and copying work a byte or a word at a time instead of per bit.
+ */
+class CoilBits {
+ private:
+  const uint8_t* _data = nullptr;  ///< Packed bits.
+  uint16_t _size = 0;              ///< Number of bits.
+
+ public:
+  /**
+   * @brief Constructs a view over packed bits.
+   * @param data Packed bits, (size + 7) / 8 bytes.
+   * @param size Number of bits.
+   */
+  CoilBits(const uint8_t* data, uint16_t size);
+
+  /**
+   * @brief Returns the number of bits.
+   * @return uint16_t Number of bits, 0 if the response holds none.
+   */
+  uint16_t size() const;
+
+  /**
+   * @brief Returns the packed bits.
+   * @return const uint8_t* Bytes of the view, bit 0 is the LSB of the first byte.
+   */
+  const uint8_t* data() const;
+
+  /**
+   * @brief Returns a bit without bounds check.
+   * @param ix Bit index (< size()).
+   * @return bool Bit value.
+   */
+  bool operator[](uint16_t ix) const { return (_data[ix >> 3] >> (ix & 7)) & 0x01; }
+
+  /**
+   * @brief Returns a bit.
+   * @param ix Bit index.
+   * @return bool Bit value, false if ix is out of range.
+   */
+  bool test(uint16_t ix) const;
+
+  /**
+   * @brief Counts the set bits.
+   * @return uint16_t Number of set bits.
+   */
+  uint16_t count() const;
+
+  /**
+   * @brief Finds the next set bit.
+   * @details Iterates the set bits with `for (uint16_t i = bits.next(0); i < bits.size(); i = bits.next(i + 1))`.
+   * @param from First bit index to look at.
+   * @return uint16_t Index of the next set bit, size() if there is none.
+   */
+  uint16_t next(uint16_t from) const;
+
+  /**
+   * @brief Copies bits into a bool array.
+   * @param dst Destination bools.
+   * @param count Number of bits to copy.
+   * @param first First bit to copy (default: 0).
+   * @return uint16_t Number of bits copied.
+   */
+  uint16_t copyTo(bool* dst, uint16_t count, uint16_t first = 0) const;
+
+  /**
+   * @brief Copies bits into 64-bit words, bit i of the view is bit i % 64 of word i / 64.
+   * @details Bits beyond size() are cleared.
+   * @param dst Destination words.
+   * @param wordCount Number of words available.
+   * @return uint16_t Number of words written.
+   */
+  uint16_t copyTo(uint64_t* dst, uint16_t wordCount) const;
+};
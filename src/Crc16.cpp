@@ -68,8 +68,13 @@ const uint8_t tableCrcLo[] = {
 
 uint16_t crc16(const uint8_t* buffer, uint16_t length) {
   if (buffer == nullptr || length == 0) return 0xFFFF; // Modbus CRC-16 initial value
-  uint8_t crcHi = 0xFF;
-  uint8_t crcLo = 0xFF;
+  return crc16Update(0xFFFF, buffer, length);
+}
+
+uint16_t crc16Update(uint16_t crc, const uint8_t* buffer, uint16_t length) {
+  if (buffer == nullptr) return crc;
+  uint8_t crcHi = crc & 0xFF;
+  uint8_t crcLo = crc >> 8;
   uint16_t index;
   while (length--) {
     index = crcHi ^ *buffer++;
@@ -41,6 +41,16 @@ extern const uint8_t tableCrcLo[];
  */
 extern uint16_t crc16(const uint8_t* buffer, uint16_t length);
 
+/**
+ * @brief Continues a CRC-16 checksum over the next part of a message.
+ * @details Allows a frame sent in pieces to be checksummed without assembling it, start with 0xFFFF.
+ * @param crc CRC-16 of the preceding bytes (as returned by crc16()).
+ * @param buffer Next bytes of the message.
+ * @param length Number of bytes.
+ * @return uint16_t CRC-16 checksum including buffer.
+ */
+extern uint16_t crc16Update(uint16_t crc, const uint8_t* buffer, uint16_t length);
+
 /**
  * @brief Verifies the CRC-16 checksum of a received Modbus RTU message.
  * @param msg Input message including CRC (last 2 bytes).
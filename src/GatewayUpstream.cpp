@@ -0,0 +1,144 @@
+#include "GatewayUpstream.h"
+
+#include "ModbusUtility.h"
+
+uint8_t* GatewayRequest::pdu() const { return _frame + MB_ADU_MBAP_LEN; }
+
+uint8_t GatewayRequest::unit() const { return _frame[6]; }
+
+void GatewayRequest::clear() {
+  _len = 0;
+  _state = MB_GW_REQ_FREE;
+  _route = 0;
+  _orphan = false;
+  _next = nullptr;
+}
+
+GatewayUpstream::GatewayUpstream() {}
+
+GatewayUpstream::~GatewayUpstream() {
+  if (_requests) {
+    for (uint8_t i = 0; i < _queueSize; i++) {
+      delete[] _requests[i]._frame;
+    }
+    delete[] _requests;
+  }
+}
+
+void GatewayUpstream::init(ModbusGateway* gateway, uint8_t queueSize, uint8_t PDUSize) {
+  _gateway = gateway;
+  _queueSize = queueSize;
+  _PDUSize = PDUSize;
+  _requests = new GatewayRequest[_queueSize];
+  for (uint8_t i = 0; i < _queueSize; i++) {
+    _requests[i]._frame = new uint8_t[MB_ADU_MBAP_LEN + PDUSize];
+    _requests[i]._upstream = this;
+  }
+}
+
+void GatewayUpstream::attach(Client* client, uint8_t burst) {
+  _client = client;
+  _incomingByte = 0;
+  _tokens = (uint32_t)burst * 1000;
+  _lastRefill = millis();
+}
+
+void GatewayUpstream::detach() {
+  _client = nullptr;
+  _incomingByte = 0;
+  for (uint8_t i = 0; i < _queueSize; i++) {
+    GatewayRequest& req = _requests[i];
+    if (req._state == GatewayRequest::MB_GW_REQ_FREE) continue;
+    if (req._state == GatewayRequest::MB_GW_REQ_QUEUED && !req._next) {
+      req.clear();  // Nobody else waits for it
+    } else {
+      req._orphan = true;  // Still carries followers or a downstream transaction
+    }
+  }
+}
+
+bool GatewayUpstream::isConnected() const {
+  return _client != nullptr;
+}
+
+bool GatewayUpstream::isBusy() const {
+  for (uint8_t i = 0; i < _queueSize; i++) {
+    if (_requests[i]._state != GatewayRequest::MB_GW_REQ_FREE) return true;
+  }
+  return false;
+}
+
+GatewayRequest* GatewayUpstream::getFreeRequest() {
+  for (uint8_t i = 0; i < _queueSize; i++) {
+    if (_requests[i]._state == GatewayRequest::MB_GW_REQ_FREE) return &_requests[i];
+  }
+  return nullptr;
+}
+
+bool GatewayUpstream::takeToken(uint16_t rate, uint8_t burst) {
+  if (rate == 0) return true;
+  uint32_t now = millis();
+  uint32_t elapsed = now - _lastRefill;
+  _lastRefill = now;
+  const uint32_t max = (uint32_t)burst * 1000;
+  if (elapsed > max) elapsed = max;  // A full bucket refills in at most burst seconds
+  const uint64_t tokens = _tokens + (uint64_t)elapsed * rate;  // Up to 255000 ms * 65535 requests/s
+  _tokens = tokens > max ? max : (uint32_t)tokens;
+  if (_tokens < 1000) return false;
+  _tokens -= 1000;
+  return true;
+}
+
+GatewayRequest* GatewayUpstream::receive() {
+  if (_incomingByte == 0) {  // Waiting for MBAP header
+    if (_client->available() < MB_ADU_MBAP_LEN) return nullptr;
+    _client->read(_mbap, MB_ADU_MBAP_LEN);
+    const uint16_t len = (_mbap[4] << 8) | _mbap[5];
+    if (_mbap[2] != 0 || _mbap[3] != 0 || len < 2 || len > (uint16_t)_PDUSize + 1) {
+      _client->stop();  // Framing is lost, the peer has to reconnect
+      detach();
+      return nullptr;
+    }
+    _incomingByte = len - 1;  // Exclude unit ID
+  }
+  if (_client->available() < _incomingByte) return nullptr;
+  GatewayRequest* req = getFreeRequest();
+  if (!req) {  // Queue full: consume the frame and answer busy
+    uint8_t frame[MB_ADU_MBAP_LEN + MB_PDU_ERR_LEN];
+    memcpy(frame, _mbap, MB_ADU_MBAP_LEN);
+    frame[MB_ADU_MBAP_LEN] = _client->read() | 0x80;
+    frame[MB_ADU_MBAP_LEN + 1] = MB_EX_SLAVE_DEVICE_BUSY;
+    for (int16_t i = 1; i < _incomingByte; i++) _client->read();
+    frame[4] = 0x00;
+    frame[5] = MB_PDU_ERR_LEN + 1;
+    _client->write(frame, sizeof(frame));
+    _incomingByte = 0;
+    return nullptr;
+  }
+  memcpy(req->_frame, _mbap, MB_ADU_MBAP_LEN);
+  _client->read(req->pdu(), _incomingByte);
+  req->_len = _incomingByte;
+  req->_state = GatewayRequest::MB_GW_REQ_QUEUED;
+  req->_seq = _seq++;
+  _incomingByte = 0;
+  return req;
+}
+
+void GatewayUpstream::reply(GatewayRequest* req, const uint8_t* pdu, uint8_t len) {
+  if (!_client) return;
+  if (len > _PDUSize) {  // The response does not fit the frame, the client must not wait for a timeout
+    replyException(req, MB_EX_SLAVE_DEVICE_ERROR);
+    return;
+  }
+  if (req->pdu() != pdu) memcpy(req->pdu(), pdu, len);
+  req->_frame[4] = 0x00;
+  req->_frame[5] = len + 1;  // PDU + unit ID
+  _client->write(req->_frame, MB_ADU_MBAP_LEN + len);
+}
+
+void GatewayUpstream::replyException(GatewayRequest* req, uint8_t code) {
+  uint8_t* pdu = req->pdu();
+  pdu[0] |= 0x80;
+  pdu[1] = code;
+  reply(req, pdu, MB_PDU_ERR_LEN);
+}
@@ -0,0 +1,167 @@
+/**
+ * @file GatewayUpstream.h
+ * @brief Manages a single upstream Modbus TCP connection of a gateway.
+ * @details Receives MBAP framed requests, stores them in a small per-connection queue and writes the responses back.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+#include "ModbusDef.h"
+
+class ModbusGateway;
+class GatewayUpstream;
+
+/**
+ * @class GatewayRequest
+ * @brief One upstream request held by the gateway until its response is written back.
+ * @details Stores the complete MBAP frame; the same buffer is reused for the response.
+ */
+class GatewayRequest {
+  friend class GatewayUpstream;  ///< Access to private members for queue management.
+  friend class ModbusGateway;    ///< Access to private members for dispatching.
+
+ private:
+  /**
+   * @enum RequestState
+   * @brief Life cycle of a gateway request.
+   */
+  enum {
+    MB_GW_REQ_FREE,      ///< Slot is unused.
+    MB_GW_REQ_QUEUED,    ///< Waiting for its turn on the downstream master.
+    MB_GW_REQ_PENDING,   ///< Submitted to the downstream master.
+    MB_GW_REQ_FOLLOWER   ///< Collapsed onto an identical queued or pending request.
+  };
+
+  uint8_t* _frame = nullptr;            ///< MBAP header + PDU buffer (request, then response).
+  uint8_t _len = 0;                     ///< Length of the request PDU.
+  uint8_t _state = MB_GW_REQ_FREE;      ///< Current request state.
+  bool _orphan = false;                 ///< Upstream connection closed, no response is written.
+  uint16_t _seq = 0;                    ///< Arrival order within the upstream connection.
+  uint32_t _submitted = 0;              ///< Gateway submission number, set when the request is submitted.
+  uint8_t _route = 0;                   ///< Index of the route serving the unit ID.
+  GatewayRequest* _next = nullptr;      ///< Next request sharing the same downstream transaction.
+  GatewayUpstream* _upstream = nullptr; ///< Owning upstream connection.
+
+  /**
+   * @brief Returns the request PDU.
+   * @return uint8_t* Pointer to the PDU (function code first).
+   */
+  uint8_t* pdu() const;
+
+  /**
+   * @brief Returns the unit ID from the MBAP header.
+   * @return uint8_t Unit ID.
+   */
+  uint8_t unit() const;
+
+  /**
+   * @brief Resets the request slot.
+   */
+  void clear();
+};
+
+/**
+ * @class GatewayUpstream
+ * @brief Manages one upstream Modbus TCP connection with its request queue and rate limit.
+ * @details The connection is accepted by the sketch (e.g. EthernetServer::accept()) and handed over to ModbusGateway::addUpstream().
+ */
+class GatewayUpstream {
+  friend class ModbusGateway;  ///< Access to private members for gateway management.
+
+ private:
+  Client* _client = nullptr;              ///< Upstream TCP connection (nullptr if unused).
+  ModbusGateway* _gateway = nullptr;      ///< Owning gateway.
+  GatewayRequest* _requests = nullptr;    ///< Request slots.
+  uint8_t _queueSize = 0;                 ///< Number of request slots.
+  uint8_t _PDUSize = 0;                   ///< Max PDU size of a request slot.
+  uint8_t _mbap[MB_ADU_MBAP_LEN]{};       ///< MBAP header of the frame being received.
+  int16_t _incomingByte = 0;              ///< Expected PDU bytes of the frame being received.
+  uint16_t _seq = 0;                      ///< Arrival counter.
+  uint32_t _writeDone = 0;                ///< Gateway submission count when the last write of this connection completed.
+  uint32_t _tokens = 0;                   ///< Rate limit tokens (1/1000 request).
+  uint32_t _lastRefill = 0;               ///< Last token refill timestamp (ms).
+
+  /**
+   * @brief Allocates the request slots.
+   * @param gateway Owning gateway.
+   * @param queueSize Number of request slots.
+   * @param PDUSize Max PDU size (16-253 bytes).
+   */
+  void init(ModbusGateway* gateway, uint8_t queueSize, uint8_t PDUSize);
+
+  /**
+   * @brief Attaches an accepted connection.
+   * @param client Pointer to the connected TCP client.
+   * @param burst Initial rate limit tokens.
+   */
+  void attach(Client* client, uint8_t burst);
+
+  /**
+   * @brief Detaches a closed connection, dropping its queued requests.
+   * @details Pending requests are kept as orphans until their downstream transaction completes.
+   */
+  void detach();
+
+  /**
+   * @brief Reads at most one complete MBAP frame from the connection.
+   * @return GatewayRequest* The received request, or nullptr if no complete frame is available.
+   */
+  GatewayRequest* receive();
+
+  /**
+   * @brief Returns a free request slot.
+   * @return GatewayRequest* Free slot, or nullptr if the queue is full.
+   */
+  GatewayRequest* getFreeRequest();
+
+  /**
+   * @brief Consumes one rate limit token.
+   * @param rate Allowed requests per second (0 disables the limit).
+   * @param burst Maximum number of stored tokens.
+   * @return bool True if a request may be sent now, false otherwise.
+   */
+  bool takeToken(uint16_t rate, uint8_t burst);
+
+  /**
+   * @brief Writes a response PDU for the request.
+   * @details A response longer than the PDU size is answered with MB_EX_SLAVE_DEVICE_ERROR instead.
+   * @param req Request to answer.
+   * @param pdu Response PDU.
+   * @param len Length of the response PDU.
+   */
+  void reply(GatewayRequest* req, const uint8_t* pdu, uint8_t len);
+
+  /**
+   * @brief Writes an exception response for the request.
+   * @param req Request to answer.
+   * @param code Modbus exception code (MB_EX_*, 1-11).
+   */
+  void replyException(GatewayRequest* req, uint8_t code);
+
+  /**
+   * @brief Checks if any request slot is in use.
+   * @return bool True if a request is queued or pending, false otherwise.
+   */
+  bool isBusy() const;
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an unused upstream slot.
+   */
+  GatewayUpstream();
+
+  /**
+   * @brief Destructor.
+   * @details Frees request buffers, does not delete the TCP client.
+   */
+  ~GatewayUpstream();
+
+  /**
+   * @brief Checks if a connection is attached.
+   * @return bool True if connected, false otherwise.
+   */
+  bool isConnected() const;
+};
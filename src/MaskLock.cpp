@@ -0,0 +1,3 @@
+#include "MaskLock.h"
+
+MaskFallback::MaskFallback(const Slaves& slaves) : _slaves(slaves) {}
@@ -0,0 +1,65 @@
+/**
+ * @file MaskLock.h
+ * @brief Lock of a holding register during a read-modify-write that emulates a mask write.
+ * @details Used by ModbusMaster::maskWriteRegister() for the slaves of a MaskFallback attached with
+ *          ModbusMaster::setMaskWriteFallback().
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#include "ModbusDef.h"
+#include "Slaves.h"
+
+class ModbusMaster;
+class PDU;
+
+/**
+ * @def MB_MASK_LOCKS
+ * @brief Number of registers with a read-modify-write in progress at once (default: 4).
+ */
+#ifndef MB_MASK_LOCKS
+#define MB_MASK_LOCKS 4
+#endif
+
+/**
+ * @class MaskLock
+ * @brief Serializes the mask writes to one register of a slave without FC 0x16.
+ * @details A cycle reads the register (FC 0x03), applies the composed masks and writes it back (FC 0x06). Mask writes
+ *          arriving before the read response join the current cycle, later ones wait for the next cycle, so no update
+ *          is lost. The mask write PDUs are held unsent and complete with the result of their cycle.
+ */
+class MaskLock {
+  friend class ModbusMaster;  ///< Access to private members for the read-modify-write.
+
+ private:
+  ModbusMaster* _master = nullptr;  ///< Master running the cycle, nullptr if the lock is free.
+  uint8_t _slave = 0;               ///< Slave ID.
+  uint16_t _address = 0;            ///< Locked register.
+  uint16_t _and = 0;                ///< Composed AND mask of the current cycle.
+  uint16_t _or = 0;                 ///< Composed OR mask of the current cycle.
+  bool _writing = false;            ///< Read answered, the write is in progress.
+  PDU* _current = nullptr;          ///< Mask writes of the current cycle, chained in order.
+  PDU* _waiting = nullptr;          ///< Mask writes for the next cycle, chained in order.
+};
+
+/**
+ * @class MaskFallback
+ * @brief Slaves without FC 0x16 and the register locks used to emulate their mask writes.
+ * @details Attached to one master with ModbusMaster::setMaskWriteFallback(), up to MB_MASK_LOCKS registers are
+ *          emulated at once.
+ */
+class MaskFallback {
+  friend class ModbusMaster;  ///< Access to private members for the read-modify-write.
+
+ private:
+  Slaves _slaves;                  ///< Slaves without FC 0x16.
+  MaskLock _locks[MB_MASK_LOCKS];  ///< Registers with a read-modify-write in progress.
+
+ public:
+  /**
+   * @brief Constructor.
+   * @param slaves Slaves without FC 0x16.
+   */
+  explicit MaskFallback(const Slaves& slaves);
+};
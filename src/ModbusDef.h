@@ -95,7 +95,7 @@
 
 /**
  * @defgroup ErrorCodes Modbus Error Codes
- * @brief Standard Modbus error codes (1-10) and library-specific error codes (12+).
+ * @brief Standard Modbus error codes (1-11) and library-specific error codes (12+).
  * @{
  */
 #define MB_EX_SUCCESS 0                                     ///< Operation successful.
@@ -107,8 +107,8 @@
 #define MB_EX_SLAVE_DEVICE_BUSY 6                           ///< Slave busy with long-duration command.
 #define MB_EX_NEGATIVE_ACKNOWLEDGE 7                        ///< Slave cannot perform programming functions.
 #define MB_EX_MEMORY_PARITY_ERROR 8                         ///< Slave detected memory parity error.
-#define MB_EX_GATEWAY_PATH_UNAVAILABLE 9                    ///< Gateway misconfigured.
-#define MB_EX_GATEWAY_TARGET_DEVICE_FAILED_TO_RESPOND 10    ///< Slave failed to respond (gateway-specific).
+#define MB_EX_GATEWAY_PATH_UNAVAILABLE 0x0A                 ///< Gateway misconfigured.
+#define MB_EX_GATEWAY_TARGET_DEVICE_FAILED_TO_RESPOND 0x0B  ///< Slave failed to respond (gateway-specific).
 #define MB_EX_LIB_TOO_MANY_DATA 12                          ///< Too many data bytes requested.
 #define MB_EX_LIB_TOO_FEW_DATA 13                           ///< Too few data bytes received.
 #define MB_EX_LIB_RESPONSE_TIMEOUT 14                       ///< Response timeout exceeded.
@@ -138,6 +138,43 @@
 #define MB_EX_LIB_INVALID_MBAP_UNIT_ID 44                   ///< Invalid MBAP unit ID.
 /** @} */
 
+/**
+ * @defgroup DataTables Modbus Data Tables
+ * @brief Identifiers of the four Modbus data tables (used by RegisterStore).
+ * @{
+ */
+#define MB_TABLE_COILS 0              ///< Coils (read/write bits, FC 0x01, 0x05, 0x0F).
+#define MB_TABLE_DISCRETE_INPUTS 1    ///< Discrete inputs (read-only bits, FC 0x02).
+#define MB_TABLE_INPUT_REGISTERS 2    ///< Input registers (read-only 16-bit, FC 0x04).
+#define MB_TABLE_HOLDING_REGISTERS 3  ///< Holding registers (read/write 16-bit, FC 0x03, 0x06, 0x10).
+/** @} */
+
+/**
+ * @defgroup TagTypes Tag Data Types
+ * @brief Value types of a polled tag (used by PollPlan). 32-bit types span two registers, high word first.
+ * @{
+ */
+#define MB_TAG_BOOL 0    ///< Coil or discrete input.
+#define MB_TAG_UINT16 1  ///< Unsigned 16-bit register.
+#define MB_TAG_INT16 2   ///< Signed 16-bit register.
+#define MB_TAG_UINT32 3  ///< Unsigned 32-bit value (two registers).
+#define MB_TAG_INT32 4   ///< Signed 32-bit value (two registers).
+#define MB_TAG_FLOAT 5   ///< IEEE 754 float (two registers).
+/** @} */
+
+/**
+ * @defgroup WordOrders Word Orders
+ * @brief Register layouts of multi-register values, named after the bytes of a 32-bit value (A = most significant).
+ * @details 64-bit values follow the same rule per register (e.g. MB_ORDER_CDAB sends the lowest register first).
+ * @{
+ */
+#define MB_ORDER_HOST 0  ///< Registers in host memory order, each big-endian (low word first on little-endian hosts).
+#define MB_ORDER_ABCD 1  ///< Big-endian, high word first (Modbus standard).
+#define MB_ORDER_CDAB 2  ///< Low word first, bytes big-endian within a register.
+#define MB_ORDER_BADC 3  ///< High word first, bytes swapped within a register.
+#define MB_ORDER_DCBA 4  ///< Little-endian, low word first with swapped bytes.
+/** @} */
+
 /**
  * @defgroup Timeouts Response Timeouts
  * @brief Configurable timeout values for Modbus communication.
@@ -166,6 +203,7 @@
 #define MB_ADU_MBAP_LEN 7                  ///< TCP MBAP header length.
 #define MB_PDU_MAX_RESPONSE_LEN 7          ///< Max PDU response length (excluding data).
 #define MB_PDU_ERR_LEN 2                   ///< PDU error response length.
+#define MB_PDU_WRITE_HEADER_LEN 6          ///< Multiple write request length before the data (FC 0x0F, 0x10).
 #define MB_MAX_SLAVE_ID 247                ///< Max Modbus slave ID.
 #define MB_PDU_MAX_SIZE 253                ///< Max Modbus PDU size.
                                            /** @} */
\ No newline at end of file
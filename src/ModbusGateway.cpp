@@ -0,0 +1,235 @@
+#include "ModbusGateway.h"
+
+#include <Callback.h>
+
+#include "ModbusMaster.h"
+#include "PDU.h"
+
+ModbusGateway::ModbusGateway() {}
+
+ModbusGateway::~ModbusGateway() {
+  delete[] _upstreams;
+  delete[] _routes;
+}
+
+void ModbusGateway::begin(uint8_t routeCount, uint8_t upstreamCount, uint8_t queueSize, uint8_t PDUSize) {
+  _routeCount = routeCount;
+  _routes = new GatewayRoute[_routeCount];
+  _upstreamCount = upstreamCount;
+  _upstreams = new GatewayUpstream[_upstreamCount];
+  for (uint8_t i = 0; i < _upstreamCount; i++) {
+    _upstreams[i].init(this, queueSize, PDUSize);
+  }
+}
+
+void ModbusGateway::begin(ModbusMaster* master, uint8_t upstreamCount, uint8_t queueSize, uint8_t PDUSize) {
+  begin(1, upstreamCount, queueSize, PDUSize);
+  addRoute(0, 255, master);
+}
+
+bool ModbusGateway::addRoute(uint8_t firstUnit, uint8_t lastUnit, ModbusMaster* master, uint8_t maxInFlight, int16_t unitOffset) {
+  if (!master || firstUnit > lastUnit) return false;
+  if ((int16_t)firstUnit + unitOffset < 0 || (int16_t)lastUnit + unitOffset > 255) return false;
+  for (uint8_t i = 0; i < _routeCount; i++) {
+    GatewayRoute& route = _routes[i];
+    if (route._master) continue;
+    route._first = firstUnit;
+    route._last = lastUnit;
+    route._unitOffset = unitOffset;
+    route._master = master;
+    route._maxInFlight = maxInFlight ? maxInFlight : 1;
+    route._inFlight = 0;
+    return true;
+  }
+  return false;  // Routing table is full
+}
+
+bool ModbusGateway::addUpstream(Client* client) {
+  if (!client) return false;
+  for (uint8_t i = 0; i < _upstreamCount; i++) {
+    if (!_upstreams[i].isConnected() && !_upstreams[i].isBusy()) {
+      _upstreams[i].attach(client, _burst);
+      return true;
+    }
+  }
+  return false;  // No free slot
+}
+
+void ModbusGateway::removeUpstream(Client* client) {
+  for (uint8_t i = 0; i < _upstreamCount; i++) {
+    if (_upstreams[i]._client == client) _upstreams[i].detach();
+  }
+}
+
+void ModbusGateway::setRateLimit(uint16_t requestsPerSecond, uint8_t burst) {
+  _rate = requestsPerSecond;
+  _burst = burst ? burst : 1;
+}
+
+void ModbusGateway::setMaxInFlight(uint8_t maxInFlight) {
+  for (uint8_t i = 0; i < _routeCount; i++) {
+    _routes[i]._maxInFlight = maxInFlight ? maxInFlight : 1;
+  }
+}
+
+void ModbusGateway::setCollapsing(bool enable) { _collapse = enable; }
+
+GatewayRequest* ModbusGateway::findIdentical(const GatewayRequest* req) const {
+  for (uint8_t u = 0; u < _upstreamCount; u++) {
+    GatewayUpstream& up = _upstreams[u];
+    for (uint8_t i = 0; i < up._queueSize; i++) {
+      GatewayRequest* other = &up._requests[i];
+      if (other == req) continue;
+      if (other->_state != GatewayRequest::MB_GW_REQ_QUEUED && other->_state != GatewayRequest::MB_GW_REQ_PENDING) continue;
+      if (other->_state == GatewayRequest::MB_GW_REQ_PENDING && (int32_t)(other->_submitted - req->_upstream->_writeDone) <= 0) {
+        continue;  // May have been read before the last write of req's connection
+      }
+      if (other->unit() != req->unit() || other->_len != req->_len) continue;
+      if (memcmp(other->pdu(), req->pdu(), req->_len) == 0) return other;
+    }
+  }
+  return nullptr;
+}
+
+bool ModbusGateway::followsWrite(const GatewayRequest* req) const {
+  const GatewayUpstream& up = *req->_upstream;
+  for (uint8_t i = 0; i < up._queueSize; i++) {
+    const GatewayRequest* other = &up._requests[i];
+    if (other->_state != GatewayRequest::MB_GW_REQ_QUEUED && other->_state != GatewayRequest::MB_GW_REQ_PENDING) continue;
+    if (other->unit() == req->unit() && (int16_t)(other->_seq - req->_seq) < 0 && !isRead(other)) return true;
+  }
+  return false;
+}
+
+bool ModbusGateway::isRead(const GatewayRequest* req) {
+  const uint8_t fn = req->pdu()[0];
+  return fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS || fn == MB_FC_READ_HOLDING_REGISTERS ||
+         fn == MB_FC_READ_INPUT_REGISTERS;
+}
+
+uint8_t ModbusGateway::findRoute(uint8_t unit) const {
+  for (uint8_t i = 0; i < _routeCount; i++) {
+    const GatewayRoute& route = _routes[i];
+    if (route._master && unit >= route._first && unit <= route._last) return i;
+  }
+  return _routeCount;
+}
+
+void ModbusGateway::accept(GatewayRequest* req) {
+  const uint8_t route = findRoute(req->unit());
+  if (route == _routeCount) {
+    req->_upstream->replyException(req, MB_EX_GATEWAY_PATH_UNAVAILABLE);
+    req->clear();
+    return;
+  }
+  req->_route = route;
+  // Only reads are side-effect free, writes always reach the device
+  if (!_collapse || !isRead(req) || followsWrite(req)) return;
+  GatewayRequest* leader = findIdentical(req);
+  if (!leader) return;
+  while (leader->_next) leader = leader->_next;
+  leader->_next = req;
+  req->_state = GatewayRequest::MB_GW_REQ_FOLLOWER;
+}
+
+GatewayRequest* ModbusGateway::nextRequest(GatewayUpstream& up) const {
+  GatewayRequest* oldest = nullptr;
+  for (uint8_t i = 0; i < up._queueSize; i++) {
+    GatewayRequest* req = &up._requests[i];
+    if (req->_state != GatewayRequest::MB_GW_REQ_QUEUED) continue;
+    if (oldest && (int16_t)(req->_seq - oldest->_seq) >= 0) continue;
+    const GatewayRoute& route = _routes[req->_route];
+    // A busy bus must not hold back requests of the same connection for another bus
+    if (route._inFlight >= route._maxInFlight || route._master->getFreePDUCount() == 0) continue;
+    oldest = req;
+  }
+  return oldest;
+}
+
+void ModbusGateway::submit(GatewayRequest* req) {
+  GatewayRoute& route = _routes[req->_route];
+  req->_state = GatewayRequest::MB_GW_REQ_PENDING;
+  req->_submitted = ++_submitted;
+  route._inFlight++;
+  route._master->sendRaw(req->unit() + route._unitOffset, req->pdu(), req->_len, modbusCallback(onResponse), req);
+}
+
+void ModbusGateway::dispatch() {
+  // Round-robin passes until no connection can submit, so every idle route gets work in the same loop
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (uint8_t n = 0; n < _upstreamCount; n++) {
+      GatewayUpstream& up = _upstreams[_rr];
+      _rr = (_rr + 1) % _upstreamCount;
+      GatewayRequest* req = nextRequest(up);
+      if (!req || !up.takeToken(_rate, _burst)) continue;
+      submit(req);
+      progress = true;
+    }
+  }
+}
+
+void ModbusGateway::onResponse(PDU& pdu) {
+  GatewayRequest* req = static_cast<GatewayRequest*>(pdu.getContext());
+  if (!req) return;
+  req->_upstream->_gateway->complete(req, pdu);
+}
+
+void ModbusGateway::complete(GatewayRequest* req, PDU& pdu) {
+  GatewayRoute& route = _routes[req->_route];
+  if (route._inFlight) route._inFlight--;
+  if (!isRead(req)) req->_upstream->_writeDone = _submitted;  // Reads submitted from now on see the write
+  const uint8_t len = pdu.getByteLen();
+  const uint16_t err = pdu.getErr();
+  GatewayRequest* r = req;
+  while (r) {
+    GatewayRequest* next = r->_next;
+    if (!r->_orphan) {
+      if (len) {
+        r->_upstream->reply(r, pdu.getDataArray<uint8_t>(), len);
+      } else if (err) {
+        r->_upstream->replyException(r, toException(err));
+      }  // Broadcast: no response upstream
+    }
+    r->clear();
+    r = next;
+  }
+}
+
+uint8_t ModbusGateway::toException(uint16_t err) {
+  switch (err) {
+    case MB_EX_LIB_NOT_SUPPORTED:
+      return MB_EX_ILLEGAL_FUNCTION;
+    case MB_EX_LIB_TOO_FEW_DATA:
+    case MB_EX_LIB_TOO_MANY_DATA:
+    case MB_EX_LIB_BUFFER_IS_TOO_SMALL:
+      return MB_EX_ILLEGAL_DATA_VALUE;
+    case MB_EX_LIB_QUEUE_FULL:
+    case MB_EX_LIB_NO_MORE_FREE_ADU:
+      return MB_EX_SLAVE_DEVICE_BUSY;
+    case MB_EX_LIB_INVALID_SLAVE:
+    case MB_EX_LIB_TCP_NO_CLIENT_AVAILABLE_FOR_THE_SLAVE:
+      return MB_EX_GATEWAY_PATH_UNAVAILABLE;
+    default:
+      if (err >= MB_EX_ILLEGAL_FUNCTION && err <= MB_EX_GATEWAY_TARGET_DEVICE_FAILED_TO_RESPOND) return err;  // Device exception, passed through
+      return MB_EX_GATEWAY_TARGET_DEVICE_FAILED_TO_RESPOND;  // Timeout, CRC or malformed response
+  }
+}
+
+void ModbusGateway::loop() {
+  for (uint8_t u = 0; u < _upstreamCount; u++) {
+    GatewayUpstream& up = _upstreams[u];
+    if (!up.isConnected()) continue;
+    if (!up._client->connected()) {
+      up.detach();
+      continue;
+    }
+    for (uint8_t i = 0; i < up._queueSize; i++) {  // Drain complete frames
+      GatewayRequest* req = up.receive();
+      if (!req) break;
+      accept(req);
+    }
+  }
+  dispatch();
+}
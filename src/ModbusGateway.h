@@ -0,0 +1,216 @@
+/**
+ * @file ModbusGateway.h
+ * @brief Pass-through Modbus TCP gateway in front of one or more downstream masters.
+ * @details Lets many upstream Modbus TCP clients share RTU buses (ModbusRTUMaster) or remote TCP devices (ModbusTCPClient)
+ *          behind one endpoint, with unit-ID routing, fair queuing, in-flight request collapsing and per-connection
+ *          rate limits. Nothing is cached.
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+#include "GatewayUpstream.h"
+#include "ModbusDef.h"
+
+class ModbusMaster;
+class PDU;
+
+/**
+ * @class GatewayRoute
+ * @brief Maps a range of unit IDs to a downstream master.
+ */
+class GatewayRoute {
+  friend class ModbusGateway;  ///< Access to private members for routing.
+
+ private:
+  uint8_t _first = 0;                ///< First unit ID of the range.
+  uint8_t _last = 0;                 ///< Last unit ID of the range.
+  int16_t _unitOffset = 0;           ///< Added to the unit ID before forwarding.
+  ModbusMaster* _master = nullptr;   ///< Downstream master (nullptr if unused).
+  uint8_t _maxInFlight = 1;          ///< Max requests submitted to the master at once.
+  uint8_t _inFlight = 0;             ///< Requests currently submitted to the master.
+};
+
+/**
+ * @class ModbusGateway
+ * @brief Multiplexes upstream Modbus TCP connections onto downstream masters selected by unit ID.
+ * @details Requests are queued per upstream connection and dispatched round-robin, so one client cannot monopolise a bus.
+ *          Every route has its own in-flight limit, so requests for different buses proceed in parallel and the aggregate
+ *          throughput is the sum of the bus capacities. Identical concurrent reads (same unit and request PDU) are collapsed
+ *          into one downstream transaction whose response is written back to every waiting transaction ID.
+ */
+class ModbusGateway {
+ private:
+  GatewayRoute* _routes = nullptr;         ///< Array of unit-ID routes.
+  uint8_t _routeCount = 0;                 ///< Number of route slots.
+  GatewayUpstream* _upstreams = nullptr;   ///< Array of upstream connection slots.
+  uint8_t _upstreamCount = 0;              ///< Number of upstream connection slots.
+  uint8_t _rr = 0;                         ///< Round-robin position for fair queuing.
+  uint16_t _rate = 0;                      ///< Per-connection request rate limit (req/s, 0 = unlimited).
+  uint8_t _burst = 1;                      ///< Per-connection burst size.
+  bool _collapse = true;                   ///< Collapse identical concurrent reads.
+  uint32_t _submitted = 0;                 ///< Requests submitted so far, orders submissions against completed writes.
+
+  /**
+   * @brief Handles a newly received upstream request.
+   * @details Routes it by unit ID and collapses it onto an identical read if possible, otherwise leaves it queued.
+   * @param req Received request.
+   */
+  void accept(GatewayRequest* req);
+
+  /**
+   * @brief Finds the route of a unit ID.
+   * @param unit Unit ID from the MBAP header.
+   * @return uint8_t Route index, or _routeCount if no route matches.
+   */
+  uint8_t findRoute(uint8_t unit) const;
+
+  /**
+   * @brief Returns the oldest queued request of an upstream connection whose route can take it now.
+   * @param up Upstream connection.
+   * @return GatewayRequest* Request to dispatch, or nullptr if none.
+   */
+  GatewayRequest* nextRequest(GatewayUpstream& up) const;
+
+  /**
+   * @brief Submits a request to the master of its route.
+   * @param req Request to submit.
+   */
+  void submit(GatewayRequest* req);
+
+  /**
+   * @brief Finds a queued or pending request identical to req.
+   * @details Pending requests submitted before the last write of req's connection completed do not qualify.
+   * @param req Request to match.
+   * @return GatewayRequest* Matching leader request, or nullptr if none.
+   */
+  GatewayRequest* findIdentical(const GatewayRequest* req) const;
+
+  /**
+   * @brief Checks if an older request of the same connection and unit is an unfinished write (or other non-read).
+   * @details A read collapsed past it would return the values from before that write.
+   * @param req Read request.
+   * @return bool True if req must reach the device on its own.
+   */
+  bool followsWrite(const GatewayRequest* req) const;
+
+  /**
+   * @brief Checks if a request is a plain read.
+   * @param req Request.
+   * @return bool True for FC 0x01-0x04.
+   */
+  static bool isRead(const GatewayRequest* req);
+
+  /**
+   * @brief Submits queued requests to their masters in round-robin order.
+   */
+  void dispatch();
+
+  /**
+   * @brief Writes the downstream response to every request of the transaction.
+   * @param req Leader request of the transaction.
+   * @param pdu Response PDU from the master.
+   */
+  void complete(GatewayRequest* req, PDU& pdu);
+
+  /**
+   * @brief Response callback of the downstream master.
+   * @param pdu Response PDU, its context is the leader GatewayRequest.
+   */
+  static void onResponse(PDU& pdu);
+
+  /**
+   * @brief Maps a library error to the exception code returned upstream.
+   * @details Device exceptions are passed through, routing errors become MB_EX_GATEWAY_PATH_UNAVAILABLE (0x0A) and
+   *          timeouts, CRC errors and malformed responses MB_EX_GATEWAY_TARGET_DEVICE_FAILED_TO_RESPOND (0x0B).
+   * @param err Error code (MB_EX_*).
+   * @return uint8_t Modbus exception code (1-11).
+   */
+  static uint8_t toException(uint16_t err);
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an empty gateway.
+   */
+  ModbusGateway();
+
+  /**
+   * @brief Destructor.
+   * @details Frees upstream slots and routes, does not delete the masters or TCP clients.
+   */
+  ~ModbusGateway();
+
+  /**
+   * @brief Initializes the gateway with an empty routing table.
+   * @param routeCount Maximum number of routes (see addRoute()).
+   * @param upstreamCount Maximum number of upstream connections.
+   * @param queueSize Request queue capacity per upstream connection.
+   * @param PDUSize PDU buffer size (16-253 bytes, default: 253).
+   */
+  void begin(uint8_t routeCount, uint8_t upstreamCount, uint8_t queueSize, uint8_t PDUSize = MB_PDU_MAX_SIZE);
+
+  /**
+   * @brief Initializes the gateway with a single master serving every unit ID.
+   * @param master Downstream master (already started with begin()).
+   * @param upstreamCount Maximum number of upstream connections.
+   * @param queueSize Request queue capacity per upstream connection.
+   * @param PDUSize PDU buffer size (16-253 bytes, default: 253).
+   */
+  void begin(ModbusMaster* master, uint8_t upstreamCount, uint8_t queueSize, uint8_t PDUSize = MB_PDU_MAX_SIZE);
+
+  /**
+   * @brief Routes a range of unit IDs to a downstream master.
+   * @details Routes are matched in the order they were added. Requests for units without a route are answered
+   *          with the gateway path unavailable exception (0x0A).
+   * @param firstUnit First unit ID of the range.
+   * @param lastUnit Last unit ID of the range.
+   * @param master Downstream master (ModbusRTUMaster for a bus, ModbusTCPClient for remote TCP devices).
+   * @param maxInFlight Max requests submitted to the master at once (default: 1, raise it for pipelining TCP devices).
+   * @param unitOffset Added to the unit ID before forwarding (default: 0).
+   * @return bool True if added, false if the table is full or the range is invalid.
+   */
+  bool addRoute(uint8_t firstUnit, uint8_t lastUnit, ModbusMaster* master, uint8_t maxInFlight = 1, int16_t unitOffset = 0);
+
+  /**
+   * @brief Hands over an accepted upstream connection.
+   * @param client Pointer to the connected TCP client (must stay valid while connected).
+   * @return bool True if added, false if no free upstream slot.
+   */
+  bool addUpstream(Client* client);
+
+  /**
+   * @brief Releases the upstream slot of a connection before its client object is reused.
+   * @details Pending requests of the connection are still completed downstream, their responses are dropped.
+   * @param client Pointer passed to addUpstream().
+   */
+  void removeUpstream(Client* client);
+
+  /**
+   * @brief Limits the request rate of each upstream connection.
+   * @details Requests above the limit stay queued, a full queue is answered with MB_EX_SLAVE_DEVICE_BUSY.
+   * @param requestsPerSecond Allowed requests per second per connection (0 disables the limit).
+   * @param burst Number of requests allowed back-to-back (default: 1).
+   */
+  void setRateLimit(uint16_t requestsPerSecond, uint8_t burst = 1);
+
+  /**
+   * @brief Sets how many requests may be submitted to each routed master at once.
+   * @details Keep it low, requests beyond it wait in the fair per-connection queues instead of the master FIFO.
+   * @param maxInFlight Max submitted requests per route (default: 1).
+   */
+  void setMaxInFlight(uint8_t maxInFlight);
+
+  /**
+   * @brief Enables or disables collapsing of identical concurrent reads.
+   * @param enable True to collapse (default), false to forward every request.
+   */
+  void setCollapsing(bool enable);
+
+  /**
+   * @brief Main loop for upstream receiving and dispatching.
+   * @details Must be called together with the master loop().
+   */
+  void loop();
+};
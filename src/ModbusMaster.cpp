@@ -17,6 +17,62 @@ bool ModbusMaster::isWriteFunction(uint8_t functionCode) const {
          functionCode == MB_FC_MASK_WRITE_REGISTER;
 }
 
+void ModbusMaster::setCoalescer(RequestCoalescer* coalescer) { _coalescer = coalescer; }
+
+void ModbusMaster::setWriteShadow(WriteShadow* shadow) { _shadow = shadow; }
+
+bool ModbusMaster::completeFromShadow(PDU* pdu) {
+  if (!_shadow || pdu->_raw || pdu->isRepeating() || pdu->getSlaveId() == 0) return false;
+  const uint8_t* tx = pdu->_TXPDUbuffer;
+  if (_shadow->matches(pdu)) {
+    pdu->_err = MB_EX_SUCCESS;
+    pdu->callCallback();
+    return true;
+  }
+  if (isWriteFunction(tx[0]) || (tx[0] == MB_FC_DIAGNOSTICS && tx[1] == 0x00 && tx[2] == 0x01)) {
+    _shadow->expect(pdu);
+    pdu->_shadow = _shadow;
+  }
+  return false;
+}
+
+void ModbusMaster::setLazyDecoding(bool enable) { _lazyDecoding = enable; }
+
+void ModbusMaster::setMaskWriteFallback(MaskFallback* fallback) { _maskFallback = fallback; }
+
+bool ModbusMaster::holdMaskWrite(PDU* pdu) {
+  if (!_maskFallback || pdu->_raw || pdu->isRepeating() || pdu->_TXPDUbuffer[0] != MB_FC_MASK_WRITE_REGISTER) return false;
+  const uint8_t slave = pdu->getSlaveId();
+  if (slave == 0 || !_maskFallback->_slaves.isSet(slave)) return false;
+  const uint16_t address = (pdu->_TXPDUbuffer[1] << 8) | pdu->_TXPDUbuffer[2];
+  MaskLock* free = nullptr;
+  for (MaskLock& lock : _maskFallback->_locks) {
+    if (!lock._master) {
+      if (!free) free = &lock;
+    } else if (lock._slave == slave && lock._address == address) {
+      if (lock._writing) {  // Too late for the running cycle
+        chainMask(lock._waiting, pdu);
+      } else {
+        chainMask(lock._current, pdu);
+        composeMask(lock, pdu);
+      }
+      return true;
+    }
+  }
+  if (!free) {
+    pdu->_err = MB_EX_LIB_QUEUE_FULL;
+    pdu->callCallback();
+    return true;
+  }
+  free->_master = this;
+  free->_slave = slave;
+  free->_address = address;
+  free->_current = pdu;
+  free->_waiting = nullptr;
+  startMaskCycle(*free);
+  return true;
+}
+
 void ModbusMaster::writeSingleCoil(const Slaves& slaves, uint16_t address, bool value, const modbusCallback& cb) {
   PDU* pdu = getFreePDU(cb, slaves);
   if (!pdu) return;
@@ -101,6 +157,62 @@ void ModbusMaster::writeCoils(uint8_t slave, uint16_t address, const bool* src,
   sendPDU(pdu, slave);
 }
 
+void ModbusMaster::writeCoilsByRef(const Slaves& slaves, uint16_t address, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createWriteMultipleCoils(address, src, byteCount, coilCount, cb, true)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slaves.getActive());
+}
+
+void ModbusMaster::writeCoilsByRef(uint8_t slave, uint16_t address, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb) {
+  if (slave == 0 && !isWriteFunction(MB_FC_WRITE_MULTIPLE_COILS)) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createWriteMultipleCoils(address, src, byteCount, coilCount, cb, true)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slave);
+}
+
+void ModbusMaster::writeCoilsByRef(const Slaves& slaves, uint16_t address, const bool* src, uint16_t coilCount, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createWriteMultipleCoils(address, src, coilCount, cb, true)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slaves.getActive());
+}
+
+void ModbusMaster::writeCoilsByRef(uint8_t slave, uint16_t address, const bool* src, uint16_t coilCount, const modbusCallback& cb) {
+  if (slave == 0 && !isWriteFunction(MB_FC_WRITE_MULTIPLE_COILS)) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createWriteMultipleCoils(address, src, coilCount, cb, true)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slave);
+}
+
 void ModbusMaster::writeCoils(const Slaves& slaves, uint16_t address, std::initializer_list<bool> list, const modbusCallback& cb) {
   PDU* pdu = getFreePDU(cb, slaves);
   if (!pdu) return;
@@ -419,4 +531,285 @@ void ModbusMaster::diagnostic(uint8_t slave, uint16_t subFunction, uint16_t data
     return;
   }
   sendPDU(pdu, slave);
-}
\ No newline at end of file
+}
+
+void ModbusMaster::sendRaw(uint8_t slave, const uint8_t* src, uint8_t len, const modbusCallback& cb, void* context) {
+  if (slave == 0 && (len == 0 || !isWriteFunction(src[0]))) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    ret._context = context;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  pdu->_context = context;
+  if (pdu->createRaw(src, len, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slave);
+}
+
+uint16_t ModbusMaster::readBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, uint16_t* dst, const blockCallback& cb) {
+  if (table != MB_TABLE_HOLDING_REGISTERS && table != MB_TABLE_INPUT_REGISTERS) return MB_EX_LIB_INVALID_ARGUMENT;
+  const uint8_t fn = table == MB_TABLE_HOLDING_REGISTERS ? MB_FC_READ_HOLDING_REGISTERS : MB_FC_READ_INPUT_REGISTERS;
+  if (!dst) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint16_t err = startBlock(block, slave, fn, address, count, cb);
+  if (err) return err;
+  block._dst = reinterpret_cast<uint8_t*>(dst);
+  pumpBlock(block);
+  return MB_EX_SUCCESS;
+}
+
+uint16_t ModbusMaster::readBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, uint8_t* dst, const blockCallback& cb) {
+  if (table != MB_TABLE_COILS && table != MB_TABLE_DISCRETE_INPUTS) return MB_EX_LIB_INVALID_ARGUMENT;
+  const uint8_t fn = table == MB_TABLE_COILS ? MB_FC_READ_COILS : MB_FC_READ_DISCRETE_INPUTS;
+  if (!dst) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint16_t err = startBlock(block, slave, fn, address, count, cb);
+  if (err) return err;
+  block._dst = dst;
+  pumpBlock(block);
+  return MB_EX_SUCCESS;
+}
+
+uint16_t ModbusMaster::writeBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, const uint16_t* src, const blockCallback& cb) {
+  if (table != MB_TABLE_HOLDING_REGISTERS || !src) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint16_t err = startBlock(block, slave, MB_FC_WRITE_MULTIPLE_REGISTERS, address, count, cb);
+  if (err) return err;
+  block._src = reinterpret_cast<const uint8_t*>(src);
+  pumpBlock(block);
+  return MB_EX_SUCCESS;
+}
+
+uint16_t ModbusMaster::writeBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, const uint8_t* src, const blockCallback& cb) {
+  if (table != MB_TABLE_COILS || !src) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint16_t err = startBlock(block, slave, MB_FC_WRITE_MULTIPLE_COILS, address, count, cb);
+  if (err) return err;
+  block._src = src;
+  pumpBlock(block);
+  return MB_EX_SUCCESS;
+}
+
+uint16_t ModbusMaster::startBlock(BlockTransfer& block, uint8_t slave, uint8_t fn, uint16_t address, uint16_t count, const blockCallback& cb) {
+  if (block._busy) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (slave == 0 || slave > MB_MAX_SLAVE_ID) return MB_EX_LIB_INVALID_SLAVE;
+  if (count == 0) return MB_EX_LIB_TOO_FEW_DATA;
+  if ((uint32_t)address + count > 0x10000UL) return MB_EX_LIB_TOO_MANY_DATA;
+  const bool bits = fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS || fn == MB_FC_WRITE_MULTIPLE_COILS;
+  if (bits && block._chunk && block._chunk < 8) return MB_EX_LIB_INVALID_ARGUMENT;  // Rounds down to no coils
+  block.reset();
+  block._master = this;
+  block._slave = slave;
+  block._fn = fn;
+  block._address = address;
+  block._count = count;
+  block._dst = nullptr;
+  block._src = nullptr;
+  block._callback = cb;
+  block._busy = true;
+  return MB_EX_SUCCESS;
+}
+
+bool ModbusMaster::sendBlockChunk(BlockTransfer& block) {
+  PDU* pdu = getFreePDU(modbusCallback(onBlockChunk), block._slave);
+  if (!pdu) return false;  // The failed callback carries no context and is ignored
+  const uint8_t fn = block._fn;
+  const bool bits = fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS || fn == MB_FC_WRITE_MULTIPLE_COILS;
+  // Largest chunk allowed by the protocol, the PDU buffer and the device
+  uint16_t limit;
+  uint16_t fit;
+  switch (fn) {
+    case MB_FC_READ_COILS:
+    case MB_FC_READ_DISCRETE_INPUTS:
+      limit = MB_MAX_READ_COILS;
+      fit = (pdu->_PDUSize - 2) * 8;
+      break;
+    case MB_FC_WRITE_MULTIPLE_COILS:
+      limit = MB_MAX_WRITE_COILS;
+      fit = (pdu->_PDUSize - 6) * 8;
+      break;
+    case MB_FC_WRITE_MULTIPLE_REGISTERS:
+      limit = MB_MAX_WRITE_REGISTERS;
+      fit = (pdu->_PDUSize - 6) / 2;
+      break;
+    default:
+      limit = MB_MAX_READ_REGISTERS;
+      fit = (pdu->_PDUSize - 2) / 2;
+      break;
+  }
+  if (fit < limit) limit = fit;
+  if (block._chunk && block._chunk < limit) limit = block._chunk;
+  if (bits) limit &= ~7;  // Chunks start on a byte of the buffer, at least 8 coils as checked by startBlock()
+  const uint16_t offset = block._next;
+  const uint16_t left = block._count - offset;
+  const uint16_t count = left < limit ? left : limit;
+  const uint16_t address = block._address + offset;
+  const modbusCallback cb(onBlockChunk);
+  uint16_t err;
+  switch (fn) {
+    case MB_FC_READ_COILS:
+    case MB_FC_READ_DISCRETE_INPUTS:
+      err = pdu->createReadState(fn, address, count, cb);
+      break;
+    case MB_FC_WRITE_MULTIPLE_COILS:
+      err = pdu->createWriteMultipleCoils(address, block._src + offset / 8, (count + 7) / 8, count, cb);
+      break;
+    case MB_FC_WRITE_MULTIPLE_REGISTERS:
+      err = pdu->createWriteHoldingRegister(address, reinterpret_cast<const uint16_t*>(block._src) + offset, count, cb);
+      break;
+    default:
+      err = pdu->createReadRegisters<uint16_t>(fn, address, count, cb);
+      break;
+  }
+  block._next += count;
+  if (err) {
+    block.fail(offset, count, err);
+    pdu->clear();
+    return true;
+  }
+  // Chunks are sized deliberately, the context keeps them out of coalescing
+  pdu->_context = &block;
+  pdu->_reqAddr = address;
+  pdu->_reqQty = count;
+  block._pending++;
+  sendPDU(pdu, block._slave);
+  return true;
+}
+
+void ModbusMaster::pumpBlock(BlockTransfer& block) {
+  if (block._pumping) return;  // A chunk completed synchronously while sending, the outer call continues
+  block._pumping = true;
+  while (block._pending < block._window && block._next < block._count) {
+    if (!sendBlockChunk(block)) break;
+  }
+  block._pumping = false;
+  if (block._pending) return;
+  if (block._next < block._count) {  // Nothing in progress and no free PDU
+    block.fail(block._next, block._count - block._next, MB_EX_LIB_NO_MORE_FREE_ADU);
+    block._next = block._count;
+  }
+  block._busy = false;
+  blockCallback cb = block._callback;  // The callback may start the next transfer on the same block
+  cb(block);
+}
+
+void ModbusMaster::onBlockChunk(PDU& pdu) {
+  BlockTransfer* block = static_cast<BlockTransfer*>(pdu.getContext());
+  if (!block) return;
+  const uint16_t offset = pdu._reqAddr - block->_address;
+  const uint16_t count = pdu._reqQty;
+  if (pdu.getErr()) {
+    block->fail(offset, count, pdu.getErr());
+  } else if (block->_dst) {
+    const uint8_t fn = block->_fn;
+    if (fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS) {
+      memcpy(block->_dst + offset / 8, pdu.getDataArray<uint8_t>(), (count + 7) / 8);
+    } else {
+      memcpy(block->_dst + offset * 2, pdu.getDataArray<uint8_t>(), count * 2);  // Already host order
+    }
+  }
+  block->_pending--;
+  block->_master->pumpBlock(*block);
+}
+
+void ModbusMaster::composeMask(MaskLock& lock, const PDU* pdu) {
+  const uint8_t* tx = pdu->_TXPDUbuffer;
+  const uint16_t andMask = (tx[3] << 8) | tx[4];
+  const uint16_t orMask = (tx[5] << 8) | tx[6];
+  lock._and &= andMask;
+  lock._or = (lock._or & andMask) | (orMask & ~andMask);
+}
+
+void ModbusMaster::chainMask(PDU*& head, PDU* pdu) {
+  if (!head) {
+    head = pdu;
+    return;
+  }
+  PDU* last = head;
+  while (last->_merged) last = last->_merged;
+  last->_merged = pdu;
+}
+
+void ModbusMaster::startMaskCycle(MaskLock& lock) {
+  lock._and = 0xFFFF;
+  lock._or = 0;
+  lock._writing = false;
+  for (PDU* pdu = lock._current; pdu; pdu = pdu->_merged) composeMask(lock, pdu);
+  const modbusCallback cb(onMaskRead);
+  PDU* read = getFreePDU(cb, lock._slave);
+  if (!read) {  // The failed callback carries no context and is ignored
+    finishMaskCycle(lock, MB_EX_LIB_NO_MORE_FREE_ADU);
+    return;
+  }
+  const uint16_t err = read->createReadRegisters<uint16_t>(MB_FC_READ_HOLDING_REGISTERS, lock._address, 1, cb);
+  if (err) {
+    read->clear();
+    finishMaskCycle(lock, err);
+    return;
+  }
+  read->_context = &lock;  // Also keeps the read out of coalescing
+  sendPDU(read, lock._slave);
+}
+
+void ModbusMaster::writeMasked(MaskLock& lock, uint16_t value) {
+  lock._writing = true;
+  const modbusCallback cb(onMaskWritten);
+  PDU* write = getFreePDU(cb, lock._slave);
+  if (!write) {
+    finishMaskCycle(lock, MB_EX_LIB_NO_MORE_FREE_ADU);
+    return;
+  }
+  const uint16_t err = write->createWriteSingleRegister(lock._address, (value & lock._and) | (lock._or & ~lock._and), cb);
+  if (err) {
+    write->clear();
+    finishMaskCycle(lock, err);
+    return;
+  }
+  write->_context = &lock;
+  sendPDU(write, lock._slave);
+}
+
+void ModbusMaster::finishMaskCycle(MaskLock& lock, uint16_t err) {
+  PDU* done = lock._current;
+  // Mask writes issued from the callbacks join the next cycle
+  lock._current = lock._waiting;
+  lock._waiting = nullptr;
+  lock._writing = false;
+  done->_err = err;
+  done->callCallback();  // Fans out to the chained mask writes
+  if (lock._current) {
+    startMaskCycle(lock);
+  } else {
+    lock._master = nullptr;
+  }
+}
+
+void ModbusMaster::onMaskRead(PDU& pdu) {
+  MaskLock* lock = static_cast<MaskLock*>(pdu.getContext());
+  if (!lock) return;
+  if (pdu.getErr()) {
+    lock->_master->finishMaskCycle(*lock, pdu.getErr());
+    return;
+  }
+  lock->_master->writeMasked(*lock, pdu.getDataArray<uint16_t>()[0]);
+}
+
+void ModbusMaster::onMaskWritten(PDU& pdu) {
+  MaskLock* lock = static_cast<MaskLock*>(pdu.getContext());
+  if (!lock) return;
+  lock->_master->finishMaskCycle(*lock, pdu.getErr());
+}
+
+void ModbusMaster::bindScaling(PDU* pdu, const ScalingTable& table, float* out) {
+  pdu->_scaling = &table;
+  pdu->_scaled = out;
+  pdu->_scaledDouble = false;
+}
+
+void ModbusMaster::bindScaling(PDU* pdu, const ScalingTable& table, double* out) {
+  pdu->_scaling = &table;
+  pdu->_scaled = out;
+  pdu->_scaledDouble = true;
+}
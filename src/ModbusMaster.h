@@ -9,8 +9,14 @@
 
 #include <initializer_list>
 
+#include "BlockTransfer.h"
+#include "MaskLock.h"
 #include "ModbusCallbackTypes.h"
+#include "RegisterSchema.h"
+#include "RequestCoalescer.h"
+#include "ScalingTable.h"
 #include "Slaves.h"
+#include "WriteShadow.h"
 
 class PDU;
 
@@ -28,7 +34,114 @@ class ModbusMaster {
    */
   bool isWriteFunction(uint8_t functionCode) const;
 
+  /**
+   * @brief Validates and starts a block transfer.
+   * @param block Transfer state.
+   * @param slave Slave ID (1-247).
+   * @param fn Function code of the chunks.
+   * @param address First address of the block.
+   * @param count Registers or coils in the block.
+   * @param cb Completion callback.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t startBlock(BlockTransfer& block, uint8_t slave, uint8_t fn, uint16_t address, uint16_t count, const blockCallback& cb);
+
+  /**
+   * @brief Sends the next chunk of a block transfer.
+   * @param block Transfer state.
+   * @return bool True if the chunk was handled, false if no PDU is free.
+   */
+  bool sendBlockChunk(BlockTransfer& block);
+
+  /**
+   * @brief Sends chunks up to the window and completes the transfer when nothing is left in progress.
+   * @param block Transfer state.
+   */
+  void pumpBlock(BlockTransfer& block);
+
+  /**
+   * @brief Response callback of every chunk, copies the data and continues the transfer.
+   * @param pdu Chunk PDU, its context is the BlockTransfer.
+   */
+  static void onBlockChunk(PDU& pdu);
+
+  /**
+   * @brief Composes the masks of a mask write into the current cycle of its lock.
+   * @param lock Register lock.
+   * @param pdu FC 0x16 request.
+   */
+  static void composeMask(MaskLock& lock, const PDU* pdu);
+
+  /**
+   * @brief Appends a held mask write to a chain.
+   * @param head First PDU of the chain, nullptr if empty.
+   * @param pdu FC 0x16 request.
+   */
+  static void chainMask(PDU*& head, PDU* pdu);
+
+  /**
+   * @brief Starts the read of a read-modify-write cycle for the mask writes in lock._current.
+   * @param lock Register lock.
+   */
+  void startMaskCycle(MaskLock& lock);
+
+  /**
+   * @brief Writes the masked value of a read-modify-write cycle.
+   * @param lock Register lock.
+   * @param value Register value read from the slave.
+   */
+  void writeMasked(MaskLock& lock, uint16_t value);
+
+  /**
+   * @brief Completes the mask writes of the current cycle and starts the next one or frees the lock.
+   * @param lock Register lock.
+   * @param err Result of the cycle (MB_EX_*), 0 if successful.
+   */
+  void finishMaskCycle(MaskLock& lock, uint16_t err);
+
+  /**
+   * @brief Response callback of the read of a read-modify-write cycle.
+   * @param pdu Read PDU, its context is the MaskLock.
+   */
+  static void onMaskRead(PDU& pdu);
+
+  /**
+   * @brief Response callback of the write of a read-modify-write cycle.
+   * @param pdu Write PDU, its context is the MaskLock.
+   */
+  static void onMaskWritten(PDU& pdu);
+
+  /**
+   * @brief Binds a scaling table and its output array to a register read.
+   * @param pdu Created read request.
+   * @param table Scaling table.
+   * @param out Output array (float or double).
+   */
+  static void bindScaling(PDU* pdu, const ScalingTable& table, float* out);
+  static void bindScaling(PDU* pdu, const ScalingTable& table, double* out);
+
  protected:
+  RequestCoalescer* _coalescer = nullptr;  ///< Merges queued requests before they are sent, nullptr if disabled.
+  WriteShadow* _shadow = nullptr;          ///< Suppresses unchanged writes, nullptr if disabled.
+  MaskFallback* _maskFallback = nullptr;   ///< Emulated mask writes, nullptr if disabled.
+  bool _lazyDecoding = false;              ///< Register responses are converted on access.
+
+  /**
+   * @brief Completes a write locally if the shadow already holds its values.
+   * @details Otherwise marks the PDU so its result updates the shadow. Called by sendPDU() before queueing.
+   * @param pdu PDU with its head set.
+   * @return bool True if the callback was called and the PDU must not be queued.
+   */
+  bool completeFromShadow(PDU* pdu);
+
+  /**
+   * @brief Takes over a mask write to a slave of the fallback set and runs it as a read-modify-write.
+   * @details Called by sendPDU() before queueing. The PDU is held until its cycle completes.
+   * @param pdu PDU with its head set.
+   * @return bool True if the PDU must not be queued.
+   */
+  bool holdMaskWrite(PDU* pdu);
+
   /**
    * @brief Retrieves a free PDU instance for the operation.
    * @param cb Callback function for response handling.
@@ -57,6 +170,13 @@ class ModbusMaster {
   virtual bool sendPDU(PDU* pdu, uint8_t slave) = 0;
 
  public:
+  /**
+   * @brief Returns the number of PDU instances currently available for new requests.
+   * @return uint8_t Number of free PDUs.
+   * @note Must be overridden by derived classes.
+   */
+  virtual uint8_t getFreePDUCount() const = 0;
+
   /**
    * @brief Default constructor.
    * @details Initializes an empty ModbusMaster.
@@ -69,6 +189,39 @@ class ModbusMaster {
    */
   virtual ~ModbusMaster();
 
+  /**
+   * @brief Merges, deduplicates or fuses queued requests before they are sent.
+   * @details The coalescer holds the settings and is shared by all connections of the master. See RequestCoalescer.
+   * @param coalescer Coalescer, nullptr to disable (default).
+   */
+  virtual void setCoalescer(RequestCoalescer* coalescer);
+
+  /**
+   * @brief Suppresses writes that would not change the values last acknowledged by the slave.
+   * @details A suppressed write is not sent, its callback is called with no error. Only writes to ranges added to
+   *          the shadow are tracked, broadcasts and writes to Slaves sets are always sent. See WriteShadow.
+   * @param shadow Shadow image, nullptr to disable (default).
+   */
+  void setWriteShadow(WriteShadow* shadow);
+
+  /**
+   * @brief Keeps register responses in wire format and converts values when they are accessed.
+   * @details getData() converts the requested value only, copyData() converts into a caller buffer,
+   *          getDataArray() converts the whole response once. getWireData() gives the unconverted registers.
+   *          Responses of odd-sized element types are always converted.
+   * @param enable True to decode lazily (default: disabled).
+   */
+  void setLazyDecoding(bool enable);
+
+  /**
+   * @brief Emulates mask writes with a read (FC 0x03) and a write (FC 0x06) for slaves without FC 0x16.
+   * @details Each register is locked during its read-modify-write, mask writes to it are composed into the running
+   *          cycle until the read is answered and wait for the next cycle afterwards. Up to MB_MASK_LOCKS registers
+   *          are handled at once. Needs two free PDUs besides the held mask writes.
+   * @param fallback Slaves without FC 0x16 and their register locks, nullptr to disable (default).
+   */
+  void setMaskWriteFallback(MaskFallback* fallback);
+
   /**
    * @brief Writes a single coil to the specified address for multiple slaves.
    * @param slaves Set of slave IDs.
@@ -147,6 +300,53 @@ class ModbusMaster {
    */
   void writeCoils(uint8_t slave, uint16_t address, std::initializer_list<bool> values, const modbusCallback& cb);
 
+  /**
+   * @brief Writes multiple coils from a caller-owned byte array for multiple slaves, read at transmit time.
+   * @details src is not copied: it must stay valid until the callback ran for the last slave, every transmission
+   *          sends its current content.
+   * @param slaves Set of slave IDs.
+   * @param address Starting coil address (0-65535).
+   * @param src Source byte array containing coil values.
+   * @param byteCount Number of bytes in the source array.
+   * @param coilCount Number of coils to write.
+   * @param cb Callback function for response handling.
+   */
+  void writeCoilsByRef(const Slaves& slaves, uint16_t address, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb);
+
+  /**
+   * @brief Writes multiple coils from a caller-owned byte array for a single slave or broadcast, read at transmit time.
+   * @details See the Slaves overload.
+   * @param slave Slave ID (1-247, or 0 for broadcast, RTU only).
+   * @param address Starting coil address (0-65535).
+   * @param src Source byte array containing coil values.
+   * @param byteCount Number of bytes in the source array.
+   * @param coilCount Number of coils to write.
+   * @param cb Callback function for response handling.
+   */
+  void writeCoilsByRef(uint8_t slave, uint16_t address, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb);
+
+  /**
+   * @brief Writes multiple coils from a caller-owned boolean array for multiple slaves, packed at transmit time.
+   * @details See the byte array overload.
+   * @param slaves Set of slave IDs.
+   * @param address Starting coil address (0-65535).
+   * @param values Source boolean array containing coil values.
+   * @param count Number of coils to write.
+   * @param cb Callback function for response handling.
+   */
+  void writeCoilsByRef(const Slaves& slaves, uint16_t address, const bool* values, uint16_t count, const modbusCallback& cb);
+
+  /**
+   * @brief Writes multiple coils from a caller-owned boolean array for a single slave or broadcast, packed at transmit time.
+   * @details See the byte array overload.
+   * @param slave Slave ID (1-247, or 0 for broadcast, RTU only).
+   * @param address Starting coil address (0-65535).
+   * @param values Source boolean array containing coil values.
+   * @param count Number of coils to write.
+   * @param cb Callback function for response handling.
+   */
+  void writeCoilsByRef(uint8_t slave, uint16_t address, const bool* values, uint16_t count, const modbusCallback& cb);
+
   /**
    * @brief Reads coils as bytes for multiple slaves.
    * @param slaves Set of slave IDs.
@@ -401,6 +601,34 @@ class ModbusMaster {
   template <typename T>
   void writeHoldingRegisters(uint8_t slave, uint16_t address, const T* values, uint16_t count, const modbusCallback& cb);
 
+  /**
+   * @brief Writes multiple holding registers from a caller-owned array for multiple slaves, converted at transmit time.
+   * @details values is not copied: it must stay valid until the callback ran for the last slave, every transmission
+   *          sends its current content. The TX buffer only holds the request header, so PDUSize may be smaller
+   *          than the written data.
+   * @tparam T Type of the register values (padded size up to MB_PAYLOAD_CHUNK bytes).
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param values Source array containing register values.
+   * @param count Number of values to write.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void writeHoldingRegistersByRef(const Slaves& slaves, uint16_t address, const T* values, uint16_t count, const modbusCallback& cb);
+
+  /**
+   * @brief Writes multiple holding registers from a caller-owned array for a single slave or broadcast, converted at transmit time.
+   * @details See the Slaves overload.
+   * @tparam T Type of the register values (padded size up to MB_PAYLOAD_CHUNK bytes).
+   * @param slave Slave ID (1-247, or 0 for broadcast, RTU only).
+   * @param address Starting register address (0-65535).
+   * @param values Source array containing register values.
+   * @param count Number of values to write.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void writeHoldingRegistersByRef(uint8_t slave, uint16_t address, const T* values, uint16_t count, const modbusCallback& cb);
+
   /**
    * @brief Writes multiple holding registers from an initializer list for multiple slaves.
    * @tparam T Type of the register values.
@@ -465,6 +693,63 @@ class ModbusMaster {
   template <typename T = uint16_t>
   void readHoldingRegisters(uint8_t slave, uint16_t address, uint8_t count, const modbusCallback& cb);
 
+  /**
+   * @brief Reads multiple holding registers for multiple slaves and decodes them into bound memory.
+   * @details The response is decoded straight from the receive frame into dst before the callback is called,
+   *          byte-wise, so dst needs no particular alignment. dst must stay valid until the callback ran.
+   * @tparam T Type of the register data (e.g. uint16_t, float, Ordered<float, MB_ORDER_ABCD>, a struct of them).
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param count Number of values to read.
+   * @param dst Destination of count values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readHoldingRegisters(const Slaves& slaves, uint16_t address, uint8_t count, T* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Reads multiple holding registers for a single slave and decodes them into bound memory.
+   * @details See the Slaves overload.
+   * @tparam T Type of the register data.
+   * @param slave Slave ID (1-247).
+   * @param address Starting register address (0-65535).
+   * @param count Number of values to read.
+   * @param dst Destination of count values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readHoldingRegisters(uint8_t slave, uint16_t address, uint8_t count, T* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Reads multiple holding registers for multiple slaves and converts them to engineering values.
+   * @details Before the callback is called, the response is converted by the scaling table into out, in one loop per
+   *          value type. The registers stay available in the callback. table and out must stay valid until the
+   *          callback ran for the last slave.
+   * @tparam T Output type (float or double).
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param count Number of registers to read (at least table.getRegisters()).
+   * @param table Scaling table, offsets relative to address.
+   * @param out Output array of table.getSlots() values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readHoldingRegisters(const Slaves& slaves, uint16_t address, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb);
+
+  /**
+   * @brief Reads multiple holding registers for a single slave and converts them to engineering values.
+   * @details See the Slaves overload.
+   * @tparam T Output type (float or double).
+   * @param slave Slave ID (1-247).
+   * @param address Starting register address (0-65535).
+   * @param count Number of registers to read (at least table.getRegisters()).
+   * @param table Scaling table, offsets relative to address.
+   * @param out Output array of table.getSlots() values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readHoldingRegisters(uint8_t slave, uint16_t address, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb);
+
   /**
    * @brief Reads a single input register for multiple slaves.
    * @tparam T Type of the register data (default: uint16_t).
@@ -507,6 +792,206 @@ class ModbusMaster {
   template <typename T = uint16_t>
   void readInputRegisters(uint8_t slave, uint16_t address, uint8_t count, const modbusCallback& cb);
 
+  /**
+   * @brief Reads multiple input registers for multiple slaves and decodes them into bound memory.
+   * @details The response is decoded straight from the receive frame into dst before the callback is called,
+   *          byte-wise, so dst needs no particular alignment. dst must stay valid until the callback ran.
+   * @tparam T Type of the register data (e.g. uint16_t, float, Ordered<float, MB_ORDER_ABCD>, a struct of them).
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param count Number of values to read.
+   * @param dst Destination of count values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readInputRegisters(const Slaves& slaves, uint16_t address, uint8_t count, T* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Reads multiple input registers for a single slave and decodes them into bound memory.
+   * @details See the Slaves overload.
+   * @tparam T Type of the register data.
+   * @param slave Slave ID (1-247).
+   * @param address Starting register address (0-65535).
+   * @param count Number of values to read.
+   * @param dst Destination of count values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readInputRegisters(uint8_t slave, uint16_t address, uint8_t count, T* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Reads multiple input registers for multiple slaves and converts them to engineering values.
+   * @details Before the callback is called, the response is converted by the scaling table into out, in one loop per
+   *          value type. The registers stay available in the callback. table and out must stay valid until the
+   *          callback ran for the last slave.
+   * @tparam T Output type (float or double).
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param count Number of registers to read (at least table.getRegisters()).
+   * @param table Scaling table, offsets relative to address.
+   * @param out Output array of table.getSlots() values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readInputRegisters(const Slaves& slaves, uint16_t address, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb);
+
+  /**
+   * @brief Reads multiple input registers for a single slave and converts them to engineering values.
+   * @details See the Slaves overload.
+   * @tparam T Output type (float or double).
+   * @param slave Slave ID (1-247).
+   * @param address Starting register address (0-65535).
+   * @param count Number of registers to read (at least table.getRegisters()).
+   * @param table Scaling table, offsets relative to address.
+   * @param out Output array of table.getSlots() values.
+   * @param cb Callback function for response handling.
+   */
+  template <typename T>
+  void readInputRegisters(uint8_t slave, uint16_t address, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb);
+
+  /**
+   * @brief Reads a record of holding registers for multiple slaves and decodes it into a struct.
+   * @details Every response is decoded into dst before the callback is called. dst must stay valid until the
+   *          callback ran for the last slave.
+   * @tparam SCHEMA RegisterSchema of the struct.
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param dst Destination struct.
+   * @param cb Callback function for response handling.
+   */
+  template <typename SCHEMA>
+  void readRecord(const Slaves& slaves, uint16_t address, typename SCHEMA::type* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Reads a record of holding registers for a single slave and decodes it into a struct.
+   * @details See the Slaves overload.
+   * @tparam SCHEMA RegisterSchema of the struct.
+   * @param slave Slave ID (1-247).
+   * @param address Starting register address (0-65535).
+   * @param dst Destination struct.
+   * @param cb Callback function for response handling.
+   */
+  template <typename SCHEMA>
+  void readRecord(uint8_t slave, uint16_t address, typename SCHEMA::type* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Reads a record of input registers for multiple slaves and decodes it into a struct.
+   * @details Every response is decoded into dst before the callback is called. dst must stay valid until the
+   *          callback ran for the last slave.
+   * @tparam SCHEMA RegisterSchema of the struct.
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param dst Destination struct.
+   * @param cb Callback function for response handling.
+   */
+  template <typename SCHEMA>
+  void readInputRecord(const Slaves& slaves, uint16_t address, typename SCHEMA::type* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Reads a record of input registers for a single slave and decodes it into a struct.
+   * @details See the Slaves overload.
+   * @tparam SCHEMA RegisterSchema of the struct.
+   * @param slave Slave ID (1-247).
+   * @param address Starting register address (0-65535).
+   * @param dst Destination struct.
+   * @param cb Callback function for response handling.
+   */
+  template <typename SCHEMA>
+  void readInputRecord(uint8_t slave, uint16_t address, typename SCHEMA::type* dst, const modbusCallback& cb);
+
+  /**
+   * @brief Writes a struct as a record of holding registers for multiple slaves.
+   * @tparam SCHEMA RegisterSchema of the struct.
+   * @param slaves Set of slave IDs.
+   * @param address Starting register address (0-65535).
+   * @param src Source struct, encoded when the request is created.
+   * @param cb Callback function for response handling.
+   */
+  template <typename SCHEMA>
+  void writeRecord(const Slaves& slaves, uint16_t address, const typename SCHEMA::type* src, const modbusCallback& cb);
+
+  /**
+   * @brief Writes a struct as a record of holding registers for a single slave or broadcast.
+   * @tparam SCHEMA RegisterSchema of the struct.
+   * @param slave Slave ID (1-247, or 0 for broadcast, RTU only).
+   * @param address Starting register address (0-65535).
+   * @param src Source struct, encoded when the request is created.
+   * @param cb Callback function for response handling.
+   */
+  template <typename SCHEMA>
+  void writeRecord(uint8_t slave, uint16_t address, const typename SCHEMA::type* src, const modbusCallback& cb);
+
+  /**
+   * @brief Sends a pre-encoded request PDU to a single slave (pass-through).
+   * @details The response PDU is not decoded: on success getDataArray<uint8_t>() and getByteLen()
+   *          expose the whole response PDU, on a Modbus exception the two byte exception PDU.
+   *          Library errors (timeout, CRC...) leave the data empty and set getErr().
+   * @param slave Slave ID (1-247, or 0 for broadcast write functions, RTU only).
+   * @param pdu Request PDU (function code followed by data).
+   * @param len Length of the request PDU.
+   * @param cb Callback function for response handling.
+   * @param context Opaque pointer returned by PDU::getContext() in the callback.
+   */
+  void sendRaw(uint8_t slave, const uint8_t* pdu, uint8_t len, const modbusCallback& cb, void* context = nullptr);
+
+  /**
+   * @brief Reads a register block of any size into one buffer.
+   * @details The block is split into transactions of at most 125 registers (or BlockTransfer::setChunkSize()),
+   *          which are pipelined up to BlockTransfer::setWindow(). cb is called once when every chunk completed,
+   *          BlockTransfer::getFailure() tells which sub-ranges failed, the rest of dst is valid.
+   * @param block Transfer state (must stay valid until cb was called).
+   * @param slave Slave ID (1-247).
+   * @param table MB_TABLE_HOLDING_REGISTERS or MB_TABLE_INPUT_REGISTERS.
+   * @param address First register address.
+   * @param count Number of registers.
+   * @param dst Destination for count registers.
+   * @param cb Completion callback.
+   * @return uint16_t Error code (MB_EX_*) or 0 if started, cb is only called for started transfers.
+   */
+  uint16_t readBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, uint16_t* dst, const blockCallback& cb);
+
+  /**
+   * @brief Reads a coil or discrete input block of any size into one packed bit buffer.
+   * @details Same as the register variant, chunks hold at most 2000 bits and start on a byte of dst.
+   * @param block Transfer state (must stay valid until cb was called).
+   * @param slave Slave ID (1-247).
+   * @param table MB_TABLE_COILS or MB_TABLE_DISCRETE_INPUTS.
+   * @param address First address.
+   * @param count Number of bits.
+   * @param dst Destination for (count + 7) / 8 bytes, LSB first.
+   * @param cb Completion callback.
+   * @return uint16_t Error code (MB_EX_*) or 0 if started, cb is only called for started transfers.
+   */
+  uint16_t readBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, uint8_t* dst, const blockCallback& cb);
+
+  /**
+   * @brief Writes a holding register block of any size.
+   * @details The block is split into FC 0x10 transactions of at most 123 registers (or BlockTransfer::setChunkSize()).
+   * @param block Transfer state (must stay valid until cb was called).
+   * @param slave Slave ID (1-247).
+   * @param table MB_TABLE_HOLDING_REGISTERS.
+   * @param address First register address.
+   * @param count Number of registers.
+   * @param src Values of count registers (must stay valid until cb was called).
+   * @param cb Completion callback.
+   * @return uint16_t Error code (MB_EX_*) or 0 if started, cb is only called for started transfers.
+   */
+  uint16_t writeBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, const uint16_t* src, const blockCallback& cb);
+
+  /**
+   * @brief Writes a coil block of any size from a packed bit buffer.
+   * @details The block is split into FC 0x0F transactions of at most 1968 coils.
+   * @param block Transfer state (must stay valid until cb was called).
+   * @param slave Slave ID (1-247).
+   * @param table MB_TABLE_COILS.
+   * @param address First coil address.
+   * @param count Number of coils.
+   * @param src (count + 7) / 8 bytes, LSB first (must stay valid until cb was called).
+   * @param cb Completion callback.
+   * @return uint16_t Error code (MB_EX_*) or 0 if started, cb is only called for started transfers.
+   */
+  uint16_t writeBlock(BlockTransfer& block, uint8_t slave, uint8_t table, uint16_t address, uint16_t count, const uint8_t* src, const blockCallback& cb);
+
   /**
    * @brief Main loop for communication timing and response handling.
    * @note Must be overridden by derived classes.
@@ -97,6 +97,36 @@ void ModbusMaster::writeHoldingRegisters(uint8_t slave, uint16_t addr, const T*
   sendPDU(pdu, slave);
 }
 
+template <typename T>
+void ModbusMaster::writeHoldingRegistersByRef(const Slaves& slaves, uint16_t addr, const T* src, uint16_t srcCount, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createWriteHoldingRegister(addr, src, srcCount, cb, true)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename T>
+void ModbusMaster::writeHoldingRegistersByRef(uint8_t slave, uint16_t addr, const T* src, uint16_t srcCount, const modbusCallback& cb) {
+  if (slave == 0 && !isWriteFunction(MB_FC_WRITE_MULTIPLE_REGISTERS)) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createWriteHoldingRegister(addr, src, srcCount, cb, true)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slave);
+}
+
 template <typename T>
 void ModbusMaster::writeHoldingRegisters(const Slaves& slaves, uint16_t addr, std::initializer_list<T> list, const modbusCallback& cb) {
   PDU* pdu = getFreePDU(cb, slaves);
@@ -199,6 +229,82 @@ void ModbusMaster::readHoldingRegisters(uint8_t slave, uint16_t addr, uint8_t co
   sendPDU(pdu, slave);
 }
 
+template <typename T>
+void ModbusMaster::readHoldingRegisters(const Slaves& slaves, uint16_t addr, uint8_t count, T* dst, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<T>(MB_FC_READ_HOLDING_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename T>
+void ModbusMaster::readHoldingRegisters(uint8_t slave, uint16_t addr, uint8_t count, T* dst, const modbusCallback& cb) {
+  if (slave == 0) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<T>(MB_FC_READ_HOLDING_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  sendPDU(pdu, slave);
+}
+
+template <typename T>
+void ModbusMaster::readHoldingRegisters(const Slaves& slaves, uint16_t addr, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_HOLDING_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  if (table.getRegisters() > count) {
+    pdu->_err = MB_EX_LIB_INVALID_ARGUMENT;
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  bindScaling(pdu, table, out);
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename T>
+void ModbusMaster::readHoldingRegisters(uint8_t slave, uint16_t addr, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb) {
+  if (slave == 0) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_HOLDING_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  if (table.getRegisters() > count) {
+    pdu->_err = MB_EX_LIB_INVALID_ARGUMENT;
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  bindScaling(pdu, table, out);
+  sendPDU(pdu, slave);
+}
+
 template <typename T>
 void ModbusMaster::readInputRegister(const Slaves& slaves, uint16_t addr, const modbusCallback& cb) {
   PDU* pdu = getFreePDU(cb, slaves);
@@ -257,4 +363,182 @@ void ModbusMaster::readInputRegisters(uint8_t slave, uint16_t addr, uint8_t coun
     return;
   }
   sendPDU(pdu, slave);
+}
+
+template <typename T>
+void ModbusMaster::readInputRegisters(const Slaves& slaves, uint16_t addr, uint8_t count, T* dst, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<T>(MB_FC_READ_INPUT_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename T>
+void ModbusMaster::readInputRegisters(uint8_t slave, uint16_t addr, uint8_t count, T* dst, const modbusCallback& cb) {
+  if (slave == 0) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<T>(MB_FC_READ_INPUT_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  sendPDU(pdu, slave);
+}
+
+template <typename T>
+void ModbusMaster::readInputRegisters(const Slaves& slaves, uint16_t addr, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_INPUT_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  if (table.getRegisters() > count) {
+    pdu->_err = MB_EX_LIB_INVALID_ARGUMENT;
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  bindScaling(pdu, table, out);
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename T>
+void ModbusMaster::readInputRegisters(uint8_t slave, uint16_t addr, uint8_t count, const ScalingTable& table, T* out, const modbusCallback& cb) {
+  if (slave == 0) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_INPUT_REGISTERS, addr, count, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  if (table.getRegisters() > count) {
+    pdu->_err = MB_EX_LIB_INVALID_ARGUMENT;
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  bindScaling(pdu, table, out);
+  sendPDU(pdu, slave);
+}
+
+template <typename SCHEMA>
+void ModbusMaster::readRecord(const Slaves& slaves, uint16_t addr, typename SCHEMA::type* dst, const modbusCallback& cb) {
+  static_assert(SCHEMA::registers <= MB_MAX_READ_REGISTERS, "Record exceeds a read request");
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_HOLDING_REGISTERS, addr, SCHEMA::registers, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  pdu->_decoder = &SCHEMA::decodeInto;
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename SCHEMA>
+void ModbusMaster::readRecord(uint8_t slave, uint16_t addr, typename SCHEMA::type* dst, const modbusCallback& cb) {
+  static_assert(SCHEMA::registers <= MB_MAX_READ_REGISTERS, "Record exceeds a read request");
+  if (slave == 0) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_HOLDING_REGISTERS, addr, SCHEMA::registers, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  pdu->_decoder = &SCHEMA::decodeInto;
+  sendPDU(pdu, slave);
+}
+
+template <typename SCHEMA>
+void ModbusMaster::readInputRecord(const Slaves& slaves, uint16_t addr, typename SCHEMA::type* dst, const modbusCallback& cb) {
+  static_assert(SCHEMA::registers <= MB_MAX_READ_REGISTERS, "Record exceeds a read request");
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_INPUT_REGISTERS, addr, SCHEMA::registers, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  pdu->_decoder = &SCHEMA::decodeInto;
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename SCHEMA>
+void ModbusMaster::readInputRecord(uint8_t slave, uint16_t addr, typename SCHEMA::type* dst, const modbusCallback& cb) {
+  static_assert(SCHEMA::registers <= MB_MAX_READ_REGISTERS, "Record exceeds a read request");
+  if (slave == 0) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createReadRegisters<uint16_t>(MB_FC_READ_INPUT_REGISTERS, addr, SCHEMA::registers, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  pdu->_dst = reinterpret_cast<uint8_t*>(dst);
+  pdu->_decoder = &SCHEMA::decodeInto;
+  sendPDU(pdu, slave);
+}
+
+template <typename SCHEMA>
+void ModbusMaster::writeRecord(const Slaves& slaves, uint16_t addr, const typename SCHEMA::type* src, const modbusCallback& cb) {
+  PDU* pdu = getFreePDU(cb, slaves);
+  if (!pdu) return;
+  if (pdu->createWriteRecord<SCHEMA>(addr, src, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slaves.getActive());
+}
+
+template <typename SCHEMA>
+void ModbusMaster::writeRecord(uint8_t slave, uint16_t addr, const typename SCHEMA::type* src, const modbusCallback& cb) {
+  if (slave == 0 && !isWriteFunction(MB_FC_WRITE_MULTIPLE_REGISTERS)) {
+    PDU ret(slave);
+    ret._err = MB_EX_LIB_INVALID_SLAVE;
+    cb(ret);
+    return;
+  }
+  PDU* pdu = getFreePDU(cb, slave);
+  if (!pdu) return;
+  if (pdu->createWriteRecord<SCHEMA>(addr, src, cb)) {
+    cb(*pdu);
+    pdu->clear();
+    return;
+  }
+  sendPDU(pdu, slave);
 }
\ No newline at end of file
@@ -7,12 +7,15 @@
 ModbusRTUMaster::ModbusRTUMaster() {}
 
 ModbusRTUMaster::~ModbusRTUMaster() {
+  if (!_ownsStorage) return;
   if (_adu) {
     for (uint8_t i = 0; i < _queueSize; i++) {
       delete _adu[i];  // Free ADURTU objects
     }
     delete[] _adu;  // Free the array
   }
+  delete[] _rxFrame;
+  delete[] _sparePDU;
 }
 
 bool ModbusRTUMaster::sendPDU(PDU* pdu, uint8_t slave) {
@@ -20,6 +23,11 @@ bool ModbusRTUMaster::sendPDU(PDU* pdu, uint8_t slave) {
   adu->setHead(slave);
   adu->setCRC();
   adu->_responseLen = 0;
+  adu->_queuedTime = millis();
+  adu->_lazy = _lazyDecoding;
+  if (completeFromShadow(adu)) return true;  // Values already acknowledged
+  if (holdMaskWrite(adu)) return true;       // Emulated with a read-modify-write
+  if (_coalescer && _coalescer->deduplicate(adu, _currentADU, _queue)) return true;  // Served by an identical read
   if (!_queue.add(adu)) {
     adu->_err = MB_EX_LIB_QUEUE_FULL;
     adu->callCallback();
@@ -64,6 +72,14 @@ PDU* ModbusRTUMaster::getFreePDU(const modbusCallback& cb, uint8_t slave) {
   return nullptr;  // No free ADU
 }
 
+uint8_t ModbusRTUMaster::getFreePDUCount() const {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < _queueSize; ++i) {
+    if (!_adu[i]->_used) count++;
+  }
+  return count;
+}
+
 void ModbusRTUMaster::calcTimeout(uint8_t data, uint8_t parity, uint8_t stopBit) {
   _lastByteTime = 0;  // Reset last frame timestamp
   if (_baud <= 19200) {
@@ -87,7 +103,31 @@ void ModbusRTUMaster::begin(uint8_t PDUSize, uint8_t queueSize, Stream* stream,
   for (size_t i = 0; i < _queueSize; i++) {
     _adu[i] = new ADURTU();
     _adu[i]->init(PDUSize);
+  }
+  _rxFrame = new uint8_t[MB_ADU_RTU_HEADER_LEN + PDUSize + MB_ADU_RTU_CRC_LEN];
+  _sparePDU = new uint8_t[PDUSize];
+  setup(stream, baud, cfg, re, de);
+}
+
+void ModbusRTUMaster::begin(ADURTU* adus, ADURTU** aduPtrs, ADURTU** queueItems, uint8_t* frames, uint8_t* rxFrame, uint8_t* sparePDU,
+                            uint8_t PDUSize, uint8_t queueSize, Stream* stream, uint32_t baud, UartConfig cfg, int16_t re, int16_t de) {
+  _ownsStorage = false;
+  _queueSize = queueSize;
+  _queue.init(queueSize, queueItems);
+  _adu = aduPtrs;
+  for (size_t i = 0; i < _queueSize; i++) {
+    _adu[i] = &adus[i];
+    _adu[i]->init(PDUSize, frames + i * (MB_ADU_RTU_HEADER_LEN + PDUSize + MB_ADU_RTU_CRC_LEN));
+  }
+  _rxFrame = rxFrame;
+  _sparePDU = sparePDU;
+  setup(stream, baud, cfg, re, de);
+}
+
+void ModbusRTUMaster::setup(Stream* stream, uint32_t baud, UartConfig cfg, int16_t re, int16_t de) {
+  for (size_t i = 0; i < _queueSize; i++) {
     _adu[i]->_modbusRTUMaster = this;
+    _adu[i]->setReceiveFrame(_rxFrame, _sparePDU);
   }
   _stream = stream;
   _baud = baud;
@@ -129,6 +169,22 @@ void ModbusRTUMaster::send(uint8_t* buffer, uint16_t len) {
   _lastByteTime = micros();
 }
 
+void ModbusRTUMaster::send(ADURTU* adu) {
+  if (!adu->_payload) {
+    send(adu->_TXADURTUframe, adu->getTXADULen());
+    return;
+  }
+  const uint16_t headLen = MB_ADU_RTU_HEADER_LEN + MB_PDU_WRITE_HEADER_LEN;
+  uint16_t crc = crc16(adu->_TXADURTUframe, headLen);
+  beginTransaction();
+  _stream->write(adu->_TXADURTUframe, headLen);
+  adu->sendPayload(*_stream, &crc);
+  const uint8_t tail[MB_ADU_RTU_CRC_LEN] = {lowByte(crc), highByte(crc)};
+  _stream->write(tail, MB_ADU_RTU_CRC_LEN);
+  endTransaction();
+  _lastByteTime = micros();
+}
+
 uint32_t ModbusRTUMaster::getFrameTimeout() const { return _frameTimeout; }
 void ModbusRTUMaster::setFrameTimeout(uint32_t frameTimeout) { _frameTimeout = frameTimeout; }
 uint32_t ModbusRTUMaster::getByteTimeout() const { return _byteTimeout; }
@@ -141,6 +197,16 @@ void ModbusRTUMaster::reset() {
   _errorReceive = false;
 }
 
+void ModbusRTUMaster::complete(bool decode) {
+  ADURTU* adu = _currentADU;
+  reset();
+  if (decode) {
+    adu->invoke();
+  } else {
+    adu->callCallback();
+  }
+}
+
 void ModbusRTUMaster::loop() {
   switch (_state) {
     case MB_ASYNC_STATE_BUFFER_CLEAR: {
@@ -155,12 +221,12 @@ void ModbusRTUMaster::loop() {
     case MB_ASYNC_STATE_IDLE: {
       if (!_queue.isEmpty()) {
         if (on_us(&_lastByteTime, _frameTimeout, false)) {
-          if (_queue.readReady(_currentADU)) {
-            send(_currentADU->_TXADURTUframe, _currentADU->getTXADULen());
+          if (_coalescer ? _coalescer->readReady(_queue, _currentADU) : _queue.readReady(_currentADU)) {
+            if (_coalescer && _coalescer->coalesce(_currentADU, _queue)) _currentADU->setCRC();
+            send(_currentADU);
             // printBuffer(_currentADU->_TXADURTUframe, _currentADU->getTXADULen());
             if (_currentADU->getSlaveId() == 0) {
-              _currentADU->callCallback();
-              reset();
+              complete(false);
               return;
             }
             _state = MB_ASYNC_STATE_RECEIVE;
@@ -175,7 +241,7 @@ void ModbusRTUMaster::loop() {
     case MB_ASYNC_STATE_RECEIVE: {
       uint16_t received = _stream->available();
       if (received) {
-        _stream->readBytes(_currentADU->_RXADURTUframe + _currentADU->_responseLen, received);
+        _stream->readBytes(_rxFrame + _currentADU->_responseLen, received);
         _currentADU->_responseLen += received;
         // printBuffer(_currentADU->_RXADURTUframe, _currentADU->_responseLen);
         _lastByteTime = micros();
@@ -189,7 +255,7 @@ void ModbusRTUMaster::loop() {
             reset();
             return;
           }
-          if (_currentADU->_RXADURTUframe[1] == _currentADU->_responseRTUHead[1] + 0x80) _errorReceive = true;
+          if (_rxFrame[1] == _currentADU->_responseRTUHead[1] + 0x80) _errorReceive = true;
           _state = MB_ASYNC_STATE_HEADCHEKD;
         }
       } else {  // nothing received jet, chek timeout
@@ -200,8 +266,7 @@ void ModbusRTUMaster::loop() {
             _state = MB_ASYNC_STATE_IDLE;
           }
           _currentADU->_err = MB_EX_LIB_RESPONSE_TIMEOUT;
-          _currentADU->callCallback();
-          reset();
+          complete(false);
           return;
         }
       }
@@ -209,7 +274,7 @@ void ModbusRTUMaster::loop() {
     case MB_ASYNC_STATE_HEADCHEKD: {
       uint16_t received = _stream->available();
       if (received) {
-        _stream->readBytes(_currentADU->_RXADURTUframe + _currentADU->_responseLen, received);
+        _stream->readBytes(_rxFrame + _currentADU->_responseLen, received);
         _currentADU->_responseLen += received;
         // printBuffer(_currentADU->_RXADURTUframe, _currentADU->_responseLen);
         _lastByteTime = micros();
@@ -221,14 +286,12 @@ void ModbusRTUMaster::loop() {
           } else {
             _state = MB_ASYNC_STATE_IDLE;
           }
-          _currentADU->callCallback();
-          reset();
+          complete(false);
           return;
         }
         // printBuffer(_currentADU->_RXADURTUframe, _currentADU->_responseLen);
-        _currentADU->invoke();
         _state = MB_ASYNC_STATE_IDLE;
-        reset();
+        complete(true);
         return;
       } else {  // Chek byte timeout but only if nothing received jet
         if (_currentADU->_responseLen != 0 && on_us(&_lastByteTime, _byteTimeout, false)) {
@@ -238,8 +301,7 @@ void ModbusRTUMaster::loop() {
             _state = MB_ASYNC_STATE_IDLE;
           }
           _currentADU->_err = MB_EX_LIB_RESPONSE_TIMEOUT;
-          _currentADU->callCallback();
-          reset();
+          complete(false);
           return;
         }
       }
@@ -60,6 +60,9 @@ class ModbusRTUMaster : public ModbusMaster {
   ADUQueue<ADURTU> _queue;                                 ///< Queue for pending ADUs.
   uint8_t _state = MB_ASYNC_STATE_IDLE;                    ///< Current state machine state.
   bool _errorReceive = false;                              ///< Error response receive flag.
+  bool _ownsStorage = true;                                ///< ADUs and receive buffers were allocated by begin().
+  uint8_t* _rxFrame = nullptr;                             ///< Receive frame shared by all ADUs (PDU size + 3 bytes).
+  uint8_t* _sparePDU = nullptr;                            ///< Spare PDU buffer for serving merged requests (PDU size bytes).
 
   /**
    * @brief Resets the RTU master state.
@@ -67,6 +70,13 @@ class ModbusRTUMaster : public ModbusMaster {
    */
   void reset();
 
+  /**
+   * @brief Completes the current ADU after resetting the state.
+   * @details Callbacks may queue identical reads, they must not be attached to the finished ADU.
+   * @param decode Decode the response (invoke()) instead of reporting the error already set.
+   */
+  void complete(bool decode);
+
   /**
    * @brief Calculates byte and frame timeouts based on UART configuration.
    * @param data Number of data bits.
@@ -82,6 +92,13 @@ class ModbusRTUMaster : public ModbusMaster {
    */
   void send(uint8_t* buffer, uint16_t len);
 
+  /**
+   * @brief Sends a request ADU over the serial stream.
+   * @details A referenced write payload is serialized behind the header and the CRC computed on the way.
+   * @param adu Request to send.
+   */
+  void send(ADURTU* adu);
+
   /**
    * @brief Initiates RS-485 transmission.
    * @details Sets DE/RE pins for transmission.
@@ -124,6 +141,36 @@ class ModbusRTUMaster : public ModbusMaster {
    */
   bool sendPDU(PDU* pdu, uint8_t slave) override;
 
+ protected:
+  /**
+   * @brief Initializes the RTU master on caller-provided storage (see ModbusRTUMasterStatic).
+   * @param adus queueSize ADUs.
+   * @param aduPtrs queueSize pointers for the ADU array.
+   * @param queueItems queueSize pointers for the queue.
+   * @param frames queueSize * (PDUSize + 3) bytes of TX frames.
+   * @param rxFrame Shared receive frame, PDUSize + 3 bytes.
+   * @param sparePDU Spare PDU buffer, PDUSize bytes.
+   * @param PDUSize PDU buffer size (16-253 bytes).
+   * @param queueSize ADU queue capacity.
+   * @param stream Pointer to the serial stream.
+   * @param baud Baud rate.
+   * @param cfg UART configuration.
+   * @param re RS-485 RE pin (-1 if not used).
+   * @param de RS-485 DE pin (-1 if not used).
+   */
+  void begin(ADURTU* adus, ADURTU** aduPtrs, ADURTU** queueItems, uint8_t* frames, uint8_t* rxFrame, uint8_t* sparePDU, uint8_t PDUSize,
+             uint8_t queueSize, Stream* stream, uint32_t baud, UartConfig cfg, int16_t re, int16_t de);
+
+  /**
+   * @brief Configures the serial line and links the ADUs to the master and its receive buffers.
+   * @param stream Pointer to the serial stream.
+   * @param baud Baud rate.
+   * @param cfg UART configuration.
+   * @param re RS-485 RE pin (-1 if not used).
+   * @param de RS-485 DE pin (-1 if not used).
+   */
+  void setup(Stream* stream, uint32_t baud, UartConfig cfg, int16_t re, int16_t de);
+
  public:
   /**
    * @brief Default constructor.
@@ -186,6 +233,12 @@ class ModbusRTUMaster : public ModbusMaster {
    */
   void setResponseTimeout(uint32_t t);
 
+  /**
+   * @brief Returns the number of ADUs currently available for new requests.
+   * @return uint8_t Number of free ADUs.
+   */
+  uint8_t getFreePDUCount() const override;
+
   /**
    * @brief Main loop for communication timing and response handling.
    * @details Processes queued ADUs and handles responses.
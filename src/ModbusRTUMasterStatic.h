@@ -0,0 +1,46 @@
+/**
+ * @file ModbusRTUMasterStatic.h
+ * @brief Modbus RTU master with compile-time sized, statically allocated storage.
+ * @details Same API as ModbusRTUMaster, but ADUs, frames and the queue are members sized by template arguments,
+ *          so RAM use is accounted at link time and begin() does not use the heap.
+ */
+
+#pragma once
+#include "ADURTU.h"
+#include "ModbusRTUMaster.h"
+
+/**
+ * @class ModbusRTUMasterStatic
+ * @brief ModbusRTUMaster whose storage is fully static.
+ * @details Declare it as a global object to place the storage in .bss.
+ * @tparam PDU_SIZE PDU buffer size (16-253 bytes).
+ * @tparam QUEUE_SIZE ADU queue capacity.
+ */
+template <uint8_t PDU_SIZE, uint8_t QUEUE_SIZE>
+class ModbusRTUMasterStatic : public ModbusRTUMaster {
+  static_assert(PDU_SIZE >= 16 && PDU_SIZE <= 253, "PDU size must be 16-253 bytes");
+  static_assert(QUEUE_SIZE > 0, "Queue size must be at least 1");
+
+ private:
+  static constexpr uint16_t frameLen = MB_ADU_RTU_HEADER_LEN + PDU_SIZE + MB_ADU_RTU_CRC_LEN;  ///< Length of one frame.
+
+  ADURTU _aduStore[QUEUE_SIZE];                ///< ADUs.
+  ADURTU* _aduPtrs[QUEUE_SIZE];                ///< ADU array of the master.
+  ADURTU* _queueItems[QUEUE_SIZE];             ///< Queue storage.
+  uint8_t _frames[QUEUE_SIZE * frameLen];      ///< TX frame of every ADU.
+  uint8_t _rxFrame[frameLen];                  ///< Receive frame shared by the ADUs.
+  uint8_t _sparePDU[PDU_SIZE];                 ///< Spare PDU buffer for merged requests.
+
+ public:
+  /**
+   * @brief Initializes the RTU master on its static storage.
+   * @param stream Pointer to the serial stream.
+   * @param baud Baud rate (default: 115200).
+   * @param cfg UART configuration (default: Mode_8N1).
+   * @param re RS-485 RE pin (-1 if not used).
+   * @param de RS-485 DE pin (-1 if not used).
+   */
+  void begin(Stream* stream, uint32_t baud = 115200, UartConfig cfg = UartConfig::Mode_8N1, int16_t re = -1, int16_t de = -1) {
+    ModbusRTUMaster::begin(_aduStore, _aduPtrs, _queueItems, _frames, _rxFrame, _sparePDU, PDU_SIZE, QUEUE_SIZE, stream, baud, cfg, re, de);
+  }
+};
@@ -6,6 +6,7 @@
 ModbusTCPClient::ModbusTCPClient() {}
 
 ModbusTCPClient::~ModbusTCPClient() {
+  if (!_ownsStorage) return;
   if (_adu) {
     for (uint8_t i = 0; i < _ADUPoolSize; i++) {
       delete _adu[i];  // Free ADUTCP objects
@@ -22,13 +23,49 @@ void ModbusTCPClient::begin(uint8_t ADUPoolSize, uint8_t PDUSize, uint8_t client
   for (size_t i = 0; i < _ADUPoolSize; i++) {
     _adu[i] = new ADUTCP();
     _adu[i]->init(PDUSize);
-    _adu[i]->_modbusTCPClient = this;
   }
   _clients = new ClientItem[_clientCount];
+  setup();
+}
+
+void ModbusTCPClient::begin(ADUTCP* adus, ADUTCP** aduPtrs, uint8_t* frames, ClientItem* clients, ADUTCP** clientSlots, uint8_t ADUPoolSize,
+                            uint8_t PDUSize, uint8_t clientCount, uint8_t clientQueueSize) {
+  _ownsStorage = false;
+  _ADUPoolSize = ADUPoolSize;
+  _clientCount = clientCount;
+  _adu = aduPtrs;
+  for (size_t i = 0; i < _ADUPoolSize; i++) {
+    _adu[i] = &adus[i];
+    _adu[i]->init(PDUSize, frames + i * 2 * (MB_ADU_MBAP_LEN + PDUSize));
+  }
+  _clients = clients;
+  _clientSlots = clientSlots;
+  _clientQueueSize = clientQueueSize;
+  setup();
+}
+
+ADUTCP** ModbusTCPClient::clientSlotsOf(uint8_t ix) const {
+  return _clientSlots ? _clientSlots + ix * 2 * _clientQueueSize : nullptr;
+}
+
+void ModbusTCPClient::setup() {
+  for (size_t i = 0; i < _ADUPoolSize; i++) {
+    _adu[i]->_modbusTCPClient = this;
+  }
+  for (size_t i = 0; i < _clientCount; i++) {
+    _clients[i]._coalescer = _coalescer;
+  }
   _responseTimeout = MB_RESPONSE_TIMEOUT;
   setIsBigEndian();
 }
 
+void ModbusTCPClient::setCoalescer(RequestCoalescer* coalescer) {
+  ModbusMaster::setCoalescer(coalescer);
+  for (uint8_t i = 0; i < _clientCount; i++) {
+    _clients[i]._coalescer = coalescer;
+  }
+}
+
 bool ModbusTCPClient::addClient(uint8_t id, bool allAtOnce, uint8_t queueSize, Client* client, IPAddress ip, uint16_t port, bool keepAlive) {
   // Check for unique slave ID
   for (uint8_t i = 0; i < _clientCount; ++i) {
@@ -36,10 +73,24 @@ bool ModbusTCPClient::addClient(uint8_t id, bool allAtOnce, uint8_t queueSize, C
       return false;  // ID already exists
     }
   }
+  if (_clientSlots && queueSize > _clientQueueSize) return false;
   // Find free slot
   for (uint8_t i = 0; i < _clientCount; ++i) {
     if (!_clients[i].isValid()) {
-      _clients[i].set(id, allAtOnce, queueSize, client, ip, port, keepAlive);
+      _clients[i].set(id, allAtOnce, queueSize, client, ip, port, keepAlive, clientSlotsOf(i));
+      return true;
+    }
+  }
+  return false;  // No free slot
+}
+
+bool ModbusTCPClient::addPooledClient(uint8_t id, uint8_t window, uint8_t queueSize, Client* client, IPAddress ip, uint16_t port, bool keepAlive) {
+  if (id == 0) return false;
+  if (_clientSlots && queueSize > _clientQueueSize) return false;
+  for (uint8_t i = 0; i < _clientCount; ++i) {
+    if (!_clients[i].isValid()) {
+      _clients[i].set(id, true, queueSize, client, ip, port, keepAlive, clientSlotsOf(i));
+      _clients[i].setWindow(window ? window : 1);
       return true;
     }
   }
@@ -49,19 +100,35 @@ bool ModbusTCPClient::addClient(uint8_t id, bool allAtOnce, uint8_t queueSize, C
 bool ModbusTCPClient::sendPDU(PDU* pdu, uint8_t slave) {
   ADUTCP* adu = static_cast<ADUTCP*>(pdu);
   adu->setMBAP(slave);
+  adu->_lazy = _lazyDecoding;
+  if (completeFromShadow(adu)) return true;  // Values already acknowledged
+  if (holdMaskWrite(adu)) return true;       // Emulated with a read-modify-write
+  for (size_t i = 0; i < _clientCount; i++) {  // Served by an identical read
+    if (_clients[i]._id == slave && _clients[i].deduplicate(adu)) return true;
+  }
+  // Pick the least loaded connection of the slave, connected ones first
+  ClientItem* best = nullptr;
+  bool found = false;
   for (size_t i = 0; i < _clientCount; i++) {
-    if (_clients[i]._id == slave) {
-      if (!_clients[i]._queue.add(adu)) {
-        adu->_err = MB_EX_LIB_QUEUE_FULL;
-        adu->callCallback();
-        return false;
-      }
-      return true;
+    ClientItem& item = _clients[i];
+    if (item._id != slave) continue;
+    found = true;
+    if (item._queue.count() >= item._maxCount) continue;
+    if (best) {
+      const bool conn = item._client->connected();
+      const bool bestConn = best->_client->connected();
+      if (conn != bestConn ? !conn : item.load() >= best->load()) continue;
     }
+    best = &item;
+  }
+  if (!best) {
+    adu->_err = found ? MB_EX_LIB_QUEUE_FULL : MB_EX_LIB_TCP_NO_CLIENT_AVAILABLE_FOR_THE_SLAVE;
+    adu->callCallback();
+    return false;
   }
-  adu->_err = MB_EX_LIB_TCP_NO_CLIENT_AVAILABLE_FOR_THE_SLAVE;
-  adu->callCallback();
-  return false;
+  adu->_queuedTime = millis();
+  best->_queue.add(adu);
+  return true;
 }
 
 PDU* ModbusTCPClient::getFreePDU(const modbusCallback& cb, const Slaves& slaves) {
@@ -97,6 +164,14 @@ PDU* ModbusTCPClient::getFreePDU(const modbusCallback& cb, uint8_t slave) {
   return nullptr;  // No free ADU
 }
 
+uint8_t ModbusTCPClient::getFreePDUCount() const {
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < _ADUPoolSize; ++i) {
+    if (!_adu[i]->_used) count++;
+  }
+  return count;
+}
+
 void ModbusTCPClient::loop() {
   for (uint8_t i = 0; i < _clientCount; ++i) {
     if (_clients[i].isValid()) {
@@ -26,6 +26,9 @@ class ModbusTCPClient : public ModbusMaster {
   ClientItem* _clients = nullptr;                   ///< Array of client items (slaves).
   uint8_t _clientCount = 0;                         ///< Number of client slots.
   uint32_t _responseTimeout = MB_RESPONSE_TIMEOUT;  ///< Response timeout (ms).
+  ADUTCP** _clientSlots = nullptr;                  ///< Queue storage of the client slots, nullptr if allocated per client.
+  uint8_t _clientQueueSize = 0;                     ///< Max queue size per client with _clientSlots.
+  bool _ownsStorage = true;                         ///< ADUs and clients were allocated by begin().
 
   /**
    * @brief Retrieves a free PDU instance for the operation.
@@ -51,6 +54,34 @@ class ModbusTCPClient : public ModbusMaster {
    */
   bool sendPDU(PDU* pdu, uint8_t slave) override;
 
+ protected:
+  /**
+   * @brief Initializes the TCP client on caller-provided storage (see ModbusTCPClientStatic).
+   * @param adus ADUPoolSize ADUs.
+   * @param aduPtrs ADUPoolSize pointers.
+   * @param frames ADUPoolSize * 2 * (PDUSize + 7) bytes of frames.
+   * @param clients clientCount client items.
+   * @param clientSlots clientCount * 2 * clientQueueSize pointers for the client queues.
+   * @param ADUPoolSize Size of the ADU pool.
+   * @param PDUSize PDU buffer size (16-253 bytes).
+   * @param clientCount Maximum number of slaves.
+   * @param clientQueueSize Maximum queue size per client.
+   */
+  void begin(ADUTCP* adus, ADUTCP** aduPtrs, uint8_t* frames, ClientItem* clients, ADUTCP** clientSlots, uint8_t ADUPoolSize,
+             uint8_t PDUSize, uint8_t clientCount, uint8_t clientQueueSize);
+
+  /**
+   * @brief Links the ADUs and clients to the client and sets the defaults.
+   */
+  void setup();
+
+  /**
+   * @brief Returns the queue storage of a client slot.
+   * @param ix Client slot.
+   * @return ADUTCP** Storage of 2 * clientQueueSize pointers, nullptr if the queues are allocated.
+   */
+  ADUTCP** clientSlotsOf(uint8_t ix) const;
+
  public:
   /**
    * @brief Default constructor.
@@ -81,11 +112,42 @@ class ModbusTCPClient : public ModbusMaster {
    * @param ip Slave IP address.
    * @param port TCP port (default: 502).
    * @param keepAlive Reconnect if connection lost.
-   * @return bool True if added, false if no free slot or ID is not unique.
+   * @return bool True if added, false if no free slot, ID is not unique or queueSize exceeds the static queue size.
    */
   bool addClient(uint8_t id, bool allAtOnce, uint8_t queueSize, Client* client, IPAddress ip,
                  uint16_t port = 502, bool keepAlive = true);
 
+  /**
+   * @brief Adds one more pipelined connection to a slave.
+   * @details Several connections with the same ID form a pool, each request goes to the least loaded one.
+   *          Lets more requests be in flight than a device with a small connection limit would allow on one socket.
+   *          Requests are only ordered per connection: a request may overtake an earlier one of the same slave
+   *          sent on another connection, e.g. a read may return the values from before a write issued first.
+   *          Issue dependent requests from the callback of the earlier one, or use addClient() for strict order.
+   * @param id Slave ID (1-247).
+   * @param window Max requests awaiting response on this connection (1 = no pipelining).
+   * @param queueSize ADU queue capacity of this connection.
+   * @param client Pointer to the TCP client instance.
+   * @param ip Slave IP address.
+   * @param port TCP port (default: 502).
+   * @param keepAlive Reconnect if connection lost.
+   * @return bool True if added, false if no free slot or queueSize exceeds the static queue size.
+   */
+  bool addPooledClient(uint8_t id, uint8_t window, uint8_t queueSize, Client* client, IPAddress ip,
+                       uint16_t port = 502, bool keepAlive = true);
+
+  /**
+   * @brief Merges, deduplicates or fuses queued requests of every connection before they are sent.
+   * @param coalescer Coalescer, nullptr to disable (default).
+   */
+  void setCoalescer(RequestCoalescer* coalescer) override;
+
+  /**
+   * @brief Returns the number of ADUs currently available for new requests.
+   * @return uint8_t Number of free ADUs.
+   */
+  uint8_t getFreePDUCount() const override;
+
   /**
    * @brief Main loop for communication.
    * @details Delegates to ClientItem loop for processing.
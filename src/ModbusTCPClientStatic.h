@@ -0,0 +1,45 @@
+/**
+ * @file ModbusTCPClientStatic.h
+ * @brief Modbus TCP client with compile-time sized, statically allocated storage.
+ * @details Same API as ModbusTCPClient, but ADUs, frames, client slots and their queues are members sized by
+ *          template arguments, so RAM use is accounted at link time and begin() / addClient() do not use the heap.
+ */
+
+#pragma once
+#include "ADUTCP.h"
+#include "ClientItem.h"
+#include "ModbusTCPClient.h"
+
+/**
+ * @class ModbusTCPClientStatic
+ * @brief ModbusTCPClient whose storage is fully static.
+ * @details Declare it as a global object to place the storage in .bss. addClient() and addPooledClient() return
+ *          false for a queue size above CLIENT_QUEUE_SIZE.
+ * @tparam ADU_POOL_SIZE Size of the ADU pool.
+ * @tparam PDU_SIZE PDU buffer size (16-253 bytes).
+ * @tparam CLIENT_COUNT Maximum number of client slots.
+ * @tparam CLIENT_QUEUE_SIZE Maximum ADU queue capacity per client.
+ */
+template <uint8_t ADU_POOL_SIZE, uint8_t PDU_SIZE, uint8_t CLIENT_COUNT, uint8_t CLIENT_QUEUE_SIZE>
+class ModbusTCPClientStatic : public ModbusTCPClient {
+  static_assert(PDU_SIZE >= 16 && PDU_SIZE <= 253, "PDU size must be 16-253 bytes");
+  static_assert(ADU_POOL_SIZE > 0 && CLIENT_COUNT > 0 && CLIENT_QUEUE_SIZE > 0, "Sizes must be at least 1");
+
+ private:
+  static constexpr uint16_t frameLen = MB_ADU_MBAP_LEN + PDU_SIZE;  ///< Length of one frame.
+
+  ADUTCP _aduStore[ADU_POOL_SIZE];                                ///< ADUs.
+  ADUTCP* _aduPtrs[ADU_POOL_SIZE];                                ///< ADU array of the client.
+  uint8_t _frames[ADU_POOL_SIZE * 2 * frameLen];                  ///< TX and RX frame of every ADU.
+  ClientItem _clientStore[CLIENT_COUNT];                          ///< Client slots.
+  ADUTCP* _clientSlotStore[CLIENT_COUNT * 2 * CLIENT_QUEUE_SIZE];  ///< Sent buffer and queue of every client slot.
+
+ public:
+  /**
+   * @brief Initializes the TCP client on its static storage.
+   */
+  void begin() {
+    ModbusTCPClient::begin(_aduStore, _aduPtrs, _frames, _clientStore, _clientSlotStore, ADU_POOL_SIZE, PDU_SIZE, CLIENT_COUNT,
+                           CLIENT_QUEUE_SIZE);
+  }
+};
@@ -1,14 +1,25 @@
 #include "ModbusUtility.h"
 
-bool isBigEndian;
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+#if defined(__BMI2__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#ifdef __AVR__
+// Bools of a nibble, first bit in the lowest byte
+static const uint32_t nibbleBools[16] PROGMEM = {
+    0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+    0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101};
+#endif
+
+bool isBigEndian = hostIsBigEndian;
 
 bool setIsBigEndian() {
-  union {
-    uint16_t value;
-    uint8_t bytes[2];
-  } test{0x1234};
-  static_assert(sizeof(uint16_t) == 2, "uint16_t must be 2 bytes");
-  isBigEndian = test.bytes[0] == 0x12;
+  isBigEndian = hostIsBigEndian;
   return isBigEndian;
 }
 
@@ -16,6 +27,83 @@ void setIsBigEndian(bool value) {
   isBigEndian = value;
 }
 
+void swapRegisters(uint8_t* dst, const uint8_t* src, uint16_t count) {
+  uint16_t i = 0;
+#if defined(__SSSE3__)
+  const __m128i shuffle = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  for (; i + 8 <= count; i += 8) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_shuffle_epi8(v, shuffle));
+  }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (; i + 8 <= count; i += 8) {
+    vst1q_u8(dst + i * 2, vrev16q_u8(vld1q_u8(src + i * 2)));
+  }
+#elif UINTPTR_MAX > 0xFFFF
+  // Two registers per 32-bit word, memcpy keeps unaligned buffers safe and compiles to single loads and stores
+  for (; i + 2 <= count; i += 2) {
+    uint32_t w;
+    memcpy(&w, src + i * 2, 4);
+    w = ((w & 0x00FF00FFUL) << 8) | ((w >> 8) & 0x00FF00FFUL);
+    memcpy(dst + i * 2, &w, 4);
+  }
+#endif
+  for (; i < count; i++) {
+    const uint8_t hi = src[i * 2];
+    dst[i * 2] = src[i * 2 + 1];
+    dst[i * 2 + 1] = hi;
+  }
+}
+
+void packBits(uint8_t* dst, const bool* src, uint16_t count) {
+  uint16_t i = 0;
+#if !MB_HOST_BIG_ENDIAN && UINTPTR_MAX > 0xFFFF
+  // Eight bools (0 or 1) per 64-bit word, byte k becomes bit k
+  for (; i + 8 <= count; i += 8) {
+    uint64_t w;
+    memcpy(&w, src + i, 8);
+#if defined(__BMI2__) && defined(__x86_64__)
+    dst[i >> 3] = _pext_u64(w, 0x0101010101010101ULL);
+#else
+    dst[i >> 3] = (w * 0x0102040810204080ULL) >> 56;
+#endif
+  }
+#endif
+  for (; i < count; i += 8) {
+    uint8_t b = 0;
+    uint8_t mask = 1;
+    const uint16_t n = count - i < 8 ? count - i : 8;
+    for (uint8_t j = 0; j < n; j++, mask <<= 1) {
+      if (src[i + j]) b |= mask;
+    }
+    dst[i >> 3] = b;
+  }
+}
+
+void unpackBits(bool* dst, const uint8_t* src, uint16_t count) {
+  uint16_t i = 0;
+#if !MB_HOST_BIG_ENDIAN && UINTPTR_MAX > 0xFFFF
+  // Bit k of a byte becomes byte k of a 64-bit word
+  for (; i + 8 <= count; i += 8) {
+#if defined(__BMI2__) && defined(__x86_64__)
+    const uint64_t w = _pdep_u64(src[i >> 3], 0x0101010101010101ULL);
+#else
+    const uint64_t w = ((((src[i >> 3] * 0x0101010101010101ULL) & 0x8040201008040201ULL) + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+#endif
+    memcpy(dst + i, &w, 8);
+  }
+#elif defined(__AVR__)
+  for (; i + 8 <= count; i += 8) {
+    const uint8_t b = src[i >> 3];
+    const uint32_t lo = pgm_read_dword(&nibbleBools[b & 0x0F]);
+    const uint32_t hi = pgm_read_dword(&nibbleBools[b >> 4]);
+    memcpy(dst + i, &lo, 4);
+    memcpy(dst + i + 4, &hi, 4);
+  }
+#endif
+  for (; i < count; i++) dst[i] = (src[i >> 3] >> (i & 7)) & 0x01;
+}
+
 void printBuffer(uint8_t* buffer, uint16_t len) {
   for (size_t i = 0; i < len; i++) {
     Serial.print(buffer[i], HEX);
@@ -5,17 +5,37 @@
  */
 
 #pragma once
+#include <string.h>
 #include <utils.h>
 
 /**
- * @brief Detects platform endianness at runtime.
+ * @def MB_HOST_BIG_ENDIAN
+ * @brief Byte order of the target, fixed at compile time (1 = big-endian).
+ * @details Taken from the compiler, every supported MCU (AVR, ARM Cortex-M, ESP32) is little-endian.
+ */
+#ifndef MB_HOST_BIG_ENDIAN
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define MB_HOST_BIG_ENDIAN 1
+#else
+#define MB_HOST_BIG_ENDIAN 0
+#endif
+#endif
+
+/**
+ * @var hostIsBigEndian
+ * @brief Compile-time byte order of the target, used by the register codecs.
+ */
+constexpr bool hostIsBigEndian = MB_HOST_BIG_ENDIAN;
+
+/**
+ * @brief Sets isBigEndian to the platform endianness.
  * @return bool True if big-endian, false if little-endian.
  */
 extern bool setIsBigEndian();
 
 /**
- * @brief Overrides platform endianness manually.
- * @details Use cautiously, primarily for testing purposes.
+ * @brief Overrides the isBigEndian flag manually.
+ * @details Kept for compatibility, the register codecs use hostIsBigEndian.
  * @param value True for big-endian, false for little-endian.
  */
 extern void setIsBigEndian(bool value);
@@ -23,10 +43,86 @@ extern void setIsBigEndian(bool value);
 /**
  * @var isBigEndian
  * @brief Global flag indicating platform endianness.
- * @details Set by setIsBigEndian().
+ * @details Set by setIsBigEndian(), equals hostIsBigEndian unless overridden.
  */
 extern bool isBigEndian;
 
+/**
+ * @brief Swaps the two bytes of every 16-bit register of a buffer.
+ * @details Uses SSSE3 or NEON shuffles on hosts that support them, 32-bit word operations on 32-bit MCUs and a
+ *          byte loop on 8-bit MCUs. The buffers may be the same, but must not overlap otherwise.
+ * @param dst Destination buffer.
+ * @param src Source buffer.
+ * @param count Number of registers.
+ */
+extern void swapRegisters(uint8_t* dst, const uint8_t* src, uint16_t count);
+
+/**
+ * @brief Packs a bool array into coil bytes (LSB first), the unused bits of the last byte are cleared.
+ * @details Packs eight bools per step with BMI2 PEXT or a 64-bit multiply on 32-bit and larger targets, and with a
+ *          shifting mask on 8-bit MCUs.
+ * @param dst Destination, (count + 7) / 8 bytes.
+ * @param src Source bools.
+ * @param count Number of bits.
+ */
+extern void packBits(uint8_t* dst, const bool* src, uint16_t count);
+
+/**
+ * @brief Unpacks coil bytes (LSB first) into a bool array.
+ * @details Spreads a byte into eight bools per step with BMI2 PDEP or a 64-bit multiply on 32-bit and larger
+ *          targets, and with a nibble table in PROGMEM on AVR.
+ * @param dst Destination bools.
+ * @param src Source bytes.
+ * @param count Number of bits.
+ */
+extern void unpackBits(bool* dst, const uint8_t* src, uint16_t count);
+
+/**
+ * @struct RegisterCodec
+ * @brief Converts whole registers between host order and the big-endian wire format.
+ * @tparam BIG_ENDIAN_HOST Byte order of the target, selected with hostIsBigEndian.
+ */
+template <bool BIG_ENDIAN_HOST>
+struct RegisterCodec;
+
+/**
+ * @struct RegisterCodec
+ * @brief Little-endian target: every register is byte-swapped.
+ */
+template <>
+struct RegisterCodec<false> {
+  /**
+   * @brief Converts registers from host order to wire format (or back, the operation is symmetric).
+   * @param dst Destination buffer (may be src).
+   * @param src Source buffer.
+   * @param count Number of registers.
+   */
+  static void convert(uint8_t* dst, const uint8_t* src, uint16_t count) { swapRegisters(dst, src, count); }
+};
+
+/**
+ * @struct RegisterCodec
+ * @brief Big-endian target: registers are already in wire format.
+ */
+template <>
+struct RegisterCodec<true> {
+  /**
+   * @brief Copies registers, host order equals wire format.
+   * @param dst Destination buffer (may be src).
+   * @param src Source buffer.
+   * @param count Number of registers.
+   */
+  static void convert(uint8_t* dst, const uint8_t* src, uint16_t count) {
+    if (dst != src) memmove(dst, src, count * 2);
+  }
+};
+
+/**
+ * @typedef HostRegisterCodec
+ * @brief Register codec of the target.
+ */
+using HostRegisterCodec = RegisterCodec<hostIsBigEndian>;
+
 /**
  * @brief Prints a buffer to the serial output.
  * @param buffer Pointer to the byte buffer.
@@ -1,7 +1,10 @@
 #include "PDU.h"
 
+#include "Crc16.h"
 #include "ModbusDef.h"
 #include "ModbusUtility.h"
+#include "ScalingTable.h"
+#include "WriteShadow.h"
 
 PDU::PDU() : _PDUSize(0) {}
 
@@ -9,18 +12,81 @@ PDU::PDU(uint8_t slave) { _slave = slave; }
 
 PDU::~PDU() {}
 
+void PDU::sendPayload(Print& out, uint16_t* crc) const {
+  const uint8_t* src = static_cast<const uint8_t*>(_payload);
+  if (!_payloadBits && _payloadSize == 0) {  // Packed coil bytes go out as they are
+    out.write(src, _payloadCount);
+    if (crc) *crc = crc16Update(*crc, src, _payloadCount);
+    return;
+  }
+  uint8_t chunk[MB_PAYLOAD_CHUNK];
+  uint16_t done = 0;
+  while (done < _payloadCount) {
+    uint16_t n, len;
+    if (_payloadBits) {
+      n = _payloadCount - done < MB_PAYLOAD_CHUNK * 8 ? _payloadCount - done : MB_PAYLOAD_CHUNK * 8;
+      len = (n + 7) / 8;
+      packBits(chunk, reinterpret_cast<const bool*>(_payload) + done, n);
+    } else {
+      const uint8_t paddedSize = _payloadSize + (_payloadSize & 1);
+      n = _payloadCount - done < MB_PAYLOAD_CHUNK / paddedSize ? _payloadCount - done : MB_PAYLOAD_CHUNK / paddedSize;
+      len = n * paddedSize;
+      convertToBigEndianRegisters(src + done * _payloadSize, n, _payloadSize, chunk, sizeof(chunk), _payloadOrder);
+    }
+    out.write(chunk, len);
+    if (crc) *crc = crc16Update(*crc, chunk, len);
+    done += n;
+  }
+}
+
 void PDU::callCallback() {
+  if (_fusedFn) unfuse();  // The write reports itself, not the FC 0x17 request
+  if (_shadow) {  // Before a merged request is restored, the leader reports the whole write
+    for (PDU* pdu = _merged; pdu; pdu = pdu->_merged) {  // Carrying the values of the newest write merged into it
+      if (pdu->_shadowSeq > _shadowSeq) _shadowSeq = pdu->_shadowSeq;
+    }
+    _shadow->acknowledge(this);
+    _shadow = nullptr;
+  }
+  PDU* chain = _merged;  // Set if the merged transaction failed before a response was decoded
+  if (chain) {
+    _merged = nullptr;
+    restoreRequest();
+  }
+  PDU* fused = _fused;  // Set if the FC 0x17 transaction failed
+  _fused = nullptr;
+  const uint16_t err = _err;
+  _completing = true;
   if (_callback.valid()) {
     _callback(*this);
     if (!repeatIfNeeded()) {
       clear();
+    } else {
+      _completing = false;
     }
   }
+  while (chain) {
+    PDU* next = chain->_merged;
+    chain->_merged = nullptr;
+    chain->_err = err;
+    chain->_shadow = nullptr;  // Reported by the leader
+    chain->callCallback();
+    chain = next;
+  }
+  if (fused) {
+    fused->_err = err;
+    fused->callCallback();
+  }
 }
 
 bool PDU::repeatIfNeeded() { return false; }
 
+bool PDU::isRepeating() const { return false; }
+
 uint16_t PDU::invoke() {
+  if (_raw) return invokeRaw();
+  if (_fused) return invokeFused();
+  if (_merged && _TXPDUbuffer[0] <= MB_FC_READ_INPUT_REGISTERS) return invokeMerged();  // Merged writes fan out in callCallback()
   if (_err != 0) {
     _dataBegin = 0;
     _dataLen = 0;
@@ -61,7 +127,24 @@ uint16_t PDU::invoke() {
       // Perform endian conversion for register-based responses
       if (_elemSize > 0 && (_dataLen % 2 == 0)) {
         const uint8_t elemCount = _dataLen / _elemSize;
-        convertFromBigEndianRegistersInPlace(_RXPDUbuffer + _dataBegin, elemCount, _elemSize);
+        if (_elemSize % 2 == 0 && (_lazy || _dst || _scaling)) {  // Decoded into the bound destination, converted on access
+          _encoded = true;
+          if (_scaling) {
+            if (_scaledDouble) {
+              _scaling->apply(*this, static_cast<double*>(_scaled));
+            } else {
+              _scaling->apply(*this, static_cast<float*>(_scaled));
+            }
+          }
+          if (_decoder) {
+            _decoder(_dst, _RXPDUbuffer + _dataBegin);
+          } else if (_dst) {
+            decodeRegisters(_dst, _RXPDUbuffer + _dataBegin, elemCount, _elemSize, _order);
+          }
+        } else {
+          convertFromBigEndianRegistersInPlace(_RXPDUbuffer + _dataBegin, elemCount, _elemSize);
+          if (_dst) memcpy(_dst, _RXPDUbuffer + _dataBegin, _dataLen);
+        }
       }
       callCallback();
       return _err;
@@ -140,6 +223,232 @@ uint16_t PDU::invoke() {
   return _err;
 }
 
+uint16_t PDU::invokeRaw() {
+  _dataBegin = 0;
+  _dataLen = 0;
+  if (_err != 0) {
+    callCallback();
+    return _err;
+  }
+  if (_RXPDUbuffer[0] == _PDUresponseHead[0] + 0x80) {
+    _err = _RXPDUbuffer[1];
+    _dataLen = MB_PDU_ERR_LEN;  // Forward the exception PDU as is
+  } else if (_RXPDUbuffer[0] != _PDUresponseHead[0]) {
+    _err = MB_EX_LIB_INVALID_FUNCTION;
+  } else {
+    _dataLen = _expectedResponseLen;
+  }
+  callCallback();
+  return _err;
+}
+
+uint16_t PDU::invokeMerged() {
+  PDU* chain = _merged;
+  _merged = nullptr;
+  const uint8_t fn = _TXPDUbuffer[0];
+  const uint16_t start = (_TXPDUbuffer[1] << 8) | _TXPDUbuffer[2];
+  const bool exception = _RXPDUbuffer[0] == fn + 0x80;
+  // Validate against the merged request before it is restored
+  if (_err == 0 && !exception) {
+    if (_RXPDUbuffer[0] != fn) {
+      _err = MB_EX_LIB_INVALID_FUNCTION;
+    } else if (_RXPDUbuffer[1] != _PDUresponseHead[1]) {
+      _err = MB_EX_LIB_INVALID_BYTE_LENGTH;
+    }
+  }
+  restoreRequest();
+  if (_sparePDUbuffer) return invokeMergedShared(chain, start, exception);
+  for (PDU* pdu = chain; pdu; pdu = pdu->_merged) {
+    if (_err) {
+      pdu->_err = _err;
+    } else if (exception) {
+      pdu->_RXPDUbuffer[0] = _RXPDUbuffer[0];
+      pdu->_RXPDUbuffer[1] = _RXPDUbuffer[1];
+    } else {
+      sliceResponse(_RXPDUbuffer, pdu, start);
+    }
+  }
+  if (_err == 0 && !exception) sliceResponse(_RXPDUbuffer, this, start);  // In place, after the others were served
+  const uint16_t err = invoke();
+  while (chain) {  // Each request decodes its own view with its own element type
+    PDU* next = chain->_merged;
+    chain->_merged = nullptr;
+    chain->invoke();
+    chain = next;
+  }
+  return err;
+}
+
+uint16_t PDU::invokeMergedShared(PDU* chain, uint16_t start, bool exception) {
+  uint8_t* const rx = _RXPDUbuffer;
+  uint8_t* const spare = _sparePDUbuffer;
+  const uint16_t err = _err;
+  uint16_t result = 0;
+  for (PDU* pdu = this; pdu;) {
+    PDU* next = pdu == this ? chain : pdu->_merged;
+    pdu->_merged = nullptr;
+    if (err) {
+      pdu->_err = err;
+    } else {
+      pdu->_RXPDUbuffer = spare;
+      if (exception) {
+        spare[0] = rx[0];
+        spare[1] = rx[1];
+      } else {
+        sliceResponse(rx, pdu, start);
+      }
+    }
+    const uint16_t e = pdu->invoke();
+    pdu->_RXPDUbuffer = rx;  // Back to the shared buffer for the next transaction
+    if (pdu == this) result = e;
+    pdu = next;
+  }
+  return result;
+}
+
+uint16_t PDU::invokeFused() {
+  PDU* read = _fused;
+  bool exception = false;
+  if (_err == 0) {  // The write and the read share the result of the FC 0x17 request
+    if (_RXPDUbuffer[0] == MB_FC_READ_AND_WRITE_REGISTERS + 0x80) {
+      _err = _RXPDUbuffer[1];
+      exception = true;
+    } else if (_RXPDUbuffer[0] != MB_FC_READ_AND_WRITE_REGISTERS) {
+      _err = MB_EX_LIB_INVALID_FUNCTION;
+    } else if (_RXPDUbuffer[1] != read->_PDUresponseHead[1]) {
+      _err = MB_EX_LIB_INVALID_BYTE_LENGTH;
+    }
+  }
+  _dataBegin = 0;
+  _dataLen = 0;
+  if (_err != 0) {
+    const uint16_t err = _err;
+    _fused = nullptr;
+    if (exception) _RXPDUbuffer[0] = _fusedFn + 0x80;  // Each request sees the exception of its own function
+    callCallback();
+    if (exception) read->_RXPDUbuffer[0] = read->_PDUresponseHead[0] + 0x80;
+    read->_err = err;
+    read->callCallback();
+    return err;
+  }
+  _fused = nullptr;
+  _RXPDUbuffer[0] = _fusedFn;  // The read data stays in place for the read
+  callCallback();  // The write is done before the read
+  // FC 0x17 returns the read data like FC 0x03
+  if (read->_RXPDUbuffer != _RXPDUbuffer) memcpy(read->_RXPDUbuffer + 1, _RXPDUbuffer + 1, 1 + _RXPDUbuffer[1]);  // Nothing to copy if the RX buffer is shared
+  read->_RXPDUbuffer[0] = read->_PDUresponseHead[0];
+  return read->invoke();
+}
+
+void PDU::unfuse() {
+  uint8_t* tx = _TXPDUbuffer;
+  const uint8_t bytes = tx[9];
+  tx[0] = _PDUresponseHead[0] = _fusedFn;
+  tx[1] = _PDUresponseHead[1] = tx[5];  // Write address
+  tx[2] = tx[6];
+  if (_fusedFn == MB_FC_WRITE_SINGLE_REGISTER) {
+    tx[3] = tx[10];
+    tx[4] = tx[11];
+    _TXPDUbufferLen = 5;
+  } else {
+    tx[3] = tx[7];
+    tx[4] = tx[8];
+    tx[5] = bytes;
+    memmove(tx + 6, tx + 10, bytes);
+    _TXPDUbufferLen = 6 + bytes;
+  }
+  _expectedResponseLen = 5;
+  _fusedFn = 0;
+}
+
+void PDU::restoreRequest() {
+  const uint8_t fn = _TXPDUbuffer[0];
+  if (fn > MB_FC_READ_INPUT_REGISTERS) return;  // Merged writes are never repeated, nothing to restore
+  const uint8_t bytes = (fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS) ? (_reqQty + 7) / 8 : _reqQty * 2;
+  _TXPDUbuffer[1] = highByte(_reqAddr);
+  _TXPDUbuffer[2] = lowByte(_reqAddr);
+  _TXPDUbuffer[3] = highByte(_reqQty);
+  _TXPDUbuffer[4] = lowByte(_reqQty);
+  _PDUresponseHead[1] = bytes;
+  _expectedResponseLen = 2 + bytes;
+}
+
+void PDU::sliceResponse(const uint8_t* response, PDU* dst, uint16_t start) {
+  const uint8_t fn = response[0];
+  const uint16_t offset = dst->_reqAddr - start;
+  const uint8_t bytes = dst->_PDUresponseHead[1];
+  const uint8_t* src = response + 2;
+  uint8_t* out = dst->_RXPDUbuffer + 2;
+  if (fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS) {
+    const uint8_t srcBytes = response[1];
+    const uint8_t byteOffset = offset / 8;
+    const uint8_t shift = offset % 8;
+    // Ascending copy, safe in place because the source is never behind the destination
+    for (uint8_t i = 0; i < bytes; i++) {
+      const uint8_t ix = byteOffset + i;
+      uint8_t v = src[ix] >> shift;
+      if (shift && ix + 1 < srcBytes) v |= src[ix + 1] << (8 - shift);
+      out[i] = v;
+    }
+    if (dst->_reqQty % 8) out[bytes - 1] &= (1 << (dst->_reqQty % 8)) - 1;  // Clear bits beyond the request
+  } else {
+    memmove(out, src + offset * 2, bytes);
+  }
+  dst->_RXPDUbuffer[0] = fn;
+  dst->_RXPDUbuffer[1] = bytes;
+}
+
+uint16_t PDU::createRaw(const uint8_t* src, uint8_t len, const modbusCallback& cb) {
+  _callback = cb;
+  _raw = true;
+  if (!src || len == 0) {
+    _err = MB_EX_LIB_TOO_FEW_DATA;
+    return _err;
+  }
+  const uint16_t qty = len >= 5 ? (src[3] << 8) | src[4] : 0;
+  uint16_t expected = 0;
+  switch (src[0]) {
+    case MB_FC_READ_COILS:
+    case MB_FC_READ_DISCRETE_INPUTS:
+      expected = 2 + ((qty + 7) / 8);
+      break;
+    case MB_FC_READ_HOLDING_REGISTERS:
+    case MB_FC_READ_INPUT_REGISTERS:
+    case MB_FC_READ_AND_WRITE_REGISTERS:
+      expected = 2 + qty * 2;
+      break;
+    case MB_FC_WRITE_SINGLE_COIL:
+    case MB_FC_WRITE_SINGLE_REGISTER:
+    case MB_FC_DIAGNOSTICS:
+    case MB_FC_WRITE_MULTIPLE_COILS:
+    case MB_FC_WRITE_MULTIPLE_REGISTERS:
+      expected = 5;
+      break;
+    case MB_FC_MASK_WRITE_REGISTER:
+      expected = 7;
+      break;
+    case MB_FC_READ_EXCEPTION_STATUS:
+      expected = 2;
+      break;
+    default:
+      _err = MB_EX_LIB_NOT_SUPPORTED;  // Variable length responses cannot be framed
+      return _err;
+  }
+  if (src[0] != MB_FC_READ_EXCEPTION_STATUS && len < 5) {
+    _err = MB_EX_LIB_TOO_FEW_DATA;
+    return _err;
+  }
+  if (_PDUSize < len || _PDUSize < expected) {
+    _err = MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+    return _err;
+  }
+  memcpy(_TXPDUbuffer, src, len);
+  _PDUresponseHead[0] = src[0];
+  _TXPDUbufferLen = len;
+  _expectedResponseLen = expected;
+  return MB_EX_SUCCESS;
+}
+
 uint16_t PDU::createWriteSingleCoil(uint16_t addr, bool value, const modbusCallback& cb) {
   _callback = cb;
   if (_PDUSize < 5) {
@@ -172,7 +481,7 @@ uint16_t PDU::createWriteSingleRegister(uint16_t addr, uint16_t value, const mod
   return MB_EX_SUCCESS;
 }
 
-uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb) {
+uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb, bool byRef) {
   _callback = cb;
   if (byteCount == 0) {
     _err = MB_EX_LIB_TOO_FEW_DATA;
@@ -182,7 +491,7 @@ uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const uint8_t* src, uint8_
     _err = MB_EX_LIB_TOO_MANY_DATA;
     return _err;
   }
-  if (_PDUSize < 6 + byteCount) {
+  if (_PDUSize < 6 + (byRef ? 0 : byteCount)) {
     _err = MB_EX_LIB_BUFFER_IS_TOO_SMALL;
     return _err;
   }
@@ -192,13 +501,18 @@ uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const uint8_t* src, uint8_
   _TXPDUbuffer[3] = _PDUresponseHead[3] = highByte(coilCount);
   _TXPDUbuffer[4] = _PDUresponseHead[4] = lowByte(coilCount);
   _TXPDUbuffer[5] = byteCount;
-  memcpy(_TXPDUbuffer + 6, src, byteCount);
+  if (byRef) {  // Sent by sendPayload()
+    _payload = src;
+    _payloadCount = byteCount;
+  } else {
+    memcpy(_TXPDUbuffer + 6, src, byteCount);
+  }
   _TXPDUbufferLen = 6 + byteCount;
   _expectedResponseLen = 5;
   return MB_EX_SUCCESS;
 }
 
-uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const bool* src, uint16_t coilCount, const modbusCallback& cb) {
+uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const bool* src, uint16_t coilCount, const modbusCallback& cb, bool byRef) {
   _callback = cb;
   if (coilCount == 0) {
     _err = MB_EX_LIB_TOO_FEW_DATA;
@@ -213,7 +527,7 @@ uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const bool* src, uint16_t
     _err = MB_EX_LIB_TOO_MANY_DATA;
     return _err;
   }
-  if (_PDUSize < 6 + byteCount) {
+  if (_PDUSize < 6 + (byRef ? 0 : byteCount)) {
     _err = MB_EX_LIB_BUFFER_IS_TOO_SMALL;
     return _err;
   }
@@ -223,11 +537,12 @@ uint16_t PDU::createWriteMultipleCoils(uint16_t addr, const bool* src, uint16_t
   _TXPDUbuffer[3] = _PDUresponseHead[3] = highByte(coilCount);
   _TXPDUbuffer[4] = _PDUresponseHead[4] = lowByte(coilCount);
   _TXPDUbuffer[5] = byteCount;
-  memset(_TXPDUbuffer + 6, 0, byteCount);  // Clear buffer to avoid residual data
-  for (uint16_t i = 0; i < coilCount; i++) {
-    if (src[i]) {
-      _TXPDUbuffer[6 + (i / 8)] |= (1 << (i % 8));
-    }
+  if (byRef) {  // Packed by sendPayload()
+    _payload = src;
+    _payloadBits = true;
+    _payloadCount = coilCount;
+  } else {
+    packBits(_TXPDUbuffer + 6, src, coilCount);
   }
   _TXPDUbufferLen = 6 + byteCount;
   _expectedResponseLen = 5;
@@ -305,6 +620,8 @@ uint16_t PDU::createReadState(uint8_t fn, uint16_t addr, uint16_t count, const m
   _TXPDUbuffer[3] = highByte(count);
   _TXPDUbuffer[4] = lowByte(count);
   _TXPDUbufferLen = 5;
+  _reqAddr = addr;
+  _reqQty = count;
   _PDUresponseHead[1] = (count + 7) / 8;
   _expectedResponseLen = 2 + ((count + 7) / 8);
   return MB_EX_SUCCESS;
@@ -318,32 +635,101 @@ void PDU::clear() {
   _err = 0;
   _expectedResponseLen = 0;
   _elemSize = 0;
+  _order = MB_ORDER_HOST;
+  _lazy = false;
+  _encoded = false;
+  _dst = nullptr;
+  _decoder = nullptr;
+  _scaling = nullptr;
+  _scaled = nullptr;
+  _scaledDouble = false;
+  _payload = nullptr;
+  _payloadSize = 0;
+  _payloadOrder = MB_ORDER_HOST;
+  _payloadBits = false;
+  _payloadCount = 0;
   _used = false;
   _delayToSend = 0;
   _queuedTime = 0;
   _slave = 0;
+  _context = nullptr;
+  _raw = false;
+  _merged = nullptr;
+  _completing = false;
+  _fused = nullptr;
+  _fusedFn = 0;
+  _reqAddr = 0;
+  _reqQty = 0;
+  _shadow = nullptr;
+  _shadowSeq = 0;
 }
 
 uint16_t PDU::getErr() const { return _err; }
 
 uint16_t PDU::toBigEndian(uint16_t src) {
-  if (isBigEndian) return src;
+  if (hostIsBigEndian) return src;
   return ((src & 0xFF) << 8) | ((src >> 8) & 0xFF);
 }
 
-bool PDU::convertToBigEndianRegisters(const uint8_t* src, uint8_t elemCount, uint8_t elemSize, uint8_t* dest, uint16_t destLen) {
+bool PDU::decodeRegisters(uint8_t* dst, const uint8_t* src, uint8_t elemCount, uint8_t elemSize, uint8_t order) {
+  if (order == MB_ORDER_HOST) {  // Whole registers, one bulk pass
+    HostRegisterCodec::convert(dst, src, (uint16_t)elemCount * elemSize / 2);
+    return true;
+  }
+  uint8_t temp[32];  // One element, dst may be src
+  if (elemSize > sizeof(temp)) return false;
+  for (uint8_t i = 0; i < elemCount; ++i) {
+    const uint8_t* p = src + i * elemSize;
+    for (uint8_t j = 0; j < elemSize; ++j) temp[orderedIndex(j, elemSize, order)] = p[j];
+    memcpy(dst + i * elemSize, temp, elemSize);
+  }
+  return true;
+}
+
+void PDU::decode() const {
+  if (!_encoded) return;
+  _encoded = false;
+  const uint8_t elemCount = _dataLen / _elemSize;
+  // The data is not part of the logical state, only its representation changes
+  const_cast<PDU*>(this)->convertFromBigEndianRegistersInPlace(_RXPDUbuffer + _dataBegin, elemCount, _elemSize);
+}
+
+const uint8_t* PDU::getWireData() const { return _encoded ? _RXPDUbuffer + _dataBegin : nullptr; }
+
+uint8_t PDU::orderedIndex(uint8_t ix, uint8_t elemSize, uint8_t order) {
+  // Position in the big-endian representation of the value
+  const uint8_t regs = elemSize / 2;
+  const uint8_t reg = (order == MB_ORDER_CDAB || order == MB_ORDER_DCBA) ? regs - 1 - ix / 2 : ix / 2;
+  const uint8_t swap = (order == MB_ORDER_BADC || order == MB_ORDER_DCBA) ? 1 : 0;
+  const uint8_t be = reg * 2 + ((ix % 2) ^ swap);
+  return hostIsBigEndian ? be : elemSize - 1 - be;
+}
+
+bool PDU::convertToBigEndianRegisters(const uint8_t* src, uint8_t elemCount, uint8_t elemSize, uint8_t* dest, uint16_t destLen, uint8_t order) {
   if (!src || !dest || elemSize == 0) return false;
   const uint8_t paddedSize = (elemSize % 2 == 0) ? elemSize : elemSize + 1;
   const uint16_t paddedTotal = elemCount * paddedSize;
   if (destLen < paddedTotal) return false;
-  if (isBigEndian) {
+  if (paddedSize == elemSize) {
+    if (order == MB_ORDER_HOST) {  // Whole registers, one bulk pass
+      HostRegisterCodec::convert(dest, src, paddedTotal / 2);
+      return true;
+    }
+    for (uint8_t i = 0; i < elemCount; ++i) {
+      const uint8_t* p = src + i * elemSize;
+      uint8_t* d = dest + i * elemSize;
+      for (uint8_t j = 0; j < elemSize; ++j) d[j] = p[orderedIndex(j, elemSize, order)];
+    }
+    return true;
+  }
+  if (hostIsBigEndian) {
     for (uint8_t i = 0; i < elemCount; ++i) {
       memcpy(dest + i * paddedSize, src + i * elemSize, elemSize);
       if (paddedSize > elemSize) dest[i * paddedSize + paddedSize - 1] = 0x00;  // Add padding
     }
     return true;
   }
-  // Little-endian: swap bytes and add padding
+  // Little-endian: swap bytes and add padding to odd-sized elements
   for (uint8_t i = 0; i < elemCount; ++i) {
     const uint8_t* p = src + i * elemSize;
     uint8_t* d = dest + i * paddedSize;
@@ -368,14 +754,18 @@ bool PDU::convertFromBigEndianRegistersInPlace(uint8_t* buffer, uint8_t elemCoun
   // Temporary buffer for one element (assumes elemSize <= _PDUSize / elemCount)
   uint8_t temp[32];  // Reasonable limit based on Modbus constraints
   if (elemSize > sizeof(temp)) return false;
-  for (uint8_t i = 0; i < elemCount; ++i) {
+  if (paddedSize == elemSize) {
+    _dataLen = destTotal;  // Drops a trailing partial element
+    return decodeRegisters(buffer, buffer, elemCount, elemSize, _order);
+  }
+  for (uint8_t i = 0; i < elemCount; ++i) {  // Odd-sized elements, strip the padding
     const uint8_t* src = buffer + i * paddedSize;
     for (uint8_t j = 0; j < paddedSize; j += 2) {
       const uint8_t hi = src[j];
       const uint8_t lo = src[j + 1];
       const uint16_t reg = (hi << 8) | lo;
-      const uint8_t loByte = isBigEndian ? lo : lowByte(reg);
-      const uint8_t hiByte = isBigEndian ? hi : highByte(reg);
+      const uint8_t loByte = hostIsBigEndian ? lo : lowByte(reg);
+      const uint8_t hiByte = hostIsBigEndian ? hi : highByte(reg);
       if (j < elemSize) temp[j] = loByte;
       if (j + 1 < elemSize) temp[j + 1] = hiByte;
     }
@@ -397,10 +787,20 @@ bool PDU::getBit(uint16_t ix) const {
   return (_RXPDUbuffer[byteIndex] >> bitIndex) & 0x01;
 }
 
+CoilBits PDU::getBits() const {
+  if (!_RXPDUbuffer) return CoilBits(nullptr, 0);
+  const uint16_t bits = _dataLen * 8;
+  const uint8_t fn = _TXPDUbuffer[0];
+  const bool coils = !_raw && (fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS) && _reqQty <= bits;
+  return CoilBits(_RXPDUbuffer + _dataBegin, coils ? _reqQty : bits);
+}
+
 uint8_t PDU::getSlaveId() const {
   return 0xFF;
 }
 
+void* PDU::getContext() const { return _context; }
+
 uint8_t PDU::getFunction() const { return _RXPDUbuffer[0]; }
 
 uint8_t PDU::getByteLen() const { return _dataLen; }
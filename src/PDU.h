@@ -8,10 +8,23 @@
 #include <Arduino.h>
 #include <Callback.h>
 
+#include "CoilBits.h"
 #include "ModbusCallbackTypes.h"
+#include "WordOrder.h"
 
 template <typename T>
 class ADUQueue;
+class WriteShadow;
+class ScalingTable;
+
+/**
+ * @def MB_PAYLOAD_CHUNK
+ * @brief Bytes of a referenced write payload serialized per write to the stream or client (default: 32).
+ * @details Stack buffer of PDU::sendPayload(), also the maximum padded element size of a referenced register write.
+ */
+#ifndef MB_PAYLOAD_CHUNK
+#define MB_PAYLOAD_CHUNK 32
+#endif
 
 /**
  * @class PDU
@@ -22,6 +35,9 @@ class PDU {
   friend class ModbusMaster;     ///< Access to private buffers for transaction handling.
   friend class ModbusRTUMaster;  ///< Access to private buffers for RTU-specific operations.
   friend class ModbusTCPClient;  ///< Access to private buffers for TCP-specific operations.
+  friend class RequestCoalescer;  ///< Access to private buffers for merging requests.
+  friend class WriteShadow;      ///< Access to private buffers for tracking writes.
+  friend class ScalingTable;     ///< Access to private buffers for scaling register responses.
   template <typename T>          ///< Access to private buffers for queue management.
   friend class ADUQueue;
 
@@ -36,11 +52,35 @@ class PDU {
   uint16_t _err = 0;                    ///< Error code (MB_EX_* from ModbusDef.h).
   uint8_t _expectedResponseLen = 0;     ///< Expected response length.
   uint8_t _elemSize = 0;                ///< Element size for register data (used in endian conversion).
+  uint8_t _order = MB_ORDER_HOST;       ///< Register layout of the response elements (MB_ORDER_*).
+  bool _lazy = false;                   ///< Keep register data in wire format until it is accessed.
+  mutable bool _encoded = false;        ///< Register data is still in wire format (lazy decoding).
+  uint8_t* _dst = nullptr;              ///< Bound destination the response is decoded into, nullptr if none.
+  void (*_decoder)(uint8_t* dst, const uint8_t* src) = nullptr;  ///< Record decoder for _dst (see RegisterSchema), nullptr for plain elements.
+  const ScalingTable* _scaling = nullptr;  ///< Table converting the response into _scaled before the callback, nullptr if none.
+  void* _scaled = nullptr;              ///< Output array of _scaling (float or double).
+  bool _scaledDouble = false;           ///< _scaled holds doubles.
   boolean _used = false;                ///< Indicates if PDU is in use.
   uint8_t _PDUSize = 0;                 ///< Max PDU size, set by ADUTCP/ADURTU (user-defined, up to 253 bytes).
   uint32_t _queuedTime = 0;             ///< Time when PDU was queued (ms).
   uint32_t _delayToSend = 0;            ///< Delay before sending (ms).
   uint8_t _slave = 0;                   ///< Slave ID for error response.
+  void* _context = nullptr;             ///< Opaque caller context, returned by getContext().
+  bool _raw = false;                    ///< Raw pass-through request (no response decoding).
+  PDU* _merged = nullptr;               ///< Next request served by the same transaction (see RequestCoalescer).
+  bool _completing = false;             ///< Callback is running, no request may be attached anymore.
+  PDU* _fused = nullptr;                ///< Read served by the FC 0x17 request this write was turned into (see RequestCoalescer).
+  uint8_t _fusedFn = 0;                 ///< Original function code of a write turned into FC 0x17, 0 if not fused.
+  uint16_t _reqAddr = 0;                ///< Start address of the original read request.
+  uint16_t _reqQty = 0;                 ///< Registers or bits of the original read request.
+  WriteShadow* _shadow = nullptr;       ///< Shadow to report the result of this write to (see ModbusMaster::setWriteShadow()).
+  uint32_t _shadowSeq = 0;              ///< Sequence number the shadow gave this write (see WriteShadow::expect()).
+  const void* _payload = nullptr;       ///< Caller-owned write data serialized at transmit time, nullptr if copied into the TX buffer.
+  uint8_t _payloadSize = 0;             ///< Element size of the referenced registers, 0 for packed coil bytes.
+  uint8_t _payloadOrder = MB_ORDER_HOST;  ///< Register layout of the referenced elements (MB_ORDER_*).
+  bool _payloadBits = false;            ///< Referenced data is a bool array, packed to coils at transmit time.
+  uint16_t _payloadCount = 0;           ///< Referenced elements, bools or bytes.
+  uint8_t* _sparePDUbuffer = nullptr;   ///< Spare receive buffer for merged requests if the RX buffer is shared (see ModbusRTUMaster), nullptr otherwise.
 
   /**
    * @brief Processes the received PDU and calls callback.
@@ -49,15 +89,75 @@ class PDU {
    */
   uint16_t invoke();
 
+  /**
+   * @brief Processes a raw pass-through response and calls callback.
+   * @details Exposes the whole response PDU (or the exception PDU) as data without decoding.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t invokeRaw();
+
+  /**
+   * @brief Processes the response of a merged transaction.
+   * @details Slices the response into every chained request and invokes them in queue order.
+   * @return uint16_t Error code (MB_EX_*) of the leader or 0 if successful.
+   */
+  uint16_t invokeMerged();
+
+  /**
+   * @brief Processes the response of a write fused with a read into one FC 0x17 request.
+   * @details Completes the write while the frame still holds the FC 0x17 response, then hands the read data to the
+   *          fused read request.
+   * @return uint16_t Error code (MB_EX_*) of the read or 0 if successful.
+   */
+  uint16_t invokeFused();
+
+  /**
+   * @brief Restores the original read request after it was widened by RequestCoalescer.
+   */
+  void restoreRequest();
+
+  /**
+   * @brief Restores the original write request after it was turned into FC 0x17 by RequestCoalescer.
+   */
+  void unfuse();
+
+  /**
+   * @brief Serves a merged transaction whose RX buffer is shared with the chained requests.
+   * @details Each request in turn gets its slice in the spare buffer, the shared response stays intact until the
+   *          last one is invoked.
+   * @param chain First chained request.
+   * @param start Start address of the merged read.
+   * @param exception The response is an exception.
+   * @return uint16_t Error code (MB_EX_*) of the leader or 0 if successful.
+   */
+  uint16_t invokeMergedShared(PDU* chain, uint16_t start, bool exception);
+
+  /**
+   * @brief Copies the part of a merged read response requested by dst into its RX buffer.
+   * @param response Merged response PDU (function code, byte count, data).
+   * @param dst Request to serve (may be this PDU, the copy is done in place).
+   * @param start Start address of the merged read.
+   */
+  void sliceResponse(const uint8_t* response, PDU* dst, uint16_t start);
+
   /**
    * @brief Resets PDU state and clears buffers.
    * @details Clears all buffers and resets internal state.
    */
   virtual void clear();
 
+  /**
+   * @brief Serializes a referenced write payload to the stream or client.
+   * @details Converts the caller's data in chunks of MB_PAYLOAD_CHUNK bytes, so the values are read at transmit time.
+   * @param out Stream or client the request header was written to.
+   * @param crc CRC-16 to continue over the payload, nullptr if none.
+   */
+  void sendPayload(Print& out, uint16_t* crc) const;
+
   /**
    * @brief Executes the callback function if valid.
-   * @details Calls the registered callback with the PDU reference.
+   * @details Calls the registered callback with the PDU reference. Requests merged into this one by
+   *          RequestCoalescer are completed afterwards with the same error code, a fused read last.
    */
   void callCallback();
 
@@ -86,9 +186,10 @@ class PDU {
    * @param byteCount Number of bytes in the source array.
    * @param coilCount Number of coils to write.
    * @param cb Callback function for response handling.
+   * @param byRef Reference src and serialize it at transmit time instead of copying it.
    * @return uint16_t Error code (MB_EX_*) or 0 if successful.
    */
-  uint16_t createWriteMultipleCoils(uint16_t addr, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb);
+  uint16_t createWriteMultipleCoils(uint16_t addr, const uint8_t* src, uint8_t byteCount, uint16_t coilCount, const modbusCallback& cb, bool byRef = false);
 
   /**
    * @brief Creates PDU for writing multiple coils from bool array (Function Code 0x0F).
@@ -96,9 +197,10 @@ class PDU {
    * @param src Source bool array containing coil values.
    * @param coilCount Number of coils to write.
    * @param cb Callback function for response handling.
+   * @param byRef Reference src and pack it at transmit time instead of copying it.
    * @return uint16_t Error code (MB_EX_*) or 0 if successful.
    */
-  uint16_t createWriteMultipleCoils(uint16_t addr, const bool* src, uint16_t coilCount, const modbusCallback& cb);
+  uint16_t createWriteMultipleCoils(uint16_t addr, const bool* src, uint16_t coilCount, const modbusCallback& cb, bool byRef = false);
 
   /**
    * @brief Creates PDU for writing multiple holding registers (Function Code 0x10).
@@ -107,10 +209,22 @@ class PDU {
    * @param src Source array containing register values.
    * @param count Number of registers to write.
    * @param cb Callback function for response handling.
+   * @param byRef Reference src and convert it at transmit time instead of copying it.
    * @return uint16_t Error code (MB_EX_*) or 0 if successful.
    */
   template <typename T>
-  uint16_t createWriteHoldingRegister(uint16_t addr, const T* src, uint8_t count, const modbusCallback& cb);
+  uint16_t createWriteHoldingRegister(uint16_t addr, const T* src, uint16_t count, const modbusCallback& cb, bool byRef = false);
+
+  /**
+   * @brief Creates PDU for writing a struct as a record of holding registers (Function Code 0x10).
+   * @tparam SCHEMA RegisterSchema of the struct.
+   * @param addr Starting register address (0-65535).
+   * @param src Source struct.
+   * @param cb Callback function for response handling.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  template <typename SCHEMA>
+  uint16_t createWriteRecord(uint16_t addr, const typename SCHEMA::type* src, const modbusCallback& cb);
 
   /**
    * @brief Creates PDU for mask write register (Function Code 0x16).
@@ -137,6 +251,16 @@ class PDU {
   template <typename READ_T, typename WRITE_T>
   uint16_t createReadWriteMultipleRegisters(uint16_t readAddr, uint8_t readCount, uint16_t writeAddr, const WRITE_T* writeData, uint16_t writeCount, const modbusCallback& cb);
 
+  /**
+   * @brief Creates PDU from a pre-encoded request PDU (pass-through).
+   * @details Copies the request as is and derives the expected response length from the function code.
+   * @param src Request PDU (function code followed by data).
+   * @param len Length of the request PDU.
+   * @param cb Callback function for response handling.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t createRaw(const uint8_t* src, uint8_t len, const modbusCallback& cb);
+
   /**
    * @brief Creates PDU for reading exception status (Function Code 0x07).
    * @param cb Callback function for response handling.
@@ -182,6 +306,31 @@ class PDU {
    */
   static uint8_t toRegisterCount(uint8_t byteCount);
 
+  /**
+   * @brief Converts whole-register elements from wire format to host format.
+   * @param dst Destination buffer (may be src).
+   * @param src Wire data.
+   * @param elemCount Number of elements.
+   * @param elemSize Size of each element (even).
+   * @param order Register layout (MB_ORDER_*).
+   * @return bool True if conversion succeeded, false otherwise.
+   */
+  static bool decodeRegisters(uint8_t* dst, const uint8_t* src, uint8_t elemCount, uint8_t elemSize, uint8_t order);
+
+  /**
+   * @brief Converts register data still in wire format in place (lazy decoding).
+   */
+  void decode() const;
+
+  /**
+   * @brief Returns the host byte of an element that goes to a wire byte.
+   * @param ix Byte index on the wire within the element.
+   * @param elemSize Size of the element (even).
+   * @param order Register layout (MB_ORDER_ABCD to MB_ORDER_DCBA).
+   * @return uint8_t Byte index in host memory.
+   */
+  static uint8_t orderedIndex(uint8_t ix, uint8_t elemSize, uint8_t order);
+
   /**
    * @brief Converts data to big-endian format with padding.
    * @param src Source data buffer.
@@ -189,9 +338,10 @@ class PDU {
    * @param elemSize Size of each element.
    * @param dest Destination buffer.
    * @param destLen Length of the destination buffer.
+   * @param order Register layout of even-sized elements (MB_ORDER_*, default: MB_ORDER_HOST).
    * @return bool True if conversion succeeded, false otherwise.
    */
-  static bool convertToBigEndianRegisters(const uint8_t* src, uint8_t elemCount, uint8_t elemSize, uint8_t* dest, uint16_t destLen);
+  static bool convertToBigEndianRegisters(const uint8_t* src, uint8_t elemCount, uint8_t elemSize, uint8_t* dest, uint16_t destLen, uint8_t order = MB_ORDER_HOST);
 
   /**
    * @brief Converts 16-bit value to big-endian format.
@@ -202,6 +352,7 @@ class PDU {
 
   /**
    * @brief Converts received big-endian register data in-place.
+   * @details Even-sized elements are reordered according to _order.
    * @param buffer Data buffer to convert.
    * @param elemCount Number of elements.
    * @param elemSize Size of each element.
@@ -228,6 +379,13 @@ class PDU {
    */
   virtual bool repeatIfNeeded();
 
+  /**
+   * @brief Checks if the request is sent to several slaves in turn.
+   * @details Virtual method overridden in ADUTCP/ADURTU, such requests must keep their TX buffer unchanged.
+   * @return bool True if the PDU iterates over Slaves.
+   */
+  virtual bool isRepeating() const;
+
  public:
   /**
    * @brief Default constructor.
@@ -260,6 +418,12 @@ class PDU {
    */
   virtual uint8_t getSlaveId() const;
 
+  /**
+   * @brief Returns the caller context attached to the request.
+   * @return void* Context pointer, or nullptr if none was given.
+   */
+  void* getContext() const;
+
   /**
    * @brief Returns the function code from the RX buffer.
    * @return uint8_t Function code.
@@ -283,6 +447,25 @@ class PDU {
   template <typename T>
   const T* getDataArray() const;
 
+  /**
+   * @brief Copies values from the RX buffer into a caller buffer.
+   * @details With lazy decoding the values are converted while copying, the response stays in wire format.
+   * @tparam T Type of the values.
+   * @param dst Destination buffer.
+   * @param count Max number of values to copy.
+   * @param first Index of the first value (default: 0).
+   * @return uint16_t Number of values copied.
+   */
+  template <typename T>
+  uint16_t copyData(T* dst, uint16_t count, uint16_t first = 0) const;
+
+  /**
+   * @brief Returns the register data in wire format (big-endian registers).
+   * @details Only available with lazy decoding until a value was accessed with getDataArray().
+   * @return const uint8_t* Wire data (getByteLen() bytes), or nullptr if already converted.
+   */
+  const uint8_t* getWireData() const;
+
   /**
    * @brief Retrieves a single bit from the RX buffer.
    * @param ix Bit index.
@@ -290,6 +473,13 @@ class PDU {
    */
   bool getBit(uint16_t ix) const;
 
+  /**
+   * @brief Returns a bitset view over the bits of a coil or discrete input response.
+   * @details Holds the requested number of bits, for other responses every bit of the data.
+   * @return CoilBits View, valid while the PDU is (i.e. inside the callback).
+   */
+  CoilBits getBits() const;
+
   /**
    * @brief Returns the number of elements in the RX buffer.
    * @tparam T Type of the elements.
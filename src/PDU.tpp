@@ -4,15 +4,16 @@
 #include "PDU.h"
 
 template <typename T>
-uint16_t PDU::createWriteHoldingRegister(uint16_t addr, const T* src, uint8_t count, const modbusCallback& cb) {
+uint16_t PDU::createWriteHoldingRegister(uint16_t addr, const T* src, uint16_t count, const modbusCallback& cb, bool byRef) {
   _callback = cb;
   constexpr uint8_t elemSize = sizeof(T);
   constexpr uint8_t paddedSize = (elemSize % 2 == 0) ? elemSize : elemSize + 1;
+  static_assert(paddedSize <= MB_PAYLOAD_CHUNK, "Element size exceeds MB_PAYLOAD_CHUNK");
+  if (count == 0) return _err = MB_EX_LIB_TOO_FEW_DATA;
+  if ((uint32_t)count * paddedSize > MB_MAX_WRITE_REGISTERS * 2) return _err = MB_EX_LIB_TOO_MANY_DATA;
   const uint16_t totalBytes = count * paddedSize;
   const uint16_t regCount = totalBytes / 2;
-  if (count == 0) return _err = MB_EX_LIB_TOO_FEW_DATA;
-  if (regCount > MB_MAX_WRITE_REGISTERS) return _err = MB_EX_LIB_TOO_MANY_DATA;
-  if (_PDUSize < 6 + totalBytes) return _err = MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  if (_PDUSize < 6 + (byRef ? 0 : totalBytes)) return _err = MB_EX_LIB_BUFFER_IS_TOO_SMALL;
   _TXPDUbuffer[0] = _PDUresponseHead[0] = MB_FC_WRITE_MULTIPLE_REGISTERS;
   _TXPDUbuffer[1] = _PDUresponseHead[1] = highByte(addr);
   _TXPDUbuffer[2] = _PDUresponseHead[2] = lowByte(addr);
@@ -20,8 +21,13 @@ uint16_t PDU::createWriteHoldingRegister(uint16_t addr, const T* src, uint8_t co
   _TXPDUbuffer[4] = _PDUresponseHead[4] = lowByte(regCount);
   _TXPDUbuffer[5] = totalBytes;
   const uint8_t* srcBytes = reinterpret_cast<const uint8_t*>(src);
-  uint8_t* dst = _TXPDUbuffer + 6;
-  if (!convertToBigEndianRegisters(srcBytes, count, elemSize, dst, _PDUSize - 6)) {
+  if (byRef) {  // Converted by sendPayload()
+    if (!src) return _err = MB_EX_LIB_INVALID_DATA;
+    _payload = src;
+    _payloadSize = elemSize;
+    _payloadOrder = WordOrderOf<T>::value;
+    _payloadCount = count;
+  } else if (!convertToBigEndianRegisters(srcBytes, count, elemSize, _TXPDUbuffer + 6, _PDUSize - 6, WordOrderOf<T>::value)) {
     _err = MB_EX_LIB_INVALID_DATA;
     return _err;
   }
@@ -30,10 +36,30 @@ uint16_t PDU::createWriteHoldingRegister(uint16_t addr, const T* src, uint8_t co
   return MB_EX_SUCCESS;
 }
 
+template <typename SCHEMA>
+uint16_t PDU::createWriteRecord(uint16_t addr, const typename SCHEMA::type* src, const modbusCallback& cb) {
+  _callback = cb;
+  constexpr uint16_t regCount = SCHEMA::registers;
+  static_assert(regCount <= MB_MAX_WRITE_REGISTERS, "Record exceeds a write request");
+  if (!src) return _err = MB_EX_LIB_INVALID_DATA;
+  if (_PDUSize < 6 + regCount * 2) return _err = MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  _TXPDUbuffer[0] = _PDUresponseHead[0] = MB_FC_WRITE_MULTIPLE_REGISTERS;
+  _TXPDUbuffer[1] = _PDUresponseHead[1] = highByte(addr);
+  _TXPDUbuffer[2] = _PDUresponseHead[2] = lowByte(addr);
+  _TXPDUbuffer[3] = _PDUresponseHead[3] = highByte(regCount);
+  _TXPDUbuffer[4] = _PDUresponseHead[4] = lowByte(regCount);
+  _TXPDUbuffer[5] = regCount * 2;
+  SCHEMA::encode(*src, _TXPDUbuffer + 6);
+  _TXPDUbufferLen = 6 + regCount * 2;
+  _expectedResponseLen = 5;
+  return MB_EX_SUCCESS;
+}
+
 template <typename READ_T, typename WRITE_T>
 uint16_t PDU::createReadWriteMultipleRegisters(uint16_t readAddr, uint8_t readCount, uint16_t writeAddr, const WRITE_T* writeData, uint16_t writeCount, const modbusCallback& cb) {
   _callback = cb;
   _elemSize = sizeof(READ_T);  // Used for response data decompression
+  _order = WordOrderOf<READ_T>::value;
   constexpr uint8_t writeElemSize = sizeof(WRITE_T);
   constexpr uint8_t paddedSize = (writeElemSize % 2 == 0) ? writeElemSize : writeElemSize + 1;
   const uint16_t totalWriteBytes = writeCount * paddedSize;
@@ -57,7 +83,7 @@ uint16_t PDU::createReadWriteMultipleRegisters(uint16_t readAddr, uint8_t readCo
   _PDUresponseHead[1] = readByteCount;
   const uint8_t* srcBytes = reinterpret_cast<const uint8_t*>(writeData);
   uint8_t* dst = _TXPDUbuffer + 10;
-  if (!convertToBigEndianRegisters(srcBytes, writeCount, writeElemSize, dst, _PDUSize - 10)) {
+  if (!convertToBigEndianRegisters(srcBytes, writeCount, writeElemSize, dst, _PDUSize - 10, WordOrderOf<WRITE_T>::value)) {
     _err = MB_EX_LIB_INVALID_DATA;
     return _err;
   }
@@ -70,6 +96,7 @@ template <typename T>
 uint16_t PDU::createReadRegisters(uint8_t fn, uint16_t addr, uint8_t count, const modbusCallback& cb) {
   _callback = cb;
   _elemSize = sizeof(T);
+  _order = WordOrderOf<T>::value;
   if (count == 0) {
     _err = MB_EX_LIB_TOO_FEW_DATA;
     return _err;
@@ -90,6 +117,8 @@ uint16_t PDU::createReadRegisters(uint8_t fn, uint16_t addr, uint8_t count, cons
   _TXPDUbuffer[3] = highByte(regCount);
   _TXPDUbuffer[4] = lowByte(regCount);
   _TXPDUbufferLen = 5;
+  _reqAddr = addr;
+  _reqQty = regCount;
   _PDUresponseHead[1] = byteCount;
   _expectedResponseLen = 2 + byteCount;
   return MB_EX_SUCCESS;
@@ -102,6 +131,14 @@ const T PDU::getData(uint16_t ix) const {
   if (offset + sizeof(T) > _PDUSize || ix >= (_dataLen / sizeof(T))) {
     return dummy;
   }
+  if (_encoded) {
+    if (sizeof(T) == _elemSize) {  // Converts only the requested value
+      T value;
+      decodeRegisters(reinterpret_cast<uint8_t*>(&value), _RXPDUbuffer + offset, 1, sizeof(T), _order);
+      return value;
+    }
+    decode();
+  }
   return reinterpret_cast<const T*>(&_RXPDUbuffer[_dataBegin])[ix];
 }
 
@@ -109,9 +146,25 @@ template <typename T>
 const T* PDU::getDataArray() const {
   static_assert(sizeof(T) > 0, "Invalid type size");
   if (!_RXPDUbuffer) return nullptr;
+  decode();
   return reinterpret_cast<const T*>(_RXPDUbuffer + _dataBegin);
 }
 
+template <typename T>
+uint16_t PDU::copyData(T* dst, uint16_t count, uint16_t first) const {
+  const uint16_t len = _dataLen / sizeof(T);
+  if (!dst || !_RXPDUbuffer || first >= len) return 0;
+  if (count > len - first) count = len - first;
+  const uint8_t* src = _RXPDUbuffer + _dataBegin + first * sizeof(T);
+  if (_encoded && sizeof(T) == _elemSize) {
+    decodeRegisters(reinterpret_cast<uint8_t*>(dst), src, count, sizeof(T), _order);
+  } else {
+    decode();
+    memcpy(dst, src, count * sizeof(T));
+  }
+  return count;
+}
+
 template <typename T>
 uint8_t PDU::getLen() const {
   return _dataLen / sizeof(T);
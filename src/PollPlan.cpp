@@ -0,0 +1,460 @@
+#include "PollPlan.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "ModbusMaster.h"
+#include "ModbusUtility.h"
+#include "PDU.h"
+
+static_assert(sizeof(PollImageHeader) == 24, "PollImageHeader layout changed");
+static_assert(sizeof(PollImageBlock) == 16, "PollImageBlock layout changed");
+static_assert(sizeof(PollImageTag) == 6, "PollImageTag layout changed");
+
+uint16_t PollTag::getId() const { return _id; }
+
+uint8_t PollTag::getSlaveId() const { return _slave; }
+
+uint8_t PollTag::getTable() const { return _table; }
+
+uint16_t PollTag::getAddress() const { return _address; }
+
+uint8_t PollTag::getType() const { return _type; }
+
+uint32_t PollTag::getPeriod() const { return _period; }
+
+uint16_t PollTag::getErr() const { return _err; }
+
+bool PollTag::hasValue() const { return _hasValue; }
+
+uint32_t PollTag::getRaw() const { return _raw; }
+
+bool PollTag::getBool() const { return _raw != 0; }
+
+int32_t PollTag::getInt() const {
+  switch (_type) {
+    case MB_TAG_INT16:
+      return (int16_t)_raw;
+    case MB_TAG_FLOAT:
+      return (int32_t)getFloat();
+    default:
+      return (int32_t)_raw;
+  }
+}
+
+float PollTag::getFloat() const {
+  switch (_type) {
+    case MB_TAG_INT16:
+      return (int16_t)_raw;
+    case MB_TAG_INT32:
+      return (int32_t)_raw;
+    case MB_TAG_FLOAT: {
+      float f;
+      memcpy(&f, &_raw, sizeof(f));
+      return f;
+    }
+    default:
+      return _raw;
+  }
+}
+
+void* PollTag::getContext() const { return _context; }
+
+PollPlan::PollPlan() {}
+
+PollPlan::~PollPlan() {
+  delete[] _tags;
+  delete[] _order;
+  delete[] _blockStore;
+  delete[] _tagStore;
+  delete[] _blocks;
+  delete[] _illegal;
+#if defined(__linux__)
+  if (_mapSize) munmap(const_cast<uint8_t*>(_image), _mapSize);
+#endif
+}
+
+uint16_t PollPlan::begin(ModbusMaster* master, uint16_t tagSize, uint16_t blockSize, uint8_t illegalSize) {
+  if (_tags) return MB_EX_LIB_NOT_SUPPORTED;  // Started or loaded before, in-flight polls use the blocks
+  _master = master;
+  _tagSize = tagSize;
+  _tags = new PollTag[_tagSize];
+  _order = new uint16_t[_tagSize];
+  _tagStore = new PollImageTag[_tagSize];
+  _blockSize = blockSize;
+  _blockStore = new PollImageBlock[_blockSize];
+  _blocks = new PollBlock[_blockSize];
+  _illegalSize = illegalSize;
+  _illegal = illegalSize ? new PollRange[_illegalSize] : nullptr;
+  return MB_EX_SUCCESS;
+}
+
+uint16_t PollPlan::loadImage(ModbusMaster* master, const uint8_t* image, uint32_t size) {
+  if (_tags) return MB_EX_LIB_NOT_SUPPORTED;  // Started with begin() or loaded before, in-flight polls use the blocks
+  if (!image || size < sizeof(PollImageHeader) || ((uintptr_t)image & 3)) return MB_EX_LIB_INVALID_ARGUMENT;
+  const PollImageHeader* header = reinterpret_cast<const PollImageHeader*>(image);
+  if (header->magic != MB_PLAN_MAGIC || header->version != MB_PLAN_VERSION || header->headerSize < sizeof(PollImageHeader) ||
+      (header->headerSize & 3) || header->blockSize != sizeof(PollImageBlock) || header->tagSize != sizeof(PollImageTag)) {
+    return MB_EX_LIB_NOT_SUPPORTED;
+  }
+  const uint32_t records = (uint32_t)header->blockCount * sizeof(PollImageBlock) + (uint32_t)header->tagCount * sizeof(PollImageTag);
+  if (header->headerSize + records > size) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  if (checksum(image + header->headerSize, records) != header->checksum) return MB_EX_LIB_INVALID_DATA;
+  const PollImageBlock* blockDefs = reinterpret_cast<const PollImageBlock*>(image + header->headerSize);
+  const PollImageTag* tagDefs = reinterpret_cast<const PollImageTag*>(blockDefs + header->blockCount);
+  PollTag* tags = new PollTag[header->tagCount];
+  // One pass to give the tags their declaration back, nothing is sorted or merged
+  for (uint16_t i = 0; i < header->blockCount; i++) {
+    const PollImageBlock& def = blockDefs[i];
+    const uint16_t address = (def.request[1] << 8) | def.request[2];
+    const uint16_t quantity = (def.request[3] << 8) | def.request[4];
+    const bool bits = isBitTable(def.table);
+    if (def.table > MB_TABLE_HOLDING_REGISTERS || def.slave == 0 || def.slave > MB_MAX_SLAVE_ID ||
+        (uint32_t)def.first + def.tagCount > header->tagCount || def.request[0] != functionOf(def.table) || quantity == 0 ||
+        quantity > (bits ? MB_MAX_READ_COILS : MB_MAX_READ_REGISTERS) || (uint32_t)address + quantity > 0x10000UL ||
+        def.responseBytes != (bits ? (quantity + 7) / 8 : quantity * 2)) {
+      delete[] tags;
+      return MB_EX_LIB_INVALID_DATA;
+    }
+    for (uint16_t k = 0; k < def.tagCount; k++) {
+      const PollImageTag& d = tagDefs[def.first + k];
+      if (d.id >= header->tagCount || d.type > MB_TAG_FLOAT || bits != (d.type == MB_TAG_BOOL) ||
+          (uint32_t)d.offset + widthOf(d.type) > quantity) {  // Decoded from the response without further checks
+        delete[] tags;
+        return MB_EX_LIB_INVALID_DATA;
+      }
+      PollTag& t = tags[d.id];
+      t._id = d.id;
+      t._slave = def.slave;
+      t._table = def.table;
+      t._type = d.type;
+      t._address = address + d.offset;
+      t._period = def.period;
+    }
+  }
+  _master = master;
+  _image = image;
+  _tags = tags;
+  _tagSize = header->tagCount;
+  _tagCount = header->tagCount;
+  _blockDefs = blockDefs;
+  _tagDefs = tagDefs;
+  _blockSize = header->blockCount;
+  _blockCount = header->blockCount;
+  _blocks = new PollBlock[_blockSize];
+  _compiled = true;
+  resetBlocks();
+  return MB_EX_SUCCESS;
+}
+
+#if defined(__linux__)
+uint16_t PollPlan::loadImage(ModbusMaster* master, const char* path) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) return MB_EX_LIB_INVALID_ARGUMENT;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return MB_EX_LIB_INVALID_ARGUMENT;
+  }
+  void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // The mapping keeps the file open
+  if (base == MAP_FAILED) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  const uint16_t err = loadImage(master, static_cast<const uint8_t*>(base), st.st_size);
+  if (err) {
+    munmap(base, st.st_size);
+    return err;
+  }
+  _mapSize = st.st_size;
+  return MB_EX_SUCCESS;
+}
+
+uint16_t PollPlan::saveImage(const char* path) const {
+  const uint32_t size = getImageSize();
+  uint8_t* buf = new uint8_t[size];
+  uint16_t err = writeImage(buf, size);
+  if (err == 0) {
+    const int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, buf, size) != (ssize_t)size) err = MB_EX_LIB_INVALID_ARGUMENT;
+    if (fd >= 0) close(fd);
+  }
+  delete[] buf;
+  return err;
+}
+#endif
+
+uint32_t PollPlan::getImageSize() const {
+  return sizeof(PollImageHeader) + (uint32_t)_blockCount * sizeof(PollImageBlock) + (uint32_t)_tagCount * sizeof(PollImageTag);
+}
+
+uint16_t PollPlan::writeImage(uint8_t* dst, uint32_t size) const {
+  if (!_compiled) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (!dst || size < getImageSize()) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  const uint32_t blockBytes = (uint32_t)_blockCount * sizeof(PollImageBlock);
+  const uint32_t tagBytes = (uint32_t)_tagCount * sizeof(PollImageTag);
+  PollImageHeader header = {};
+  header.magic = MB_PLAN_MAGIC;
+  header.version = MB_PLAN_VERSION;
+  header.headerSize = sizeof(PollImageHeader);
+  header.blockCount = _blockCount;
+  header.tagCount = _tagCount;
+  header.blockSize = sizeof(PollImageBlock);
+  header.tagSize = sizeof(PollImageTag);
+  uint8_t* records = dst + sizeof(PollImageHeader);
+  memcpy(records, _blockDefs, blockBytes);
+  memcpy(records + blockBytes, _tagDefs, tagBytes);
+  header.checksum = checksum(records, blockBytes + tagBytes);
+  memcpy(dst, &header, sizeof(header));
+  return MB_EX_SUCCESS;
+}
+
+void PollPlan::setCallback(const tagCallback& cb) { _callback = cb; }
+
+uint32_t PollPlan::checksum(const uint8_t* data, uint32_t len) {
+  uint32_t hash = 2166136261UL;
+  for (uint32_t i = 0; i < len; i++) {
+    hash ^= data[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
+
+void PollPlan::resetBlocks() {
+  const uint32_t now = millis();
+  for (uint16_t i = 0; i < _blockCount; i++) {
+    PollBlock& block = _blocks[i];
+    block._plan = this;
+    block._def = &_blockDefs[i];
+    block._busy = false;
+    block._last = now - block._def->period;  // Due at the first loop()
+  }
+}
+
+void PollPlan::sort() {
+  // Heap sort: O(n log n) without extra memory, the tag list may be large
+  uint16_t* a = _order;
+  const uint16_t n = _tagCount;
+  for (uint16_t i = 0; i < n; i++) a[i] = i;
+  for (uint32_t end = n, start = n / 2;;) {
+    if (start > 0) {
+      start--;  // Build the heap
+    } else {
+      if (end <= 1) break;
+      end--;  // Move the largest to the end
+      const uint16_t tmp = a[0];
+      a[0] = a[end];
+      a[end] = tmp;
+    }
+    uint32_t root = start;
+    for (uint32_t child; (child = 2 * root + 1) < end; root = child) {  // Sift down
+      if (child + 1 < end && before(_tags[a[child]], _tags[a[child + 1]])) child++;
+      if (!before(_tags[a[root]], _tags[a[child]])) break;
+      const uint16_t tmp = a[root];
+      a[root] = a[child];
+      a[child] = tmp;
+    }
+  }
+}
+
+bool PollPlan::isBitTable(uint8_t table) {
+  return table == MB_TABLE_COILS || table == MB_TABLE_DISCRETE_INPUTS;
+}
+
+uint8_t PollPlan::widthOf(uint8_t type) {
+  return (type == MB_TAG_UINT32 || type == MB_TAG_INT32 || type == MB_TAG_FLOAT) ? 2 : 1;
+}
+
+uint8_t PollPlan::functionOf(uint8_t table) {
+  static const uint8_t fn[] = {MB_FC_READ_COILS, MB_FC_READ_DISCRETE_INPUTS, MB_FC_READ_INPUT_REGISTERS, MB_FC_READ_HOLDING_REGISTERS};
+  return fn[table];
+}
+
+bool PollPlan::before(const PollTag& a, const PollTag& b) {
+  if (a._slave != b._slave) return a._slave < b._slave;
+  if (a._table != b._table) return a._table < b._table;
+  if (a._period != b._period) return a._period < b._period;
+  return a._address < b._address;
+}
+
+bool PollPlan::isIllegal(uint8_t slave, uint8_t table, uint32_t lo, uint32_t hi) const {
+  for (uint8_t i = 0; i < _illegalCount; i++) {
+    const PollRange& r = _illegal[i];
+    if (r._slave != slave || r._table != table) continue;
+    if (lo < (uint32_t)r._address + r._count && r._address < hi) return true;
+  }
+  return false;
+}
+
+uint16_t PollPlan::addTag(uint8_t slave, uint8_t table, uint16_t address, uint8_t type, uint32_t periodMs, const tagCallback& cb, void* context) {
+  if (_image) return MB_EX_LIB_NOT_SUPPORTED;
+  if (slave == 0 || slave > MB_MAX_SLAVE_ID) return MB_EX_LIB_INVALID_SLAVE;
+  if (table > MB_TABLE_HOLDING_REGISTERS || type > MB_TAG_FLOAT) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (isBitTable(table) != (type == MB_TAG_BOOL)) return MB_EX_LIB_INVALID_ARGUMENT;
+  if ((uint32_t)address + widthOf(type) > 0x10000UL) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (_tagCount == _tagSize) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  PollTag& t = _tags[_tagCount];
+  t._id = _tagCount++;
+  t._slave = slave;
+  t._table = table;
+  t._address = address;
+  t._type = type;
+  t._period = periodMs;
+  t._callback = cb;
+  t._context = context;
+  _compiled = false;
+  return MB_EX_SUCCESS;
+}
+
+uint16_t PollPlan::addIllegalRange(uint8_t slave, uint8_t table, uint16_t address, uint16_t count) {
+  if (table > MB_TABLE_HOLDING_REGISTERS || count == 0) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (_illegalCount == _illegalSize) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  PollRange& r = _illegal[_illegalCount++];
+  r._slave = slave;
+  r._table = table;
+  r._address = address;
+  r._count = count;
+  _compiled = false;
+  return MB_EX_SUCCESS;
+}
+
+uint16_t PollPlan::compile(uint16_t maxGap, uint16_t maxQuantity) {
+  if (_image) return MB_EX_LIB_NOT_SUPPORTED;
+  for (uint16_t i = 0; i < _blockCount; i++) {
+    if (_blocks[i]._busy) return MB_EX_LIB_INVALID_ARGUMENT;  // A response would be delivered to the wrong tags
+  }
+  _blockCount = 0;
+  _compiled = false;
+  sort();
+  if (maxQuantity == 0 || maxQuantity > MB_MAX_READ_REGISTERS) maxQuantity = MB_MAX_READ_REGISTERS;
+  const uint32_t bitLimit = (uint32_t)maxQuantity * 16 < MB_MAX_READ_COILS ? (uint32_t)maxQuantity * 16 : MB_MAX_READ_COILS;
+  PollImageBlock* def = nullptr;
+  uint32_t lo = 0;  // First address covered by def
+  uint32_t hi = 0;  // Address behind the last one covered by def
+  for (uint16_t i = 0; i < _tagCount; i++) {
+    const PollTag& t = _tags[_order[i]];
+    const uint32_t a = t._address;
+    const uint32_t b = a + widthOf(t._type);
+    if (isIllegal(t._slave, t._table, a, b)) {
+      _blockCount = 0;
+      return MB_EX_LIB_INVALID_ARGUMENT;
+    }
+    bool join = false;
+    if (def && def->slave == t._slave && def->table == t._table && def->period == t._period) {
+      const bool bits = isBitTable(t._table);
+      const uint32_t newHi = b > hi ? b : hi;
+      const uint32_t gap = a > hi ? a - hi : 0;
+      join = gap <= (bits ? (uint32_t)maxGap * 16 : maxGap) && newHi - lo <= (bits ? bitLimit : maxQuantity) &&
+             !isIllegal(t._slave, t._table, hi, newHi);
+      if (join) {
+        hi = newHi;
+        def->tagCount++;
+      }
+    }
+    if (!join) {
+      if (_blockCount == _blockSize) {
+        _blockCount = 0;
+        return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+      }
+      def = &_blockStore[_blockCount++];
+      memset(def, 0, sizeof(PollImageBlock));
+      def->period = t._period;
+      def->first = i;
+      def->tagCount = 1;
+      def->slave = t._slave;
+      def->table = t._table;
+      lo = a;
+      hi = b;
+    }
+    // Pre-encode the request and the decode descriptor
+    const uint16_t quantity = hi - lo;
+    def->request[0] = functionOf(def->table);
+    def->request[1] = highByte(lo);
+    def->request[2] = lowByte(lo);
+    def->request[3] = highByte(quantity);
+    def->request[4] = lowByte(quantity);
+    def->responseBytes = isBitTable(def->table) ? (quantity + 7) / 8 : quantity * 2;
+    PollImageTag& d = _tagStore[i];
+    d.id = t._id;
+    d.offset = a - lo;
+    d.type = t._type;
+    d.reserved = 0;
+  }
+  _blockDefs = _blockStore;
+  _tagDefs = _tagStore;
+  _compiled = true;
+  resetBlocks();
+  return MB_EX_SUCCESS;
+}
+
+void PollPlan::loop() {
+  if (!_master || !_compiled) return;
+  for (uint16_t i = 0; i < _blockCount; i++) {
+    PollBlock& block = _blocks[i];
+    if (block._busy || !on_ms(&block._last, block._def->period, false)) continue;
+    if (_master->getFreePDUCount() == 0) return;  // Wait, the block stays due
+    block._last = millis();
+    poll(block);
+  }
+}
+
+void PollPlan::poll(PollBlock& block) {
+  block._busy = true;
+  _master->sendRaw(block._def->slave, block._def->request, sizeof(block._def->request), modbusCallback(onResponse), &block);
+}
+
+void PollPlan::onResponse(PDU& pdu) {
+  PollBlock* block = static_cast<PollBlock*>(pdu.getContext());
+  if (!block) return;
+  block->_busy = false;
+  const uint8_t bytes = block->_def->responseBytes;
+  const uint8_t* data = pdu.getDataArray<uint8_t>();
+  uint16_t err = pdu.getErr();
+  if (err == 0 && (pdu.getByteLen() != 2 + bytes || data[1] != bytes)) err = MB_EX_LIB_INVALID_BYTE_LENGTH;
+  block->_plan->deliver(*block, err ? nullptr : data + 2, err);
+}
+
+void PollPlan::deliver(PollBlock& block, const uint8_t* data, uint16_t err) {
+  const PollImageBlock& def = *block._def;
+  const bool bits = isBitTable(def.table);
+  for (uint16_t i = 0; i < def.tagCount; i++) {
+    const PollImageTag& d = _tagDefs[def.first + i];
+    PollTag& t = _tags[d.id];
+    t._err = err;
+    if (data) {  // A failed poll keeps the last value
+      if (bits) {
+        t._raw = (data[d.offset >> 3] >> (d.offset & 7)) & 1;
+      } else {
+        const uint8_t* p = data + d.offset * 2;
+        uint32_t value = (uint16_t)((p[0] << 8) | p[1]);
+        if (widthOf(d.type) == 2) value = (value << 16) | (uint16_t)((p[2] << 8) | p[3]);
+        t._raw = value;
+      }
+      t._hasValue = true;
+    }
+    if (t._callback.valid()) {
+      t._callback(t);
+    } else if (_callback.valid()) {
+      _callback(t);
+    }
+  }
+}
+
+uint16_t PollPlan::getTagCount() const { return _tagCount; }
+
+const PollTag* PollPlan::getTag(uint16_t ix) const { return ix < _tagCount ? &_tags[ix] : nullptr; }
+
+uint16_t PollPlan::getBlockCount() const { return _compiled ? _blockCount : 0; }
+
+bool PollPlan::getBlock(uint16_t ix, uint8_t& slave, uint8_t& table, uint16_t& address, uint16_t& quantity, uint32_t& periodMs) const {
+  if (ix >= getBlockCount()) return false;
+  const PollImageBlock& def = _blockDefs[ix];
+  slave = def.slave;
+  table = def.table;
+  address = (def.request[1] << 8) | def.request[2];
+  quantity = (def.request[3] << 8) | def.request[4];
+  periodMs = def.period;
+  return true;
+}
@@ -0,0 +1,458 @@
+/**
+ * @file PollPlan.h
+ * @brief Compiles a declarative tag list into periodic block reads.
+ * @details Tags (slave, table, address, type, period) are grouped by slave, table and period, merged into covering
+ *          reads within gap and PDU limits and split at illegal address ranges. Every response is decoded per tag.
+ *          A compiled plan can be saved as a binary image and loaded without compiling (mapped file or flash).
+ */
+
+#pragma once
+#include <Arduino.h>
+#include <Callback.h>
+
+#include "ModbusDef.h"
+
+class PDU;
+class PollPlan;
+class PollTag;
+class ModbusMaster;
+
+#define MB_PLAN_MAGIC 0x5050424DUL  ///< "MBPP" in little-endian byte order.
+#define MB_PLAN_VERSION 1           ///< Image layout version.
+
+/**
+ * @struct PollImageHeader
+ * @brief Header at the start of a compiled plan image, followed by the block and tag records.
+ * @details All fields are in host byte order (little-endian on every supported target). The image must be 4-byte
+ *          aligned, records are used in place.
+ */
+struct PollImageHeader {
+  uint32_t magic;       ///< MB_PLAN_MAGIC.
+  uint16_t version;     ///< MB_PLAN_VERSION.
+  uint16_t headerSize;  ///< Size of this header (offset of the first block record).
+  uint16_t blockCount;  ///< Number of block records.
+  uint16_t tagCount;    ///< Number of tag records (after the block records).
+  uint16_t blockSize;   ///< Size of a block record.
+  uint16_t tagSize;     ///< Size of a tag record.
+  uint32_t checksum;    ///< FNV-1a of the records.
+  uint32_t reserved;    ///< Zero.
+};
+
+/**
+ * @struct PollImageBlock
+ * @brief Compiled read: pre-encoded request PDU and the tags it serves.
+ */
+struct PollImageBlock {
+  uint32_t period;        ///< Poll period (ms).
+  uint16_t first;         ///< First tag record of the block.
+  uint16_t tagCount;      ///< Tag records of the block.
+  uint8_t slave;          ///< Slave ID.
+  uint8_t table;          ///< Data table (MB_TABLE_*).
+  uint8_t request[5];     ///< Request PDU (function code, address, quantity big-endian).
+  uint8_t responseBytes;  ///< Expected data bytes of the response.
+};
+
+/**
+ * @struct PollImageTag
+ * @brief Decode descriptor of a tag in a block response.
+ */
+struct PollImageTag {
+  uint16_t id;      ///< Tag index in declaration order.
+  uint16_t offset;  ///< Register or bit offset from the block address.
+  uint8_t type;     ///< Value type (MB_TAG_*).
+  uint8_t reserved; ///< Zero.
+};
+
+/**
+ * @typedef tagCallback
+ * @brief Callback type for the delivery of a polled tag value.
+ */
+using tagCallback = Callback<void, const PollTag&>;
+
+/**
+ * @class PollTag
+ * @brief Declared tag and its last decoded value.
+ */
+class PollTag {
+  friend class PollPlan;  ///< Access to private members for decoding.
+
+ private:
+  uint16_t _id = 0;           ///< Index in declaration order.
+  uint8_t _slave = 0;         ///< Slave ID.
+  uint8_t _table = 0;         ///< Data table (MB_TABLE_*).
+  uint8_t _type = 0;          ///< Value type (MB_TAG_*).
+  uint16_t _address = 0;      ///< First address.
+  uint32_t _period = 0;       ///< Poll period (ms).
+  uint32_t _raw = 0;          ///< Last value, registers joined high word first.
+  uint16_t _err = 0;          ///< Error of the last poll (MB_EX_*).
+  bool _hasValue = false;     ///< A value was received at least once.
+  void* _context = nullptr;   ///< Opaque caller context.
+  tagCallback _callback;      ///< Called after every poll of the tag.
+
+ public:
+  /**
+   * @brief Returns the index of the tag in declaration order.
+   * @return uint16_t Index, also stored in a plan image.
+   */
+  uint16_t getId() const;
+
+  /**
+   * @brief Returns the slave ID.
+   * @return uint8_t Slave ID.
+   */
+  uint8_t getSlaveId() const;
+
+  /**
+   * @brief Returns the data table.
+   * @return uint8_t Data table (MB_TABLE_*).
+   */
+  uint8_t getTable() const;
+
+  /**
+   * @brief Returns the address.
+   * @return uint16_t First address.
+   */
+  uint16_t getAddress() const;
+
+  /**
+   * @brief Returns the value type.
+   * @return uint8_t Value type (MB_TAG_*).
+   */
+  uint8_t getType() const;
+
+  /**
+   * @brief Returns the poll period.
+   * @return uint32_t Period (ms).
+   */
+  uint32_t getPeriod() const;
+
+  /**
+   * @brief Returns the error of the last poll.
+   * @details The last value is kept when a poll fails.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t getErr() const;
+
+  /**
+   * @brief Checks if a value was received.
+   * @return bool True after the first successful poll.
+   */
+  bool hasValue() const;
+
+  /**
+   * @brief Returns the raw value.
+   * @return uint32_t Bit, register or registers joined high word first.
+   */
+  uint32_t getRaw() const;
+
+  /**
+   * @brief Returns the value as a bool.
+   * @return bool True if the value is not zero.
+   */
+  bool getBool() const;
+
+  /**
+   * @brief Returns the value as a signed integer.
+   * @details Sign extended for MB_TAG_INT16, MB_TAG_FLOAT is truncated.
+   * @return int32_t Value (use getRaw() for MB_TAG_UINT32 values above INT32_MAX).
+   */
+  int32_t getInt() const;
+
+  /**
+   * @brief Returns the value as a float.
+   * @return float Value of any type.
+   */
+  float getFloat() const;
+
+  /**
+   * @brief Returns the caller context given to PollPlan::addTag().
+   * @return void* Context.
+   */
+  void* getContext() const;
+};
+
+/**
+ * @class PollBlock
+ * @brief Poll state of a compiled read.
+ */
+class PollBlock {
+  friend class PollPlan;  ///< Access to private members for polling.
+
+ private:
+  PollPlan* _plan = nullptr;                ///< Owning plan.
+  const PollImageBlock* _def = nullptr;     ///< Compiled read (own record or image).
+  uint32_t _last = 0;                       ///< Time of the last poll (ms).
+  bool _busy = false;                       ///< Read in progress.
+};
+
+/**
+ * @class PollRange
+ * @brief Address range a compiled read must not cover.
+ */
+class PollRange {
+  friend class PollPlan;  ///< Access to private members for compiling.
+
+ private:
+  uint8_t _slave = 0;     ///< Slave ID.
+  uint8_t _table = 0;     ///< Data table (MB_TABLE_*).
+  uint16_t _address = 0;  ///< First illegal address.
+  uint16_t _count = 0;    ///< Illegal registers or bits.
+};
+
+/**
+ * @class PollPlan
+ * @brief Polls a tag list with as few transactions as possible.
+ * @details Tags are declared with addTag(), compile() sorts them by slave, table, period and address and merges
+ *          neighbours into one read while the covering range wastes at most maxGap addresses, stays within the
+ *          protocol and PDU limits and covers no illegal range. loop() sends every block when its period is due,
+ *          at most one read per block is in progress. Reads are sent with ModbusMaster::sendRaw(), so they are
+ *          never merged again by RequestCoalescer. Storage is allocated once in begin().
+ *          The compiled form is a set of PollImageBlock and PollImageTag records, writeImage() saves them and
+ *          loadImage() uses them in place, so a large plan starts without compiling.
+ */
+class PollPlan {
+ private:
+  ModbusMaster* _master = nullptr;              ///< Master used for polling.
+  PollTag* _tags = nullptr;                     ///< Tags in declaration order.
+  uint16_t _tagSize = 0;                        ///< Tag capacity.
+  uint16_t _tagCount = 0;                       ///< Declared tags.
+  uint16_t* _order = nullptr;                   ///< Tag indexes sorted for compiling.
+  PollImageBlock* _blockStore = nullptr;        ///< Compiled block records (not used with an image).
+  PollImageTag* _tagStore = nullptr;            ///< Compiled tag records (not used with an image).
+  const PollImageBlock* _blockDefs = nullptr;   ///< Block records in use.
+  const PollImageTag* _tagDefs = nullptr;       ///< Tag records in use.
+  PollBlock* _blocks = nullptr;                 ///< Poll state of every block.
+  uint16_t _blockSize = 0;                      ///< Block capacity.
+  uint16_t _blockCount = 0;                     ///< Compiled blocks.
+  bool _compiled = false;                       ///< Records match the declared tags.
+  PollRange* _illegal = nullptr;                ///< Illegal address ranges.
+  uint8_t _illegalSize = 0;                     ///< Illegal range capacity.
+  uint8_t _illegalCount = 0;                    ///< Declared illegal ranges.
+  const uint8_t* _image = nullptr;              ///< Loaded image (nullptr if compiled).
+  size_t _mapSize = 0;                          ///< Size of the mapped image file (0 if not mapped).
+  tagCallback _callback;                        ///< Called for tags without their own callback.
+
+  /**
+   * @brief Checks if a table holds bits.
+   * @param table Data table (MB_TABLE_*).
+   * @return bool True for coils and discrete inputs.
+   */
+  static bool isBitTable(uint8_t table);
+
+  /**
+   * @brief Returns the number of registers or bits a tag type occupies.
+   * @param type Value type (MB_TAG_*).
+   * @return uint8_t 1 or 2.
+   */
+  static uint8_t widthOf(uint8_t type);
+
+  /**
+   * @brief Returns the read function code of a table.
+   * @param table Data table (MB_TABLE_*).
+   * @return uint8_t MB_FC_READ_* function code.
+   */
+  static uint8_t functionOf(uint8_t table);
+
+  /**
+   * @brief Computes the checksum of the image records.
+   * @param data Records.
+   * @param len Length in bytes.
+   * @return uint32_t FNV-1a hash.
+   */
+  static uint32_t checksum(const uint8_t* data, uint32_t len);
+
+  /**
+   * @brief Sorts the tag indexes (heap sort, the tag list may be large).
+   */
+  void sort();
+
+  /**
+   * @brief Starts the poll state of every block, due at the first loop().
+   */
+  void resetBlocks();
+
+  /**
+   * @brief Checks if tag a sorts before tag b (slave, table, period, address).
+   * @param a First tag.
+   * @param b Second tag.
+   * @return bool True if a comes first.
+   */
+  static bool before(const PollTag& a, const PollTag& b);
+
+  /**
+   * @brief Checks if a range overlaps a declared illegal range.
+   * @param slave Slave ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param lo First address.
+   * @param hi Address behind the last one.
+   * @return bool True if any address is illegal.
+   */
+  bool isIllegal(uint8_t slave, uint8_t table, uint32_t lo, uint32_t hi) const;
+
+  /**
+   * @brief Sends the read of a block.
+   * @param block Block to poll.
+   */
+  void poll(PollBlock& block);
+
+  /**
+   * @brief Decodes a block response and delivers every tag.
+   * @param block Polled block.
+   * @param data Response data (wire format), nullptr on error.
+   * @param err Error code (MB_EX_*) or 0 if successful.
+   */
+  void deliver(PollBlock& block, const uint8_t* data, uint16_t err);
+
+  /**
+   * @brief Completion callback of a block read.
+   * @param pdu Raw response PDU, its context is the PollBlock.
+   */
+  static void onResponse(PDU& pdu);
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an empty plan.
+   */
+  PollPlan();
+
+  /**
+   * @brief Destructor.
+   * @details Frees the tag, block and range arrays.
+   */
+  ~PollPlan();
+
+  /**
+   * @brief Allocates the tag, block and range arrays.
+   * @param master Master used for polling (already started with begin()).
+   * @param tagSize Maximum number of tags.
+   * @param blockSize Maximum number of compiled blocks.
+   * @param illegalSize Maximum number of illegal ranges (default: 0).
+   * @return uint16_t MB_EX_LIB_NOT_SUPPORTED if already started with begin() or loadImage(), 0 otherwise.
+   */
+  uint16_t begin(ModbusMaster* master, uint16_t tagSize, uint16_t blockSize, uint8_t illegalSize = 0);
+
+  /**
+   * @brief Uses a compiled plan image in place instead of declaring and compiling tags.
+   * @details The image must stay valid and unchanged while the plan is used, e.g. a const array in flash
+   *          (alignas(4)) or a mapped file. Only the tag values and the poll state are allocated. Every request
+   *          and tag offset is checked against its table and quantity. Replaces begin(), a plan is either
+   *          declared or loaded once.
+   * @param master Master used for polling (already started with begin()).
+   * @param image Image written by writeImage().
+   * @param size Size of the image in bytes.
+   * @return uint16_t Error code (MB_EX_LIB_INVALID_ARGUMENT if misaligned, MB_EX_LIB_NOT_SUPPORTED for another
+   *                  layout version or a plan already started, MB_EX_LIB_BUFFER_IS_TOO_SMALL if truncated,
+   *                  MB_EX_LIB_INVALID_DATA if damaged or inconsistent) or 0 if successful.
+   */
+  uint16_t loadImage(ModbusMaster* master, const uint8_t* image, uint32_t size);
+
+#if defined(__linux__)
+  /**
+   * @brief Maps a plan image file read-only and uses it in place.
+   * @param master Master used for polling (already started with begin()).
+   * @param path Image file written by saveImage().
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t loadImage(ModbusMaster* master, const char* path);
+
+  /**
+   * @brief Writes the compiled plan to an image file.
+   * @param path File to create or replace.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t saveImage(const char* path) const;
+#endif
+
+  /**
+   * @brief Returns the size of the image of the compiled plan.
+   * @return uint32_t Bytes needed by writeImage().
+   */
+  uint32_t getImageSize() const;
+
+  /**
+   * @brief Writes the compiled plan as a binary image.
+   * @param dst Destination buffer.
+   * @param size Size of dst.
+   * @return uint16_t Error code (MB_EX_LIB_INVALID_ARGUMENT if not compiled, MB_EX_LIB_BUFFER_IS_TOO_SMALL) or 0.
+   */
+  uint16_t writeImage(uint8_t* dst, uint32_t size) const;
+
+  /**
+   * @brief Sets the callback of tags declared without one (e.g. every tag of a loaded image).
+   * @param cb Called after every poll of such a tag, PollTag::getId() identifies it.
+   */
+  void setCallback(const tagCallback& cb);
+
+  /**
+   * @brief Declares a tag.
+   * @details The plan must be compiled again before the tag is polled. Not available with a loaded image.
+   * @param slave Slave ID (1–247).
+   * @param table Data table (MB_TABLE_*).
+   * @param address First address.
+   * @param type Value type (MB_TAG_BOOL for bit tables, any other type for register tables).
+   * @param periodMs Poll period (ms).
+   * @param cb Called after every poll of the tag (optional).
+   * @param context Opaque pointer returned by PollTag::getContext() (default: nullptr).
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t addTag(uint8_t slave, uint8_t table, uint16_t address, uint8_t type, uint32_t periodMs, const tagCallback& cb = tagCallback(), void* context = nullptr);
+
+  /**
+   * @brief Declares an address range that no read may cover, e.g. a gap the device answers with an exception.
+   * @param slave Slave ID (1–247).
+   * @param table Data table (MB_TABLE_*).
+   * @param address First illegal address.
+   * @param count Illegal registers or bits.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t addIllegalRange(uint8_t slave, uint8_t table, uint16_t address, uint16_t count);
+
+  /**
+   * @brief Compiles the tag list into block reads.
+   * @param maxGap Max unused registers read between two tags (bit tables: maxGap * 16 bits, default: 8).
+   * @param maxQuantity Max registers per read, e.g. to fit a smaller PDU (bit tables: maxQuantity * 16 bits,
+   *                    default: 125).
+   * @return uint16_t Error code (MB_EX_LIB_INVALID_ARGUMENT if a tag overlaps an illegal range or a block is still
+   *                  being read, MB_EX_LIB_BUFFER_IS_TOO_SMALL if the block array is full, MB_EX_LIB_NOT_SUPPORTED
+   *                  with a loaded image) or 0 if successful.
+   */
+  uint16_t compile(uint16_t maxGap = 8, uint16_t maxQuantity = MB_MAX_READ_REGISTERS);
+
+  /**
+   * @brief Sends every block whose period is due.
+   * @details Must be called together with the master loop(). A block waits while the master has no free PDU.
+   */
+  void loop();
+
+  /**
+   * @brief Returns the number of declared tags.
+   * @return uint16_t Tags.
+   */
+  uint16_t getTagCount() const;
+
+  /**
+   * @brief Returns a tag in declaration order.
+   * @param ix Index (0 to getTagCount() - 1).
+   * @return const PollTag* Tag, or nullptr if ix is invalid.
+   */
+  const PollTag* getTag(uint16_t ix) const;
+
+  /**
+   * @brief Returns the number of compiled blocks.
+   * @return uint16_t Blocks (reads per cycle if every tag has the same period).
+   */
+  uint16_t getBlockCount() const;
+
+  /**
+   * @brief Returns a compiled block.
+   * @param ix Index (0 to getBlockCount() - 1).
+   * @param slave Set to the slave ID.
+   * @param table Set to the data table (MB_TABLE_*).
+   * @param address Set to the first address read.
+   * @param quantity Set to the registers or bits read.
+   * @param periodMs Set to the poll period (ms).
+   * @return bool True if ix is valid.
+   */
+  bool getBlock(uint16_t ix, uint8_t& slave, uint8_t& table, uint16_t& address, uint16_t& quantity, uint32_t& periodMs) const;
+};
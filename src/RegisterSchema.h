@@ -0,0 +1,250 @@
+/**
+ * @file RegisterSchema.h
+ * @brief Compile-time mapping of a struct onto holding or input registers.
+ * @details Field descriptors give the register offset, type, word order or bit position of every struct member,
+ *          RegisterSchema expands them into one encoder and one decoder for the whole record. The struct layout
+ *          (padding, member order) does not affect the register image.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ModbusDef.h"
+#include "ModbusUtility.h"
+
+/**
+ * @brief Byte of a value in big-endian order for a byte of its register image.
+ * @param ix Byte index in the register image (big-endian registers).
+ * @param size Value size in bytes (even).
+ * @param order Register layout (MB_ORDER_ABCD to MB_ORDER_DCBA).
+ * @return uint8_t Byte index in the big-endian value.
+ */
+constexpr uint8_t registerImageByte(uint8_t ix, uint8_t size, uint8_t order) {
+  return ((order == MB_ORDER_CDAB || order == MB_ORDER_DCBA) ? size / 2 - 1 - ix / 2 : ix / 2) * 2 +
+         ((ix % 2) ^ ((order == MB_ORDER_BADC || order == MB_ORDER_DCBA) ? 1 : 0));
+}
+
+/**
+ * @brief Host byte of a value for a byte of its register image.
+ * @details Same mapping as the word order conversion of PDU, evaluated at compile time for every field.
+ * @param ix Byte index in the register image (big-endian registers).
+ * @param size Value size in bytes (even).
+ * @param order Register layout (MB_ORDER_*).
+ * @return uint8_t Byte index in host memory.
+ */
+constexpr uint8_t registerFieldByte(uint8_t ix, uint8_t size, uint8_t order) {
+  return order == MB_ORDER_HOST ? (hostIsBigEndian ? ix : ix ^ 1)
+                                : (hostIsBigEndian ? registerImageByte(ix, size, order) : size - 1 - registerImageByte(ix, size, order));
+}
+
+/**
+ * @struct RegisterCodecOf
+ * @brief Converts a value of whole registers between host and register image.
+ * @tparam T Value type (e.g. uint16_t, int32_t, float, double, or an array of them).
+ * @tparam ORDER Register layout (MB_ORDER_*).
+ * @tparam SIZE Value size in bytes.
+ */
+template <typename T, uint8_t ORDER, size_t SIZE = sizeof(T)>
+struct RegisterCodecOf {
+  static_assert(SIZE % 2 == 0 && SIZE < 256, "Register fields are whole registers or single bytes");
+  static_assert(ORDER <= MB_ORDER_DCBA, "Unknown word order");
+  static constexpr uint16_t registers = SIZE / 2;  ///< Registers of the value.
+
+  /**
+   * @brief Decodes a value from its registers.
+   * @param value Destination.
+   * @param src Register image (big-endian registers).
+   */
+  static void decode(T& value, const uint8_t* src) {
+    uint8_t* d = reinterpret_cast<uint8_t*>(&value);
+    for (uint8_t j = 0; j < SIZE; ++j) d[registerFieldByte(j, SIZE, ORDER)] = src[j];
+  }
+
+  /**
+   * @brief Encodes a value into its registers.
+   * @param value Source.
+   * @param dst Register image (big-endian registers).
+   */
+  static void encode(const T& value, uint8_t* dst) {
+    const uint8_t* s = reinterpret_cast<const uint8_t*>(&value);
+    for (uint8_t j = 0; j < SIZE; ++j) dst[j] = s[registerFieldByte(j, SIZE, ORDER)];
+  }
+};
+
+/**
+ * @struct RegisterCodecOf
+ * @brief Single byte value (e.g. uint8_t, int8_t, bool) held in the low byte of one register.
+ */
+template <typename T, uint8_t ORDER>
+struct RegisterCodecOf<T, ORDER, 1> {
+  static constexpr uint16_t registers = 1;  ///< Registers of the value.
+
+  static void decode(T& value, const uint8_t* src) { value = static_cast<T>(src[1]); }
+
+  static void encode(const T& value, uint8_t* dst) {
+    dst[0] = 0x00;
+    dst[1] = static_cast<uint8_t>(value);
+  }
+};
+
+/**
+ * @struct RegisterArrayCodec
+ * @brief Array of N values, its elements in consecutive registers.
+ */
+template <typename T, size_t N, uint8_t ORDER>
+struct RegisterArrayCodec {
+  typedef RegisterCodecOf<T, ORDER> Elem;                     ///< Codec of one element.
+  static constexpr uint16_t registers = N * Elem::registers;  ///< Registers of the array.
+
+  static void decode(T (&value)[N], const uint8_t* src) {
+    for (size_t i = 0; i < N; ++i) Elem::decode(value[i], src + i * Elem::registers * 2);
+  }
+
+  static void encode(const T (&value)[N], uint8_t* dst) {
+    for (size_t i = 0; i < N; ++i) Elem::encode(value[i], dst + i * Elem::registers * 2);
+  }
+};
+
+/**
+ * @struct RegisterCodecOf
+ * @brief Array member, its elements in consecutive registers.
+ */
+template <typename T, size_t N, uint8_t ORDER, size_t SIZE>
+struct RegisterCodecOf<T[N], ORDER, SIZE> : RegisterArrayCodec<T, N, ORDER> {};
+
+/**
+ * @struct RegisterCodecOf
+ * @brief Single byte array member, more specialized than both the array and the single byte codec.
+ */
+template <typename T, uint8_t ORDER>
+struct RegisterCodecOf<T[1], ORDER, 1> : RegisterArrayCodec<T, 1, ORDER> {};
+
+/**
+ * @struct RegisterField
+ * @brief Struct member stored at a register offset of the record.
+ * @tparam S Struct type.
+ * @tparam T Member type.
+ * @tparam MEMBER Pointer to the member.
+ * @tparam REG Register offset from the start of the record.
+ * @tparam ORDER Register layout of multi-register values (default: MB_ORDER_ABCD, high word first).
+ */
+template <typename S, typename T, T S::*MEMBER, uint16_t REG, uint8_t ORDER = MB_ORDER_ABCD>
+struct RegisterField {
+  typedef RegisterCodecOf<T, ORDER> Codec;                 ///< Value codec.
+  static constexpr uint16_t end = REG + Codec::registers;  ///< Register offset behind the field.
+
+  /**
+   * @brief Decodes the member from the record image.
+   * @param s Destination struct.
+   * @param src Record image (big-endian registers).
+   */
+  static void decode(S& s, const uint8_t* src) { Codec::decode(s.*MEMBER, src + REG * 2); }
+
+  /**
+   * @brief Encodes the member into the record image.
+   * @param s Source struct.
+   * @param dst Record image (big-endian registers).
+   */
+  static void encode(const S& s, uint8_t* dst) { Codec::encode(s.*MEMBER, dst + REG * 2); }
+};
+
+/**
+ * @struct RegisterBit
+ * @brief Struct member stored as one bit of a register, other bits of the register may hold other members.
+ * @tparam S Struct type.
+ * @tparam T Member type (bool or integral, 0 or 1).
+ * @tparam MEMBER Pointer to the member.
+ * @tparam REG Register offset from the start of the record.
+ * @tparam BIT Bit position in the register (0-15, 0 = LSB).
+ */
+template <typename S, typename T, T S::*MEMBER, uint16_t REG, uint8_t BIT>
+struct RegisterBit {
+  static_assert(BIT < 16, "Bit position exceeds the register");
+  static constexpr uint16_t end = REG + 1;                        ///< Register offset behind the field.
+  static constexpr uint16_t byte = REG * 2 + (BIT < 8 ? 1 : 0);  ///< Byte of the bit in the record image.
+  static constexpr uint8_t mask = 1 << (BIT % 8);                 ///< Mask of the bit in its byte.
+
+  static void decode(S& s, const uint8_t* src) { s.*MEMBER = static_cast<T>((src[byte] & mask) != 0); }
+
+  static void encode(const S& s, uint8_t* dst) {
+    if (s.*MEMBER) dst[byte] |= mask;
+  }
+};
+
+/**
+ * @struct RegisterSchemaEnd
+ * @brief Register count of a record, the largest end of its fields.
+ */
+template <typename... FIELDS>
+struct RegisterSchemaEnd {
+  static constexpr uint16_t value = 0;  ///< Registers of the record.
+};
+
+template <typename F, typename... FIELDS>
+struct RegisterSchemaEnd<F, FIELDS...> {
+  static constexpr uint16_t value = F::end > RegisterSchemaEnd<FIELDS...>::value ? F::end : RegisterSchemaEnd<FIELDS...>::value;
+};
+
+/**
+ * @struct RegisterSchema
+ * @brief Register image of a struct, built from field descriptors.
+ * @details Used with ModbusMaster::readRecord(), readInputRecord() and writeRecord(). Registers not covered by a
+ *          field are written as 0 and ignored on read. Fields must not overlap, except RegisterBit fields of one
+ *          register.
+ * @tparam S Struct type.
+ * @tparam FIELDS RegisterField and RegisterBit descriptors (see MB_FIELD, MB_FIELD_ORDER, MB_FIELD_BIT).
+ */
+template <typename S, typename... FIELDS>
+struct RegisterSchema {
+  typedef S type;                                                             ///< Struct type.
+  static constexpr uint16_t registers = RegisterSchemaEnd<FIELDS...>::value;  ///< Registers of the record.
+  static_assert(sizeof...(FIELDS) > 0, "A schema needs at least one field");
+
+  /**
+   * @brief Decodes a record image into the struct.
+   * @param s Destination struct.
+   * @param src Record image (big-endian registers, any alignment).
+   */
+  static void decode(S& s, const uint8_t* src) {
+    const int expand[] = {(FIELDS::decode(s, src), 0)...};
+    (void)expand;
+  }
+
+  /**
+   * @brief Encodes the struct into a record image.
+   * @param s Source struct.
+   * @param dst Record image (registers * 2 bytes, any alignment).
+   */
+  static void encode(const S& s, uint8_t* dst) {
+    memset(dst, 0, registers * 2);
+    const int expand[] = {(FIELDS::encode(s, dst), 0)...};
+    (void)expand;
+  }
+
+  /**
+   * @brief Type-erased decode() for the bound destination of a read request.
+   * @param dst Destination struct.
+   * @param src Record image.
+   */
+  static void decodeInto(uint8_t* dst, const uint8_t* src) { decode(*reinterpret_cast<S*>(dst), src); }
+};
+
+/**
+ * @def MB_FIELD(S, MEMBER, REG)
+ * @brief RegisterField of a member at a register offset, multi-register values high word first.
+ */
+#define MB_FIELD(S, MEMBER, REG) RegisterField<S, decltype(S::MEMBER), &S::MEMBER, REG>
+
+/**
+ * @def MB_FIELD_ORDER(S, MEMBER, REG, ORDER)
+ * @brief RegisterField of a member at a register offset with a register layout (MB_ORDER_*).
+ */
+#define MB_FIELD_ORDER(S, MEMBER, REG, ORDER) RegisterField<S, decltype(S::MEMBER), &S::MEMBER, REG, ORDER>
+
+/**
+ * @def MB_FIELD_BIT(S, MEMBER, REG, BIT)
+ * @brief RegisterBit of a member at a bit of a register.
+ */
+#define MB_FIELD_BIT(S, MEMBER, REG, BIT) RegisterBit<S, decltype(S::MEMBER), &S::MEMBER, REG, BIT>
@@ -0,0 +1,241 @@
+#include "RegisterStore.h"
+
+RegisterStore::RegisterStore() {}
+
+RegisterStore::~RegisterStore() {
+  if (_segments) {
+    for (uint8_t i = 0; i < _segmentCount; i++) {
+      delete[] _segments[i]._data;
+    }
+    delete[] _segments;
+  }
+  delete[] _entries;
+}
+
+uint16_t RegisterStore::begin(uint8_t segmentSize, uint16_t entrySize) {
+  if (_segments) return MB_EX_LIB_NOT_SUPPORTED;  // rangePtr() pointers may still be in use
+  _segmentSize = segmentSize;
+  _segments = new RegisterSegment[_segmentSize];
+  _entrySize = entrySize;
+  _entries = entrySize ? new RegisterEntry[_entrySize] : nullptr;
+  return MB_EX_SUCCESS;
+}
+
+uint32_t RegisterStore::key(uint8_t unit, uint8_t table, uint16_t address) {
+  return ((uint32_t)unit << 24) | ((uint32_t)table << 16) | address;
+}
+
+bool RegisterStore::isBitTable(uint8_t table) {
+  return table == MB_TABLE_COILS || table == MB_TABLE_DISCRETE_INPUTS;
+}
+
+void RegisterStore::copyBits(uint8_t* dst, uint16_t dstBit, const uint8_t* src, uint16_t srcBit, uint16_t count) {
+  if ((dstBit & 7) == 0 && (srcBit & 7) == 0) {  // Byte aligned: bulk copy whole bytes
+    const uint16_t bytes = count >> 3;
+    memcpy(dst + (dstBit >> 3), src + (srcBit >> 3), bytes);
+    dstBit += bytes << 3;
+    srcBit += bytes << 3;
+    count &= 7;
+  }
+  for (uint16_t i = 0; i < count; i++, dstBit++, srcBit++) {
+    if (src[srcBit >> 3] & (1 << (srcBit & 7))) {
+      dst[dstBit >> 3] |= 1 << (dstBit & 7);
+    } else {
+      dst[dstBit >> 3] &= ~(1 << (dstBit & 7));
+    }
+  }
+}
+
+RegisterSegment* RegisterStore::findSegment(uint32_t k, uint16_t& offset) const {
+  // Last segment starting at or before k
+  uint8_t lo = 0, hi = _segmentCount;
+  while (lo < hi) {
+    uint8_t mid = (lo + hi) / 2;
+    if (_segments[mid]._key <= k) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == 0) return nullptr;
+  RegisterSegment* seg = &_segments[lo - 1];
+  if ((seg->_key >> 16) != (k >> 16)) return nullptr;  // Other unit or table
+  const uint32_t off = k - seg->_key;
+  if (off >= seg->_quantity) return nullptr;
+  offset = off;
+  return seg;
+}
+
+RegisterEntry* RegisterStore::findEntry(uint32_t k) const {
+  uint16_t lo = 0, hi = _entryCount;
+  while (lo < hi) {
+    uint16_t mid = (lo + hi) / 2;
+    if (_entries[mid]._key < k) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo < _entryCount && _entries[lo]._key == k) return &_entries[lo];
+  return nullptr;
+}
+
+uint16_t RegisterStore::addRange(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity) {
+  if (table > MB_TABLE_HOLDING_REGISTERS || quantity == 0 || (uint32_t)address + quantity > 0x10000UL) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (_segmentCount >= _segmentSize) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  const uint32_t k = key(unit, table, address);
+  // Reject overlaps with segments and sparse entries
+  uint8_t pos = 0;
+  while (pos < _segmentCount && _segments[pos]._key < k) pos++;
+  if (pos > 0) {
+    const RegisterSegment& prev = _segments[pos - 1];
+    if ((prev._key >> 16) == (k >> 16) && prev._key + prev._quantity > k) return MB_EX_LIB_INVALID_ARGUMENT;
+  }
+  if (pos < _segmentCount && _segments[pos]._key < k + quantity) return MB_EX_LIB_INVALID_ARGUMENT;
+  for (uint16_t i = 0; i < _entryCount; i++) {
+    if (_entries[i]._key >= k && _entries[i]._key < k + quantity) return MB_EX_LIB_INVALID_ARGUMENT;
+  }
+  const uint32_t bytes = isBitTable(table) ? (quantity + 7) / 8 : quantity * 2UL;
+  if ((size_t)bytes != bytes) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;  // Not addressable on this platform
+  uint8_t* data = new uint8_t[bytes]();
+  if (!data) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  memmove(&_segments[pos + 1], &_segments[pos], (_segmentCount - pos) * sizeof(RegisterSegment));
+  _segments[pos]._key = k;
+  _segments[pos]._quantity = quantity;
+  _segments[pos]._data = data;
+  _segmentCount++;
+  return 0;
+}
+
+uint16_t RegisterStore::addAddress(uint8_t unit, uint8_t table, uint16_t address) {
+  if (table > MB_TABLE_HOLDING_REGISTERS) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (_entryCount >= _entrySize) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  const uint32_t k = key(unit, table, address);
+  uint16_t offset;
+  if (findSegment(k, offset) || findEntry(k)) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint16_t pos = _entryCount;
+  while (pos > 0 && _entries[pos - 1]._key > k) {  // Insertion keeps the index sorted
+    _entries[pos] = _entries[pos - 1];
+    pos--;
+  }
+  _entries[pos]._key = k;
+  _entries[pos]._value[0] = _entries[pos]._value[1] = 0;
+  _entryCount++;
+  return 0;
+}
+
+bool RegisterStore::contains(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity) const {
+  if ((uint32_t)address + quantity > 0x10000UL) return false;
+  uint32_t k = key(unit, table, address);
+  while (quantity) {
+    uint16_t offset;
+    const RegisterSegment* seg = findSegment(k, offset);
+    if (seg) {
+      uint16_t n = seg->_quantity - offset;
+      if (n > quantity) n = quantity;
+      k += n;
+      quantity -= n;
+    } else if (findEntry(k)) {
+      k++;
+      quantity--;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint16_t RegisterStore::transfer(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, uint8_t* buf, bool toStore) {
+  if (table > MB_TABLE_HOLDING_REGISTERS || quantity == 0) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (!contains(unit, table, address, quantity)) return MB_EX_ILLEGAL_DATA_ADDRESS;
+  const bool bits = isBitTable(table);
+  uint32_t k = key(unit, table, address);
+  uint16_t done = 0;
+  while (done < quantity) {
+    uint16_t offset;
+    RegisterSegment* seg = findSegment(k, offset);
+    if (seg) {
+      uint16_t n = seg->_quantity - offset;
+      if (n > quantity - done) n = quantity - done;
+      if (bits) {
+        if (toStore) {
+          copyBits(seg->_data, offset, buf, done, n);
+        } else {
+          copyBits(buf, done, seg->_data, offset, n);
+        }
+      } else if (toStore) {
+        memcpy(seg->_data + (size_t)offset * 2, buf + (size_t)done * 2, (size_t)n * 2);
+      } else {
+        memcpy(buf + (size_t)done * 2, seg->_data + (size_t)offset * 2, (size_t)n * 2);
+      }
+      k += n;
+      done += n;
+    } else {
+      RegisterEntry* entry = findEntry(k);
+      if (bits) {
+        if (toStore) {
+          entry->_value[0] = (buf[done >> 3] >> (done & 7)) & 1;
+        } else {
+          copyBits(buf, done, entry->_value, 0, 1);
+        }
+      } else if (toStore) {
+        memcpy(entry->_value, buf + (size_t)done * 2, 2);
+      } else {
+        memcpy(buf + (size_t)done * 2, entry->_value, 2);
+      }
+      k++;
+      done++;
+    }
+  }
+  if (bits && !toStore && (quantity & 7)) {
+    buf[quantity >> 3] &= (1 << (quantity & 7)) - 1;  // Unused bits of the last byte are zero
+  }
+  return 0;
+}
+
+uint16_t RegisterStore::read(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, uint8_t* dst) {
+  return transfer(unit, table, address, quantity, dst, false);
+}
+
+uint16_t RegisterStore::write(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, const uint8_t* src) {
+  return transfer(unit, table, address, quantity, const_cast<uint8_t*>(src), true);  // Not modified when toStore
+}
+
+uint8_t* RegisterStore::rangePtr(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity) const {
+  uint16_t offset;
+  RegisterSegment* seg = findSegment(key(unit, table, address), offset);
+  if (!seg || quantity == 0 || (uint32_t)offset + quantity > seg->_quantity) return nullptr;
+  if (isBitTable(table)) {
+    if (offset & 7) return nullptr;
+    return seg->_data + offset / 8;
+  }
+  return seg->_data + (size_t)offset * 2;
+}
+
+uint16_t RegisterStore::getRegister(uint8_t unit, uint8_t table, uint16_t address, uint16_t& value) {
+  if (isBitTable(table)) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint8_t buf[2];
+  uint16_t err = read(unit, table, address, 1, buf);
+  if (!err) value = ((uint16_t)buf[0] << 8) | buf[1];
+  return err;
+}
+
+uint16_t RegisterStore::setRegister(uint8_t unit, uint8_t table, uint16_t address, uint16_t value) {
+  if (isBitTable(table)) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint8_t buf[2] = {highByte(value), lowByte(value)};
+  return write(unit, table, address, 1, buf);
+}
+
+uint16_t RegisterStore::getBit(uint8_t unit, uint8_t table, uint16_t address, bool& value) {
+  if (!isBitTable(table)) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint8_t buf = 0;
+  uint16_t err = read(unit, table, address, 1, &buf);
+  if (!err) value = buf & 1;
+  return err;
+}
+
+uint16_t RegisterStore::setBit(uint8_t unit, uint8_t table, uint16_t address, bool value) {
+  if (!isBitTable(table)) return MB_EX_LIB_INVALID_ARGUMENT;
+  uint8_t buf = value ? 1 : 0;
+  return write(unit, table, address, 1, &buf);
+}
@@ -0,0 +1,231 @@
+/**
+ * @file RegisterStore.h
+ * @brief Register image addressed by unit, table and address.
+ * @details Stores coils, discrete inputs, input and holding registers of any number of units in wire format,
+ *          so PDU data can be copied in and out with memcpy. Shared by slave, cache and gateway features.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#include "ModbusDef.h"
+
+/**
+ * @class RegisterSegment
+ * @brief Contiguous address range of one unit and table.
+ * @details Registers are stored big-endian (wire format), bits are packed LSB first like in a PDU.
+ */
+class RegisterSegment {
+  friend class RegisterStore;  ///< Access to private members for lookup.
+
+ private:
+  uint32_t _key = 0;         ///< Sort key of the first address (unit, table, address).
+  uint16_t _quantity = 0;    ///< Number of registers or bits.
+  uint8_t* _data = nullptr;  ///< Wire format data.
+};
+
+/**
+ * @class RegisterEntry
+ * @brief Single scattered register or bit.
+ */
+class RegisterEntry {
+  friend class RegisterStore;  ///< Access to private members for lookup.
+
+ private:
+  uint32_t _key = 0;    ///< Sort key (unit, table, address).
+  uint8_t _value[2]{};  ///< Register value big-endian, or the bit in _value[0].
+};
+
+/**
+ * @class RegisterStore
+ * @brief Maps (unit, table, address) to values for dense and scattered address ranges.
+ * @details Dense ranges are kept in contiguous segments, scattered addresses in a sorted sparse index.
+ *          Both are sorted arrays searched in O(log n), ranges are copied segment by segment with memcpy.
+ *          Storage is allocated once in begin() and addRange(), lookups never allocate.
+ */
+class RegisterStore {
+ private:
+  RegisterSegment* _segments = nullptr;  ///< Segments sorted by key.
+  uint8_t _segmentSize = 0;              ///< Segment capacity.
+  uint8_t _segmentCount = 0;             ///< Segments in use.
+  RegisterEntry* _entries = nullptr;     ///< Sparse entries sorted by key.
+  uint16_t _entrySize = 0;               ///< Sparse entry capacity.
+  uint16_t _entryCount = 0;              ///< Sparse entries in use.
+
+  /**
+   * @brief Builds the sort key of an address.
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @return uint32_t Sort key.
+   */
+  static uint32_t key(uint8_t unit, uint8_t table, uint16_t address);
+
+  /**
+   * @brief Checks if a table holds bits.
+   * @param table Data table (MB_TABLE_*).
+   * @return bool True for coils and discrete inputs.
+   */
+  static bool isBitTable(uint8_t table);
+
+  /**
+   * @brief Copies bits between LSB-first packed buffers.
+   * @param dst Destination buffer.
+   * @param dstBit First destination bit.
+   * @param src Source buffer.
+   * @param srcBit First source bit.
+   * @param count Number of bits.
+   */
+  static void copyBits(uint8_t* dst, uint16_t dstBit, const uint8_t* src, uint16_t srcBit, uint16_t count);
+
+  /**
+   * @brief Finds the segment containing an address.
+   * @param k Sort key of the address.
+   * @param offset Filled with the offset of the address in the segment.
+   * @return RegisterSegment* Segment, or nullptr if the address is not in a segment.
+   */
+  RegisterSegment* findSegment(uint32_t k, uint16_t& offset) const;
+
+  /**
+   * @brief Finds a sparse entry.
+   * @param k Sort key of the address.
+   * @return RegisterEntry* Entry, or nullptr if not found.
+   */
+  RegisterEntry* findEntry(uint32_t k) const;
+
+  /**
+   * @brief Copies a range between the store and a wire format buffer.
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @param quantity Number of registers or bits.
+   * @param buf Wire format buffer.
+   * @param toStore True to write into the store, false to read from it.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t transfer(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, uint8_t* buf, bool toStore);
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an empty store.
+   */
+  RegisterStore();
+
+  /**
+   * @brief Destructor.
+   * @details Frees segment data and index arrays.
+   */
+  ~RegisterStore();
+
+  /**
+   * @brief Allocates the index arrays.
+   * @param segmentSize Maximum number of dense ranges.
+   * @param entrySize Maximum number of scattered addresses.
+   * @return uint16_t MB_EX_LIB_NOT_SUPPORTED if already started, 0 otherwise.
+   */
+  uint16_t begin(uint8_t segmentSize, uint16_t entrySize);
+
+  /**
+   * @brief Adds a dense address range, initialized to zero.
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @param quantity Number of registers or bits.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t addRange(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity);
+
+  /**
+   * @brief Adds a single scattered address, initialized to zero.
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Address.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t addAddress(uint8_t unit, uint8_t table, uint16_t address);
+
+  /**
+   * @brief Checks if every address of a range is stored.
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @param quantity Number of registers or bits.
+   * @return bool True if the whole range is stored.
+   */
+  bool contains(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity) const;
+
+  /**
+   * @brief Reads a range in wire format (big-endian registers, LSB-first packed bits).
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @param quantity Number of registers or bits.
+   * @param dst Destination buffer (2 * quantity or (quantity + 7) / 8 bytes).
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t read(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, uint8_t* dst);
+
+  /**
+   * @brief Writes a range from wire format (big-endian registers, LSB-first packed bits).
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @param quantity Number of registers or bits.
+   * @param src Source buffer (2 * quantity or (quantity + 7) / 8 bytes).
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t write(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, const uint8_t* src);
+
+  /**
+   * @brief Returns the stored wire format data of a range without copying.
+   * @details Available if the range lies in one segment; for bit tables the range must start on a byte boundary
+   *          of the segment.
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @param quantity Number of registers or bits.
+   * @return uint8_t* Pointer into the segment, or nullptr if not available.
+   */
+  uint8_t* rangePtr(uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity) const;
+
+  /**
+   * @brief Reads a single register.
+   * @param unit Unit ID.
+   * @param table MB_TABLE_INPUT_REGISTERS or MB_TABLE_HOLDING_REGISTERS.
+   * @param address Address.
+   * @param value Filled with the register value.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t getRegister(uint8_t unit, uint8_t table, uint16_t address, uint16_t& value);
+
+  /**
+   * @brief Writes a single register.
+   * @param unit Unit ID.
+   * @param table MB_TABLE_INPUT_REGISTERS or MB_TABLE_HOLDING_REGISTERS.
+   * @param address Address.
+   * @param value Register value.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t setRegister(uint8_t unit, uint8_t table, uint16_t address, uint16_t value);
+
+  /**
+   * @brief Reads a single bit.
+   * @param unit Unit ID.
+   * @param table MB_TABLE_COILS or MB_TABLE_DISCRETE_INPUTS.
+   * @param address Address.
+   * @param value Filled with the bit value.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t getBit(uint8_t unit, uint8_t table, uint16_t address, bool& value);
+
+  /**
+   * @brief Writes a single bit.
+   * @param unit Unit ID.
+   * @param table MB_TABLE_COILS or MB_TABLE_DISCRETE_INPUTS.
+   * @param address Address.
+   * @param value Bit value.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t setBit(uint8_t unit, uint8_t table, uint16_t address, bool value);
+};
@@ -0,0 +1,270 @@
+#include "RequestCoalescer.h"
+
+#include "ModbusUtility.h"
+#include "PDU.h"
+
+RequestCoalescer::RequestCoalescer() {}
+
+void RequestCoalescer::setReadCoalescing(bool enable, uint16_t maxGap) {
+  _readEnabled = enable;
+  _readGap = maxGap;
+}
+
+void RequestCoalescer::setWriteCoalescing(bool enable) { _writeEnabled = enable; }
+
+void RequestCoalescer::setCoilWriteCoalescing(bool enable, uint16_t holdMs) {
+  _coilEnabled = enable;
+  _coilHold = holdMs;
+}
+
+void RequestCoalescer::setDeduplication(bool enable) { _dedupEnabled = enable; }
+
+void RequestCoalescer::setWriteReadFusion(bool enable, const Slaves& slaves) {
+  _fuseEnabled = enable;
+  _fuseSlaves = slaves;
+}
+
+void RequestCoalescer::setMaskWriteCoalescing(bool enable) { _maskEnabled = enable; }
+
+bool RequestCoalescer::attach(PDU* leader, PDU* pdu) const {
+  if (!_dedupEnabled || !leader || leader == pdu || !leader->_used || leader->_completing) return false;
+  if (!isRead(leader) || !isRead(pdu) || leader->isRepeating() || pdu->isRepeating()) return false;
+  if (slaveOf(leader) != slaveOf(pdu) || leader->_TXPDUbuffer[0] != pdu->_TXPDUbuffer[0]) return false;
+  // Range on the wire, possibly widened by coalescing
+  const uint32_t lo = (leader->_TXPDUbuffer[1] << 8) | leader->_TXPDUbuffer[2];
+  const uint32_t hi = lo + ((leader->_TXPDUbuffer[3] << 8) | leader->_TXPDUbuffer[4]);
+  if (pdu->_reqAddr < lo || (uint32_t)pdu->_reqAddr + pdu->_reqQty > hi) return false;
+  append(leader, pdu);
+  return true;
+}
+
+bool RequestCoalescer::isRead(const PDU* pdu) {
+  if (pdu->_raw || pdu->_context) return false;  // Requests of a higher layer (gateway, block transfer) keep their size
+  const uint8_t fn = pdu->_TXPDUbuffer[0];
+  return fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS ||
+         fn == MB_FC_READ_HOLDING_REGISTERS || fn == MB_FC_READ_INPUT_REGISTERS;
+}
+
+bool RequestCoalescer::isRegisterWrite(const PDU* pdu) {
+  if (pdu->_raw || pdu->_context || pdu->_payload || pdu->isRepeating()) return false;  // Referenced data is not in the TX buffer
+  const uint8_t fn = pdu->_TXPDUbuffer[0];
+  return fn == MB_FC_WRITE_SINGLE_REGISTER || fn == MB_FC_WRITE_MULTIPLE_REGISTERS;
+}
+
+const uint8_t* RequestCoalescer::writeRange(const PDU* pdu, uint16_t& addr, uint16_t& qty) {
+  const uint8_t* tx = pdu->_TXPDUbuffer;
+  addr = (tx[1] << 8) | tx[2];
+  if (tx[0] == MB_FC_WRITE_SINGLE_REGISTER) {
+    qty = 1;
+    return tx + 3;
+  }
+  qty = (tx[3] << 8) | tx[4];
+  return tx + 6;
+}
+
+bool RequestCoalescer::isCoilWrite(const PDU* pdu) {
+  if (pdu->_raw || pdu->_context || pdu->_payload || pdu->isRepeating()) return false;
+  const uint8_t fn = pdu->_TXPDUbuffer[0];
+  return fn == MB_FC_WRITE_SINGLE_COIL || fn == MB_FC_WRITE_MULTIPLE_COILS;
+}
+
+bool RequestCoalescer::isMaskWrite(const PDU* pdu) {
+  if (pdu->_raw || pdu->_context || pdu->isRepeating()) return false;
+  return pdu->_TXPDUbuffer[0] == MB_FC_MASK_WRITE_REGISTER;
+}
+
+bool RequestCoalescer::isHeld(PDU* pdu) const {
+  return isCoilWrite(pdu) && !on_ms(&pdu->_queuedTime, _coilHold, false);
+}
+
+void RequestCoalescer::copyBits(uint8_t* dst, uint16_t dstBit, const uint8_t* src, uint16_t srcBit, uint16_t count) {
+  const bool down = dst == src && dstBit > srcBit;
+  for (uint16_t n = 0; n < count; n++) {
+    const uint16_t i = down ? count - 1 - n : n;
+    const uint16_t s = srcBit + i;
+    const uint16_t d = dstBit + i;
+    if (src[s >> 3] & (1 << (s & 7))) {
+      dst[d >> 3] |= 1 << (d & 7);
+    } else {
+      dst[d >> 3] &= ~(1 << (d & 7));
+    }
+  }
+}
+
+uint8_t RequestCoalescer::slaveOf(const PDU* pdu) { return pdu->getSlaveId(); }
+
+bool RequestCoalescer::isBarrier(const PDU* other, const PDU* pdu) {
+  return other && slaveOf(other) == slaveOf(pdu) && !isRead(other);
+}
+
+bool RequestCoalescer::isReady(PDU* pdu) {
+  return on_ms(&pdu->_queuedTime, pdu->_delayToSend, false);
+}
+
+bool RequestCoalescer::merge(PDU* leader, PDU* pdu, bool& barrier) const {
+  if (isRead(leader) && isRead(pdu)) {
+    // A read that cannot be merged does not block the others, reads do not change the slave
+    return _readEnabled && isReady(pdu) && mergeRead(leader, pdu);
+  }
+  if (_writeEnabled && isRegisterWrite(leader) && isRegisterWrite(pdu) && isReady(pdu) && mergeRegisterWrite(leader, pdu)) {
+    return true;
+  }
+  if (_coilEnabled && isCoilWrite(leader) && isCoilWrite(pdu) && mergeCoilWrite(leader, pdu)) {
+    return true;  // Coil writes never carry a send delay, only the first one of a burst is held
+  }
+  if (_maskEnabled && isMaskWrite(leader) && isMaskWrite(pdu) && isReady(pdu) && mergeMaskWrite(leader, pdu)) {
+    return true;
+  }
+  barrier = true;
+  return false;
+}
+
+void RequestCoalescer::append(PDU* leader, PDU* pdu) {
+  // Completion is delivered in queue order
+  PDU* last = leader;
+  while (last->_merged) last = last->_merged;
+  last->_merged = pdu;
+}
+
+bool RequestCoalescer::mergeRead(PDU* leader, PDU* pdu) const {
+  const uint8_t fn = leader->_TXPDUbuffer[0];
+  if (pdu->_TXPDUbuffer[0] != fn || pdu->_merged) return false;
+  const bool bits = fn == MB_FC_READ_COILS || fn == MB_FC_READ_DISCRETE_INPUTS;
+  // Covering range currently requested by the leader
+  const uint32_t lo = (leader->_TXPDUbuffer[1] << 8) | leader->_TXPDUbuffer[2];
+  const uint32_t hi = lo + ((leader->_TXPDUbuffer[3] << 8) | leader->_TXPDUbuffer[4]);
+  const uint32_t a = pdu->_reqAddr;
+  const uint32_t b = a + pdu->_reqQty;
+  const uint32_t gap = a > hi ? a - hi : (lo > b ? lo - b : 0);
+  if (gap > (bits ? (uint32_t)_readGap * 16 : _readGap)) return false;
+  const uint32_t newLo = a < lo ? a : lo;
+  const uint32_t newHi = b > hi ? b : hi;
+  const uint32_t qty = newHi - newLo;
+  const uint32_t bytes = bits ? (qty + 7) / 8 : qty * 2;
+  if (qty > (bits ? (uint32_t)MB_MAX_READ_COILS : (uint32_t)MB_MAX_READ_REGISTERS)) return false;
+  if (2 + bytes > leader->_PDUSize) return false;  // Merged response must fit the leader
+  leader->_TXPDUbuffer[1] = highByte(newLo);
+  leader->_TXPDUbuffer[2] = lowByte(newLo);
+  leader->_TXPDUbuffer[3] = highByte(qty);
+  leader->_TXPDUbuffer[4] = lowByte(qty);
+  leader->_PDUresponseHead[1] = bytes;
+  leader->_expectedResponseLen = 2 + bytes;
+  append(leader, pdu);
+  return true;
+}
+
+bool RequestCoalescer::mergeRegisterWrite(PDU* leader, PDU* pdu) {
+  if (pdu->_merged) return false;
+  uint16_t lo, loQty, a, aQty;
+  writeRange(leader, lo, loQty);
+  const uint8_t* src = writeRange(pdu, a, aQty);
+  const uint32_t hi = (uint32_t)lo + loQty;
+  const uint32_t b = (uint32_t)a + aQty;
+  if (a > hi || b < lo) return false;  // Neither contiguous nor overlapping
+  const uint16_t newLo = a < lo ? a : lo;
+  const uint32_t qty = (b > hi ? b : hi) - newLo;
+  if (qty > MB_MAX_WRITE_REGISTERS || 6 + qty * 2 > leader->_PDUSize) return false;
+  uint8_t* tx = leader->_TXPDUbuffer;
+  if (tx[0] == MB_FC_WRITE_SINGLE_REGISTER) {  // Rewrite as FC 0x10 with one register
+    tx[6] = tx[3];
+    tx[7] = tx[4];
+    tx[0] = MB_FC_WRITE_MULTIPLE_REGISTERS;
+  }
+  if (newLo < lo) memmove(tx + 6 + (lo - newLo) * 2, tx + 6, loQty * 2);
+  memcpy(tx + 6 + (a - newLo) * 2, src, aQty * 2);  // Later write wins
+  tx[1] = highByte(newLo);
+  tx[2] = lowByte(newLo);
+  tx[3] = highByte(qty);
+  tx[4] = lowByte(qty);
+  tx[5] = qty * 2;
+  leader->_TXPDUbufferLen = 6 + qty * 2;
+  // Validated by the normal FC 0x10 path in PDU::invoke(), merged requests complete in callCallback()
+  memcpy(leader->_PDUresponseHead, tx, 5);
+  leader->_expectedResponseLen = 5;
+  append(leader, pdu);
+  return true;
+}
+
+bool RequestCoalescer::mergeCoilWrite(PDU* leader, PDU* pdu) {
+  if (pdu->_merged) return false;
+  uint8_t* tx = leader->_TXPDUbuffer;
+  const uint8_t* ptx = pdu->_TXPDUbuffer;
+  const uint16_t lo = (tx[1] << 8) | tx[2];
+  const uint16_t loQty = tx[0] == MB_FC_WRITE_SINGLE_COIL ? 1 : (tx[3] << 8) | tx[4];
+  const uint16_t a = (ptx[1] << 8) | ptx[2];
+  const uint16_t aQty = ptx[0] == MB_FC_WRITE_SINGLE_COIL ? 1 : (ptx[3] << 8) | ptx[4];
+  const uint32_t hi = (uint32_t)lo + loQty;
+  const uint32_t b = (uint32_t)a + aQty;
+  if (a > hi || b < lo) return false;  // Only contiguous runs, coils in a gap would be overwritten
+  const uint16_t newLo = a < lo ? a : lo;
+  const uint32_t qty = (b > hi ? b : hi) - newLo;
+  const uint8_t bytes = (qty + 7) / 8;
+  if (qty > MB_MAX_WRITE_COILS || 6 + bytes > leader->_PDUSize) return false;
+  if (tx[0] == MB_FC_WRITE_SINGLE_COIL) {  // Rewrite as FC 0x0F with one coil
+    tx[6] = tx[3] == 0xFF ? 0x01 : 0x00;
+    tx[0] = MB_FC_WRITE_MULTIPLE_COILS;
+  }
+  if (newLo < lo) copyBits(tx + 6, lo - newLo, tx + 6, 0, loQty);
+  if (ptx[0] == MB_FC_WRITE_SINGLE_COIL) {  // Later write wins
+    const uint8_t value = ptx[3] == 0xFF ? 0x01 : 0x00;
+    copyBits(tx + 6, a - newLo, &value, 0, 1);
+  } else {
+    copyBits(tx + 6, a - newLo, ptx + 6, 0, aQty);
+  }
+  if (qty % 8) tx[5 + bytes] &= (1 << (qty % 8)) - 1;  // Unused bits of the last byte are zero
+  tx[1] = highByte(newLo);
+  tx[2] = lowByte(newLo);
+  tx[3] = highByte(qty);
+  tx[4] = lowByte(qty);
+  tx[5] = bytes;
+  leader->_TXPDUbufferLen = 6 + bytes;
+  memcpy(leader->_PDUresponseHead, tx, 5);
+  leader->_expectedResponseLen = 5;
+  append(leader, pdu);
+  return true;
+}
+
+bool RequestCoalescer::mergeMaskWrite(PDU* leader, PDU* pdu) {
+  uint8_t* tx = leader->_TXPDUbuffer;
+  const uint8_t* ptx = pdu->_TXPDUbuffer;
+  if (pdu->_merged || tx[1] != ptx[1] || tx[2] != ptx[2]) return false;  // Another register ends the merge
+  const uint16_t andMask = (ptx[3] << 8) | ptx[4];
+  const uint16_t orMask = (ptx[5] << 8) | ptx[6];
+  const uint16_t leaderAnd = ((tx[3] << 8) | tx[4]) & andMask;
+  const uint16_t leaderOr = ((((tx[5] << 8) | tx[6]) & andMask) | (orMask & ~andMask));
+  tx[3] = highByte(leaderAnd);
+  tx[4] = lowByte(leaderAnd);
+  tx[5] = highByte(leaderOr);
+  tx[6] = lowByte(leaderOr);
+  memcpy(leader->_PDUresponseHead, tx, 7);  // The slave echoes the request
+  append(leader, pdu);
+  return true;
+}
+
+bool RequestCoalescer::fuse(PDU* leader, PDU* pdu) const {
+  if (!_fuseEnabled || leader->_fused || leader->_merged || !isRegisterWrite(leader) || !_fuseSlaves.isSet(slaveOf(leader))) {
+    return false;  // A merged write restores no single original request
+  }
+  if (!isRead(pdu) || pdu->_TXPDUbuffer[0] != MB_FC_READ_HOLDING_REGISTERS || !isReady(pdu)) return false;
+  uint16_t addr, qty;
+  const uint8_t* src = writeRange(leader, addr, qty);
+  const uint8_t bytes = qty * 2;
+  const uint8_t readBytes = pdu->_PDUresponseHead[1];
+  if (qty > MB_MAX_WRITE_READ_REGISTERS || 10 + bytes > leader->_PDUSize || 2 + readBytes > leader->_PDUSize) return false;
+  uint8_t* tx = leader->_TXPDUbuffer;
+  leader->_fusedFn = tx[0];
+  memmove(tx + 10, src, bytes);
+  tx[0] = MB_FC_READ_AND_WRITE_REGISTERS;
+  memcpy(tx + 1, pdu->_TXPDUbuffer + 1, 4);  // Read address and quantity
+  tx[5] = highByte(addr);
+  tx[6] = lowByte(addr);
+  tx[7] = highByte(qty);
+  tx[8] = lowByte(qty);
+  tx[9] = bytes;
+  leader->_TXPDUbufferLen = 10 + bytes;
+  leader->_PDUresponseHead[0] = MB_FC_READ_AND_WRITE_REGISTERS;
+  leader->_PDUresponseHead[1] = readBytes;
+  leader->_expectedResponseLen = 2 + readBytes;
+  leader->_fused = pdu;
+  return true;
+}
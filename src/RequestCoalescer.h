@@ -0,0 +1,323 @@
+/**
+ * @file RequestCoalescer.h
+ * @brief Merges queued requests to the same slave into fewer transactions.
+ * @details Attached to a master with ModbusMaster::setCoalescer(), used by ModbusRTUMaster and ClientItem when an ADU
+ *          is taken from the queue for sending.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#include "ADUQueue.h"
+#include "ModbusDef.h"
+#include "Slaves.h"
+
+class PDU;
+
+/**
+ * @class RequestCoalescer
+ * @brief Merges queued requests of the same slave into one transaction.
+ * @details The ADU about to be sent becomes the leader, mergeable ADUs are taken out of the queue and chained to it.
+ *          Reads of the same function code become one covering read, the response is sliced into the view every
+ *          original request expects. Contiguous or overlapping register writes (FC 0x06/0x10) become one FC 0x10,
+ *          later writes overwrite earlier ones register by register, coil writes (FC 0x05/0x0F) likewise become one
+ *          FC 0x0F. Scanning stops at the first request to the same slave that cannot be merged, so requests never
+ *          overtake each other on the same data. A register write followed by a holding register read may be fused
+ *          into one FC 0x17 request, which writes before it reads.
+ *          Mask writes (FC 0x16) to the same register are composed into one AND/OR mask pair in queue order.
+ */
+class RequestCoalescer {
+ private:
+  bool _readEnabled = false;  ///< Read coalescing enabled.
+  uint16_t _readGap = 0;      ///< Max unused registers between merged reads.
+  bool _writeEnabled = false; ///< Register write coalescing enabled.
+  bool _coilEnabled = false;  ///< Coil write coalescing enabled.
+  uint16_t _coilHold = 0;     ///< Time a coil write waits for others to merge (ms).
+  bool _dedupEnabled = false; ///< Attach reads to identical queued or in-flight reads.
+  bool _fuseEnabled = false;  ///< Fuse a register write and the following read into FC 0x17.
+  bool _maskEnabled = false;  ///< Compose mask writes to the same register.
+  Slaves _fuseSlaves;         ///< Slaves known to support FC 0x17.
+
+  /**
+   * @brief Checks if a request is a plain read that may take part in coalescing.
+   * @param pdu Request to check.
+   * @return bool True for read coils, discrete inputs, holding or input registers.
+   */
+  static bool isRead(const PDU* pdu);
+
+  /**
+   * @brief Checks if a request is a register write that may take part in coalescing.
+   * @param pdu Request to check.
+   * @return bool True for FC 0x06 and FC 0x10 requests to a single slave.
+   */
+  static bool isRegisterWrite(const PDU* pdu);
+
+  /**
+   * @brief Returns the registers written by a FC 0x06 or FC 0x10 request.
+   * @param pdu Register write request.
+   * @param addr Set to the first register address.
+   * @param qty Set to the number of registers.
+   * @return const uint8_t* Big-endian register values in the TX buffer.
+   */
+  static const uint8_t* writeRange(const PDU* pdu, uint16_t& addr, uint16_t& qty);
+
+  /**
+   * @brief Checks if a request is a coil write that may take part in coalescing.
+   * @param pdu Request to check.
+   * @return bool True for FC 0x05 and FC 0x0F requests to a single slave.
+   */
+  static bool isCoilWrite(const PDU* pdu);
+
+  /**
+   * @brief Checks if a request is a mask write that may take part in coalescing.
+   * @param pdu Request to check.
+   * @return bool True for FC 0x16 requests to a single slave.
+   */
+  static bool isMaskWrite(const PDU* pdu);
+
+  /**
+   * @brief Copies bits between LSB-first packed buffers.
+   * @details Copies downwards when moving bits up within one buffer, like memmove().
+   * @param dst Destination buffer.
+   * @param dstBit First destination bit.
+   * @param src Source buffer.
+   * @param srcBit First source bit.
+   * @param count Number of bits.
+   */
+  static void copyBits(uint8_t* dst, uint16_t dstBit, const uint8_t* src, uint16_t srcBit, uint16_t count);
+
+  /**
+   * @brief Returns the slave ID of a request.
+   * @param pdu Request (ADURTU or ADUTCP).
+   * @return uint8_t Slave ID.
+   */
+  static uint8_t slaveOf(const PDU* pdu);
+
+  /**
+   * @brief Checks if a queued request may be sent now.
+   * @param pdu Queued request.
+   * @return bool True if its send delay has passed.
+   */
+  static bool isReady(PDU* pdu);
+
+  /**
+   * @brief Merges a read into the leader if the covering range stays within the limits.
+   * @param leader Request about to be sent (possibly already merged).
+   * @param pdu Queued read of the same slave.
+   * @return bool True if merged, false if the leader is unchanged.
+   */
+  bool mergeRead(PDU* leader, PDU* pdu) const;
+
+  /**
+   * @brief Merges a register write into the leader if the ranges touch or overlap.
+   * @details Turns the leader into a FC 0x10 request covering both ranges, the values of pdu win.
+   * @param leader Request about to be sent (possibly already merged).
+   * @param pdu Queued register write of the same slave.
+   * @return bool True if merged, false if the leader is unchanged.
+   */
+  static bool mergeRegisterWrite(PDU* leader, PDU* pdu);
+
+  /**
+   * @brief Merges a coil write into the leader if the ranges touch or overlap.
+   * @details Turns the leader into a FC 0x0F request covering both ranges, the values of pdu win.
+   *          Coils outside both ranges are never written, so no shadow state is needed.
+   * @param leader Request about to be sent (possibly already merged).
+   * @param pdu Queued coil write of the same slave.
+   * @return bool True if merged, false if the leader is unchanged.
+   */
+  static bool mergeCoilWrite(PDU* leader, PDU* pdu);
+
+  /**
+   * @brief Composes a mask write to the same register into the leader.
+   * @details The leader masks become (and1 & and2, (or1 & and2) | (or2 & ~and2)), which gives the same result as
+   *          applying both requests one after the other.
+   * @param leader Mask write about to be sent (possibly already merged).
+   * @param pdu Queued mask write of the same slave.
+   * @return bool True if merged, false if the leader is unchanged.
+   */
+  static bool mergeMaskWrite(PDU* leader, PDU* pdu);
+
+  /**
+   * @brief Fuses a register write and the holding register read queued right behind it into one FC 0x17 request.
+   * @details The leader is rewritten in place and restored before its callback, the read keeps its request and
+   *          receives the read data on completion.
+   * @param leader Register write about to be sent, not merged with others.
+   * @param pdu Next queued request of the same slave.
+   * @return bool True if fused.
+   */
+  bool fuse(PDU* leader, PDU* pdu) const;
+
+  /**
+   * @brief Checks if a coil write is still inside its hold window.
+   * @param pdu Request at the head of the queue.
+   * @return bool True if it must wait.
+   */
+  bool isHeld(PDU* pdu) const;
+
+  /**
+   * @brief Finds the ADU readReady() takes: the ready one with the smallest send delay that is not held.
+   * @tparam T ADU type (ADURTU or ADUTCP).
+   * @param queue Queue of the bus or connection.
+   * @return uint8_t Queue index, or 255 if none.
+   */
+  template <typename T>
+  uint8_t findReady(const ADUQueue<T>& queue) const;
+
+  /**
+   * @brief Appends a merged request to the chain of the leader.
+   * @param leader Request about to be sent.
+   * @param pdu Merged request.
+   */
+  static void append(PDU* leader, PDU* pdu);
+
+  /**
+   * @brief Tries to merge a queued request into the leader.
+   * @details Requests still waiting for their send delay are never merged, but still act as barriers.
+   * @param leader Request about to be sent.
+   * @param pdu Queued request of the same slave.
+   * @param barrier Set to true if scanning must stop at this request.
+   * @return bool True if merged.
+   */
+  bool merge(PDU* leader, PDU* pdu, bool& barrier) const;
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Coalescing is disabled.
+   */
+  RequestCoalescer();
+
+  /**
+   * @brief Merges queued reads of the same slave and function code into one covering read.
+   * @details When a read is sent, ready reads queued behind it for the same slave are folded in if the covering range
+   *          wastes at most maxGap registers. Every callback still receives exactly the values it asked for.
+   *          A queued write to the slave ends the merge, so reads never overtake writes.
+   * @param enable True to merge reads (default: disabled).
+   * @param maxGap Max unused registers between merged ranges (bit reads: maxGap * 16 bits, default: 8).
+   */
+  void setReadCoalescing(bool enable, uint16_t maxGap = 8);
+
+  /**
+   * @brief Merges queued register writes of the same slave into one FC 0x10 request.
+   * @details When a FC 0x06 or FC 0x10 write is sent, ready writes queued behind it to contiguous or overlapping
+   *          registers are folded in, the most recent value wins per register. Every callback is completed with the
+   *          result of the merged request. Requests sent to a Slaves set are never merged, any other queued request
+   *          to the slave (e.g. a read) ends the merge, so ordering against reads is kept.
+   * @param enable True to merge writes (default: disabled).
+   */
+  void setWriteCoalescing(bool enable);
+
+  /**
+   * @brief Merges queued coil writes of the same slave into one FC 0x0F request.
+   * @details When a FC 0x05 or FC 0x0F write is sent, writes queued behind it to contiguous or overlapping coils are
+   *          folded in, the most recent value wins per coil. Coils between two separate runs are never written.
+   *          With a hold window, a coil write and later requests to its slave wait up to holdMs so a burst can gather,
+   *          the wait ends early when the queue is full. Ordering rules are the same as for setWriteCoalescing().
+   * @param enable True to merge coil writes (default: disabled).
+   * @param holdMs Hold window in ms (default: 0, merge only what is already queued).
+   */
+  void setCoilWriteCoalescing(bool enable, uint16_t holdMs = 0);
+
+  /**
+   * @brief Serves a read from an identical read that is already queued or awaiting its response.
+   * @details A read of the same slave and function code whose range is covered by a pending request is not sent,
+   *          its callback is called with the response of the pending request, decoded with its own type T.
+   *          Reads issued from within the callback of the pending request start a new transaction.
+   * @param enable True to deduplicate reads (default: disabled).
+   */
+  void setDeduplication(bool enable);
+
+  /**
+   * @brief Fuses a register write and the holding register read queued right behind it into one FC 0x17 request.
+   * @details When a FC 0x06 or FC 0x10 write (not merged by setWriteCoalescing()) is sent and the next queued
+   *          request to the same slave is a ready FC 0x03 read, both are sent as one read/write transaction.
+   *          FC 0x17 writes before it reads, so the read still sees the written values. Both callbacks complete
+   *          individually, the write first. Only slaves listed in slaves are fused, as FC 0x17 is optional.
+   * @param enable True to fuse (default: disabled).
+   * @param slaves Slaves that support FC 0x17.
+   */
+  void setWriteReadFusion(bool enable, const Slaves& slaves);
+
+  /**
+   * @brief Composes queued mask writes to the same register into one FC 0x16 request.
+   * @details When a mask write is sent, ready mask writes queued behind it to the same slave and register are folded
+   *          in, the result equals applying them in queue order. Every callback is completed with the result of the
+   *          merged request. Any other request to the slave ends the merge.
+   * @param enable True to merge mask writes (default: disabled).
+   */
+  void setMaskWriteCoalescing(bool enable);
+
+  /**
+   * @brief Attaches a new read to a queued or in-flight request whose wire range covers it.
+   * @details The new read is not queued, it completes with the response of the other request and decodes it
+   *          with its own element type.
+   * @param leader Queued or in-flight request (may be nullptr).
+   * @param pdu New read, not queued yet.
+   * @return bool True if attached.
+   */
+  bool attach(PDU* leader, PDU* pdu) const;
+
+  /**
+   * @brief Attaches a new read to the in-flight ADU or one of the queued ADUs.
+   * @details Only reads issued after the last queued write (or other non-read request) to the slave qualify.
+   * @tparam T ADU type (ADURTU or ADUTCP).
+   * @param pdu New read, not queued yet.
+   * @param current ADU awaiting its response (may be nullptr).
+   * @param queue Queue of pending ADUs.
+   * @return bool True if attached, the caller must not queue pdu.
+   */
+  template <typename T>
+  bool deduplicate(PDU* pdu, T* current, const ADUQueue<T>& queue) const;
+
+  /**
+   * @brief Checks if a request other than a read to the slave of pdu is queued.
+   * @details In-flight reads are older than such a request and must not serve pdu.
+   * @tparam T ADU type (ADURTU or ADUTCP).
+   * @param pdu New read, not queued yet.
+   * @param queue Queue of pending ADUs.
+   * @return bool True if a write (or any non-read request) to the slave is queued.
+   */
+  template <typename T>
+  bool hasQueuedBarrier(const PDU* pdu, const ADUQueue<T>& queue) const;
+
+  /**
+   * @brief Checks if a request keeps a later read to its slave from being served by earlier reads.
+   * @param other Request queued or in flight before pdu.
+   * @param pdu New read.
+   * @return bool True if other is a request other than a read to the slave of pdu.
+   */
+  static bool isBarrier(const PDU* other, const PDU* pdu);
+
+  /**
+   * @brief Merges queued requests into the ADU about to be sent.
+   * @tparam T ADU type (ADURTU or ADUTCP).
+   * @param leader ADU taken from the queue.
+   * @param queue Queue holding the remaining ADUs.
+   * @return uint8_t Number of merged ADUs.
+   */
+  template <typename T>
+  uint8_t coalesce(T* leader, ADUQueue<T>& queue) const;
+
+  /**
+   * @brief Takes the next ready ADU from the queue, skipping coil writes inside their hold window.
+   * @details Requests to the slave of a held coil write wait behind it, all others are sent. The hold ends early
+   *          when the queue is full.
+   * @tparam T ADU type (ADURTU or ADUTCP).
+   * @param queue Queue of the bus or connection.
+   * @param item Output: the ADU to send.
+   * @return bool True if an ADU was taken.
+   */
+  template <typename T>
+  bool readReady(ADUQueue<T>& queue, T*& item) const;
+
+  /**
+   * @brief Checks if readReady() would take an ADU.
+   * @tparam T ADU type (ADURTU or ADUTCP).
+   * @param queue Queue of the bus or connection.
+   * @return bool True if an ADU is ready to send.
+   */
+  template <typename T>
+  bool hasReady(const ADUQueue<T>& queue) const;
+};
+
+#include "RequestCoalescer.tpp"
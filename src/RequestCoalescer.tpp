@@ -0,0 +1,85 @@
+#pragma once
+#include "RequestCoalescer.h"
+
+template <typename T>
+uint8_t RequestCoalescer::coalesce(T* leader, ADUQueue<T>& queue) const {
+  if ((!_readEnabled && !_writeEnabled && !_coilEnabled && !_fuseEnabled && !_maskEnabled) || !leader) return 0;
+  const uint8_t slave = slaveOf(leader);
+  uint8_t merged = 0;
+  for (uint8_t i = 0; i < queue.count();) {
+    T* pdu = queue.at(i);
+    if (!pdu || slaveOf(pdu) != slave) {
+      i++;
+      continue;
+    }
+    bool barrier = false;
+    if (merge(leader, pdu, barrier)) {
+      queue.removeAt(i);
+      merged++;
+      continue;
+    }
+    if (barrier) {  // Keep the order of requests to the slave
+      if (fuse(leader, pdu)) {
+        queue.removeAt(i);
+        merged++;
+      }
+      break;
+    }
+    i++;
+  }
+  return merged;
+}
+
+template <typename T>
+uint8_t RequestCoalescer::findReady(const ADUQueue<T>& queue) const {
+  const bool hold = _coilEnabled && _coilHold != 0 && !queue.isFull();
+  uint8_t ready = 255;
+  uint32_t minDelay = UINT32_MAX;
+  for (uint8_t i = 0; i < queue.count(); i++) {
+    T* pdu = queue.at(i);
+    if (!pdu || !isReady(pdu) || pdu->_delayToSend >= minDelay) continue;
+    if (hold && isHeld(pdu)) continue;
+    bool blocked = false;  // Requests to the slave of a held coil write keep their order behind it
+    for (uint8_t j = 0; hold && j < i && !blocked; j++) {
+      T* earlier = queue.at(j);
+      blocked = earlier && slaveOf(earlier) == slaveOf(pdu) && isHeld(earlier);
+    }
+    if (blocked) continue;
+    minDelay = pdu->_delayToSend;
+    ready = i;
+  }
+  return ready;
+}
+
+template <typename T>
+bool RequestCoalescer::readReady(ADUQueue<T>& queue, T*& item) const {
+  const uint8_t ix = findReady(queue);
+  if (ix == 255) return false;
+  item = queue.at(ix);
+  return queue.removeAt(ix);
+}
+
+template <typename T>
+bool RequestCoalescer::hasReady(const ADUQueue<T>& queue) const {
+  return findReady(queue) != 255;
+}
+
+template <typename T>
+bool RequestCoalescer::deduplicate(PDU* pdu, T* current, const ADUQueue<T>& queue) const {
+  if (!_dedupEnabled) return false;
+  // Newest first: a read older than a queued write to the slave would return the values from before the write
+  for (uint8_t i = queue.count(); i-- > 0;) {
+    T* queued = queue.at(i);
+    if (attach(queued, pdu)) return true;
+    if (isBarrier(queued, pdu)) return false;
+  }
+  return attach(current, pdu);
+}
+
+template <typename T>
+bool RequestCoalescer::hasQueuedBarrier(const PDU* pdu, const ADUQueue<T>& queue) const {
+  for (uint8_t i = 0; i < queue.count(); i++) {
+    if (isBarrier(queue.at(i), pdu)) return true;
+  }
+  return false;
+}
@@ -0,0 +1,154 @@
+#include "ScalingTable.h"
+
+#include "PDU.h"
+
+namespace {
+
+/// Registers in wire format (big-endian).
+struct WireRegisters {
+  const uint8_t* data;
+  uint16_t operator[](uint16_t r) const { return (uint16_t)((data[r * 2] << 8) | data[r * 2 + 1]); }
+};
+
+/// Registers already converted to host order.
+struct HostRegisters {
+  const uint8_t* data;
+  uint16_t operator[](uint16_t r) const {
+    uint16_t v;
+    memcpy(&v, data + r * 2, sizeof(v));
+    return v;
+  }
+};
+
+/// Raw value of a register offset, TYPE is resolved at compile time.
+template <uint8_t TYPE, typename T, typename R>
+inline T rawValue(const R& regs, uint16_t r) {
+  if (TYPE == MB_TAG_BOOL) return regs[r] != 0 ? 1 : 0;
+  if (TYPE == MB_TAG_UINT16) return regs[r];
+  if (TYPE == MB_TAG_INT16) return (int16_t)regs[r];
+  const uint32_t v = ((uint32_t)regs[r] << 16) | regs[r + 1];
+  if (TYPE == MB_TAG_UINT32) return v;
+  if (TYPE == MB_TAG_INT32) return (int32_t)v;
+  float f;
+  memcpy(&f, &v, sizeof(f));
+  return f;
+}
+
+/// Converts the entries [begin, end) of one type.
+template <uint8_t TYPE, typename T, typename R>
+inline void scaleGroup(const R& regs, const uint16_t* reg, const uint16_t* slot, const float* scale, const float* offset, uint16_t begin,
+                       uint16_t end, T* out) {
+  for (uint16_t i = begin; i < end; i++) out[slot[i]] = rawValue<TYPE, T>(regs, reg[i]) * (T)scale[i] + (T)offset[i];
+}
+
+}  // namespace
+
+ScalingTable::ScalingTable() {}
+
+ScalingTable::~ScalingTable() {
+  delete[] _register;
+  delete[] _slot;
+  delete[] _scale;
+  delete[] _offset;
+}
+
+uint16_t ScalingTable::begin(uint16_t entrySize) {
+  if (_register) return MB_EX_LIB_NOT_SUPPORTED;  // Bound reads may still use the entries
+  _entrySize = entrySize;
+  _register = new uint16_t[_entrySize];
+  _slot = new uint16_t[_entrySize];
+  _scale = new float[_entrySize];
+  _offset = new float[_entrySize];
+  clear();
+  return MB_EX_SUCCESS;
+}
+
+uint16_t ScalingTable::add(uint16_t reg, uint8_t type, float scale, float offset, uint16_t slot) {
+  if (type > MB_TAG_FLOAT) return MB_EX_LIB_INVALID_ARGUMENT;
+  const uint8_t width = type >= MB_TAG_UINT32 ? 2 : 1;
+  if ((uint32_t)reg + width > 0xFFFFUL) return MB_EX_LIB_INVALID_ARGUMENT;  // getRegisters() and regCount are 16-bit
+  if (slot == MB_SCALE_NEXT_SLOT) slot = _slots;
+  if (slot == MB_SCALE_NEXT_SLOT) return MB_EX_LIB_INVALID_ARGUMENT;
+  const uint16_t count = getCount();
+  if (count == _entrySize) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  // Insert at the end of its type group, moving the later groups up by one
+  const uint16_t at = _groupEnd[type];
+  for (uint16_t i = count; i > at; i--) {
+    _register[i] = _register[i - 1];
+    _slot[i] = _slot[i - 1];
+    _scale[i] = _scale[i - 1];
+    _offset[i] = _offset[i - 1];
+  }
+  _register[at] = reg;
+  _slot[at] = slot;
+  _scale[at] = scale;
+  _offset[at] = offset;
+  for (uint8_t t = type; t <= MB_TAG_FLOAT; t++) _groupEnd[t]++;
+  if (reg + width > _registers) _registers = reg + width;
+  if (slot >= _slots) _slots = slot + 1;
+  return MB_EX_SUCCESS;
+}
+
+void ScalingTable::clear() {
+  memset(_groupEnd, 0, sizeof(_groupEnd));
+  _registers = 0;
+  _slots = 0;
+}
+
+uint16_t ScalingTable::getCount() const { return _groupEnd[MB_TAG_FLOAT]; }
+
+uint16_t ScalingTable::getRegisters() const { return _registers; }
+
+uint16_t ScalingTable::getSlots() const { return _slots; }
+
+template <typename R, typename T>
+void ScalingTable::run(const R& regs, T* out) const {
+  scaleGroup<MB_TAG_BOOL>(regs, _register, _slot, _scale, _offset, 0, _groupEnd[MB_TAG_BOOL], out);
+  scaleGroup<MB_TAG_UINT16>(regs, _register, _slot, _scale, _offset, _groupEnd[MB_TAG_BOOL], _groupEnd[MB_TAG_UINT16], out);
+  scaleGroup<MB_TAG_INT16>(regs, _register, _slot, _scale, _offset, _groupEnd[MB_TAG_UINT16], _groupEnd[MB_TAG_INT16], out);
+  scaleGroup<MB_TAG_UINT32>(regs, _register, _slot, _scale, _offset, _groupEnd[MB_TAG_INT16], _groupEnd[MB_TAG_UINT32], out);
+  scaleGroup<MB_TAG_INT32>(regs, _register, _slot, _scale, _offset, _groupEnd[MB_TAG_UINT32], _groupEnd[MB_TAG_INT32], out);
+  scaleGroup<MB_TAG_FLOAT>(regs, _register, _slot, _scale, _offset, _groupEnd[MB_TAG_INT32], _groupEnd[MB_TAG_FLOAT], out);
+}
+
+uint16_t ScalingTable::apply(const uint8_t* data, uint16_t regCount, float* out) const {
+  if (!data || !out) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (regCount < _registers) return MB_EX_LIB_INVALID_BYTE_LENGTH;
+  run(WireRegisters{data}, out);
+  return MB_EX_SUCCESS;
+}
+
+uint16_t ScalingTable::apply(const uint8_t* data, uint16_t regCount, double* out) const {
+  if (!data || !out) return MB_EX_LIB_INVALID_ARGUMENT;
+  if (regCount < _registers) return MB_EX_LIB_INVALID_BYTE_LENGTH;
+  run(WireRegisters{data}, out);
+  return MB_EX_SUCCESS;
+}
+
+template <typename T>
+uint16_t ScalingTable::applyTo(const PDU& pdu, T* out) const {
+  if (pdu._err) return pdu._err;
+  if (!out || !pdu._RXPDUbuffer) return MB_EX_LIB_INVALID_ARGUMENT;
+  switch (pdu._RXPDUbuffer[0]) {
+    case MB_FC_READ_HOLDING_REGISTERS:
+    case MB_FC_READ_INPUT_REGISTERS:
+    case MB_FC_READ_AND_WRITE_REGISTERS:
+      break;
+    default:
+      return MB_EX_LIB_INVALID_ARGUMENT;
+  }
+  if (pdu._dataLen / 2 < _registers) return MB_EX_LIB_INVALID_BYTE_LENGTH;
+  const uint8_t* data = pdu._RXPDUbuffer + pdu._dataBegin;
+  if (pdu._encoded) {
+    run(WireRegisters{data}, out);
+  } else if (pdu._elemSize == 2) {
+    run(HostRegisters{data}, out);
+  } else {
+    return MB_EX_LIB_INVALID_ARGUMENT;  // Converted per element, register boundaries are lost
+  }
+  return MB_EX_SUCCESS;
+}
+
+uint16_t ScalingTable::apply(const PDU& pdu, float* out) const { return applyTo(pdu, out); }
+
+uint16_t ScalingTable::apply(const PDU& pdu, double* out) const { return applyTo(pdu, out); }
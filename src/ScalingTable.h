@@ -0,0 +1,148 @@
+/**
+ * @file ScalingTable.h
+ * @brief Conversion of raw register responses into scaled engineering values.
+ * @details Attached to a read with ModbusMaster::readHoldingRegisters() / readInputRegisters() or applied to a
+ *          response with ScalingTable::apply(). Storage is allocated once in begin().
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#include "ModbusDef.h"
+
+class PDU;
+
+/**
+ * @def MB_SCALE_NEXT_SLOT
+ * @brief Slot argument of ScalingTable::add() for the slot after the highest one used so far.
+ */
+#define MB_SCALE_NEXT_SLOT 0xFFFF
+
+/**
+ * @class ScalingTable
+ * @brief Per-value type, scale, offset and output slot of a register block.
+ * @details Every entry reads a value at a register offset of the response, converts it to float or double and
+ *          stores `raw * scale + offset` in its slot of a contiguous output array. Entries are kept as separate
+ *          arrays grouped by type, so a response is converted by one branch-free loop per type instead of a
+ *          switch and a callback per value. Types are those of PollPlan tags (MB_TAG_*), 32-bit values high word
+ *          first; MB_TAG_BOOL converts a register to 1 if it is non-zero, 0 otherwise.
+ */
+class ScalingTable {
+ private:
+  uint16_t* _register = nullptr;  ///< Register offset per entry.
+  uint16_t* _slot = nullptr;      ///< Output slot per entry.
+  float* _scale = nullptr;        ///< Scale per entry.
+  float* _offset = nullptr;       ///< Offset per entry.
+  uint16_t _groupEnd[MB_TAG_FLOAT + 1] = {};  ///< End of the entries of each type (entries sorted by type).
+  uint16_t _entrySize = 0;        ///< Entry capacity.
+  uint16_t _registers = 0;        ///< Registers covered by the entries.
+  uint16_t _slots = 0;            ///< Output slots used by the entries.
+
+  /**
+   * @brief Converts the entries of all types.
+   * @tparam R Register accessor (wire or host order).
+   * @tparam T Output type (float or double).
+   * @param regs Registers of the response.
+   * @param out Output array.
+   */
+  template <typename R, typename T>
+  void run(const R& regs, T* out) const;
+
+  /**
+   * @brief Converts the registers of a response.
+   * @tparam T Output type (float or double).
+   * @param pdu Completed register read.
+   * @param out Output array.
+   * @return uint16_t Error code or 0 if successful.
+   */
+  template <typename T>
+  uint16_t applyTo(const PDU& pdu, T* out) const;
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an empty table.
+   */
+  ScalingTable();
+
+  /**
+   * @brief Destructor.
+   * @details Frees the entries.
+   */
+  ~ScalingTable();
+
+  ScalingTable(const ScalingTable&) = delete;
+  ScalingTable& operator=(const ScalingTable&) = delete;
+
+  /**
+   * @brief Allocates the entry arrays.
+   * @param entrySize Maximum number of entries.
+   * @return uint16_t MB_EX_LIB_NOT_SUPPORTED if already started, 0 otherwise.
+   */
+  uint16_t begin(uint16_t entrySize);
+
+  /**
+   * @brief Adds a value of the block.
+   * @param reg Register offset from the start of the response (the value must end before offset 0xFFFF).
+   * @param type Value type (MB_TAG_BOOL, MB_TAG_UINT16, MB_TAG_INT16, MB_TAG_UINT32, MB_TAG_INT32, MB_TAG_FLOAT).
+   * @param scale Factor applied to the raw value (default: 1).
+   * @param offset Added after scaling (default: 0).
+   * @param slot Index in the output array (default: MB_SCALE_NEXT_SLOT).
+   * @return uint16_t Error code (MB_EX_LIB_INVALID_ARGUMENT, MB_EX_LIB_BUFFER_IS_TOO_SMALL) or 0 if successful.
+   */
+  uint16_t add(uint16_t reg, uint8_t type, float scale = 1.0f, float offset = 0.0f, uint16_t slot = MB_SCALE_NEXT_SLOT);
+
+  /**
+   * @brief Removes all entries, keeping the allocation.
+   */
+  void clear();
+
+  /**
+   * @brief Returns the number of entries.
+   * @return uint16_t Entries added.
+   */
+  uint16_t getCount() const;
+
+  /**
+   * @brief Returns the registers a response must hold.
+   * @return uint16_t End of the last register used by an entry.
+   */
+  uint16_t getRegisters() const;
+
+  /**
+   * @brief Returns the size of the output array.
+   * @return uint16_t Highest slot used plus one.
+   */
+  uint16_t getSlots() const;
+
+  /**
+   * @brief Converts a register image.
+   * @param data Registers in wire format (big-endian, any alignment).
+   * @param regCount Registers in data.
+   * @param out Output array of getSlots() values. Slots without an entry are left unchanged.
+   * @return uint16_t Error code (MB_EX_LIB_INVALID_ARGUMENT, MB_EX_LIB_INVALID_BYTE_LENGTH) or 0 if successful.
+   */
+  uint16_t apply(const uint8_t* data, uint16_t regCount, float* out) const;
+
+  /**
+   * @brief Converts a register image into doubles.
+   * @details See the float overload, 32-bit integers keep their full precision.
+   */
+  uint16_t apply(const uint8_t* data, uint16_t regCount, double* out) const;
+
+  /**
+   * @brief Converts the registers of a response, e.g. inside its callback.
+   * @details Works on the wire data of lazily decoded responses and on responses read as uint16_t.
+   * @param pdu Completed holding or input register read.
+   * @param out Output array of getSlots() values.
+   * @return uint16_t Error code of the response, MB_EX_LIB_INVALID_ARGUMENT (other response or element type),
+   *         MB_EX_LIB_INVALID_BYTE_LENGTH (response too short) or 0 if successful.
+   */
+  uint16_t apply(const PDU& pdu, float* out) const;
+
+  /**
+   * @brief Converts the registers of a response into doubles.
+   * @details See the float overload.
+   */
+  uint16_t apply(const PDU& pdu, double* out) const;
+};
@@ -0,0 +1,192 @@
+#include "ShmRegisterImage.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "PDU.h"
+
+static_assert(sizeof(ShmImageHeader) == 32, "ShmImageHeader layout changed");
+static_assert(sizeof(ShmBlockHeader) == 32, "ShmBlockHeader layout changed");
+
+ShmRegisterImage::ShmRegisterImage() {}
+
+ShmRegisterImage::~ShmRegisterImage() {
+  if (_base) munmap(_base, _size);
+}
+
+uint16_t ShmRegisterImage::begin(const char* name, uint16_t blockCount, uint16_t dataSize) {
+  if (!name || name[0] != '/' || strlen(name) >= sizeof(_name) || blockCount == 0) return MB_EX_LIB_INVALID_ARGUMENT;
+  const uint32_t stride = sizeof(ShmBlockHeader) + ((dataSize + 7) & ~7U);
+  const size_t size = sizeof(ShmImageHeader) + (size_t)stride * blockCount;
+  int fd = shm_open(name, O_CREAT | O_RDWR, 0644);  // No O_TRUNC, readers may still map an existing object
+  if (fd < 0) return MB_EX_LIB_INVALID_ARGUMENT;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size > size) {  // Readers may map the part beyond the new end
+    close(fd);
+    return MB_EX_LIB_INVALID_ARGUMENT;
+  }
+  if ((size_t)st.st_size != size && ftruncate(fd, size) != 0) {
+    close(fd);
+    return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  }
+  void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);  // The mapping keeps the object alive
+  if (base == MAP_FAILED) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  if (_base) munmap(_base, _size);
+  _base = static_cast<uint8_t*>(base);
+  _size = size;
+  strcpy(_name, name);
+  ShmImageHeader* header = reinterpret_cast<ShmImageHeader*>(_base);
+  // Readers may still copy blocks of the previous layout: hide the image, then lock every block before reuse
+  __atomic_store_n(&header->magic, 0, __ATOMIC_RELEASE);
+  if (header->version == MB_SHM_VERSION && header->headerSize == sizeof(ShmImageHeader) &&
+      header->headerSize + (size_t)header->blockStride * header->blockCount <= size) {
+    for (uint16_t i = 0; i < header->blockCount; i++) {
+      lockBlock(reinterpret_cast<ShmBlockHeader*>(_base + header->headerSize + (size_t)header->blockStride * i));
+    }
+  }
+  header->version = MB_SHM_VERSION;
+  header->blockCount = blockCount;
+  header->blockStride = stride;
+  header->dataSize = dataSize;
+  header->headerSize = sizeof(ShmImageHeader);
+  memset(header->reserved, 0, sizeof(header->reserved));
+  for (uint16_t i = 0; i < blockCount; i++) {
+    ShmBlockHeader* b = reinterpret_cast<ShmBlockHeader*>(_base + sizeof(ShmImageHeader) + (size_t)stride * i);
+    const uint32_t seq = lockBlock(b);
+    memset(reinterpret_cast<uint8_t*>(b) + sizeof(b->seq), 0, stride - sizeof(b->seq));
+    __atomic_store_n(&b->seq, seq + 1, __ATOMIC_RELEASE);
+  }
+  __atomic_store_n(&header->magic, MB_SHM_MAGIC, __ATOMIC_RELEASE);  // Readers check the magic last
+  return 0;
+}
+
+uint32_t ShmRegisterImage::lockBlock(ShmBlockHeader* b) {
+  const uint32_t seq = b->seq;
+  if (seq & 1) return seq;  // Already locked, e.g. by a writer that stopped during an update
+  __atomic_store_n(&b->seq, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  return seq + 1;
+}
+
+ShmBlockHeader* ShmRegisterImage::blockAt(uint16_t block) const {
+  if (!_base) return nullptr;
+  const ShmImageHeader* header = reinterpret_cast<const ShmImageHeader*>(_base);
+  if (block >= header->blockCount) return nullptr;
+  return reinterpret_cast<ShmBlockHeader*>(_base + header->headerSize + (size_t)header->blockStride * block);
+}
+
+uint16_t ShmRegisterImage::defineBlock(uint16_t block, uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, uint8_t elemSize) {
+  ShmBlockHeader* b = blockAt(block);
+  if (!b) return MB_EX_LIB_INVALID_ARGUMENT;
+  const uint32_t seq = lockBlock(b);
+  b->unit = unit;
+  b->table = table;
+  b->address = address;
+  b->quantity = quantity;
+  b->elemSize = elemSize;
+  __atomic_store_n(&b->seq, seq + 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+uint16_t ShmRegisterImage::publish(uint16_t block, const void* data, uint16_t len, uint16_t err) {
+  ShmBlockHeader* b = blockAt(block);
+  if (!b) return MB_EX_LIB_INVALID_ARGUMENT;
+  const ShmImageHeader* header = reinterpret_cast<const ShmImageHeader*>(_base);
+  if (!err && len > header->dataSize) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  const uint32_t seq = lockBlock(b);  // Odd: write in progress
+  if (!err) {
+    memcpy(reinterpret_cast<uint8_t*>(b) + sizeof(ShmBlockHeader), data, len);
+    b->len = len;
+  }
+  b->err = err;
+  b->timestamp = (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+  __atomic_store_n(&b->seq, seq + 1, __ATOMIC_RELEASE);
+  return 0;
+}
+
+uint16_t ShmRegisterImage::publish(uint16_t block, const PDU& pdu) {
+  if (pdu.getErr()) return publish(block, nullptr, 0, pdu.getErr());
+  return publish(block, pdu.getDataArray<uint8_t>(), pdu.getByteLen());
+}
+
+void ShmRegisterImage::end() {
+  if (!_base) return;
+  munmap(_base, _size);
+  shm_unlink(_name);
+  _base = nullptr;
+  _size = 0;
+}
+
+ShmRegisterReader::ShmRegisterReader() {}
+
+ShmRegisterReader::~ShmRegisterReader() {
+  if (_base) munmap(const_cast<uint8_t*>(_base), _size);
+}
+
+uint16_t ShmRegisterReader::begin(const char* name) {
+  int fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0) return MB_EX_LIB_INVALID_ARGUMENT;
+  const off_t size = lseek(fd, 0, SEEK_END);
+  if (size < (off_t)sizeof(ShmImageHeader)) {
+    close(fd);
+    return MB_EX_LIB_TOO_FEW_DATA;
+  }
+  void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) return MB_EX_LIB_INVALID_ARGUMENT;
+  const ShmImageHeader* header = static_cast<const ShmImageHeader*>(base);
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != MB_SHM_MAGIC || header->version != MB_SHM_VERSION ||
+      header->headerSize + (size_t)header->blockStride * header->blockCount > (size_t)size) {
+    munmap(base, size);
+    return MB_EX_LIB_NOT_SUPPORTED;
+  }
+  if (_base) munmap(const_cast<uint8_t*>(_base), _size);
+  _base = static_cast<const uint8_t*>(base);
+  _size = size;
+  return 0;
+}
+
+uint16_t ShmRegisterReader::getBlockCount() const {
+  return _base ? reinterpret_cast<const ShmImageHeader*>(_base)->blockCount : 0;
+}
+
+const ShmBlockHeader* ShmRegisterReader::getBlock(uint16_t block) const {
+  if (block >= getBlockCount()) return nullptr;
+  const ShmImageHeader* header = reinterpret_cast<const ShmImageHeader*>(_base);
+  if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != MB_SHM_MAGIC) return nullptr;  // Writer restarting
+  if (header->headerSize + (size_t)header->blockStride * (block + 1) > _size) return nullptr;  // Image grown after begin()
+  return reinterpret_cast<const ShmBlockHeader*>(_base + header->headerSize + (size_t)header->blockStride * block);
+}
+
+const uint8_t* ShmRegisterReader::getData(uint16_t block) const {
+  const ShmBlockHeader* b = getBlock(block);
+  return b ? reinterpret_cast<const uint8_t*>(b) + sizeof(ShmBlockHeader) : nullptr;
+}
+
+uint16_t ShmRegisterReader::read(uint16_t block, void* dst, uint16_t size, ShmBlockHeader* header) const {
+  const ShmBlockHeader* b = getBlock(block);
+  if (!b) return 0;
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(b) + sizeof(ShmBlockHeader);
+  const uint32_t dataSize = reinterpret_cast<const ShmImageHeader*>(_base)->dataSize;
+  if (size > dataSize) size = dataSize;
+  ShmBlockHeader snap;
+  uint32_t seq;
+  do {
+    seq = __atomic_load_n(&b->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) continue;  // Writer active
+    memcpy(&snap, b, sizeof(snap));
+    memcpy(dst, data, snap.len < size ? snap.len : size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  } while ((seq & 1) || __atomic_load_n(&b->seq, __ATOMIC_RELAXED) != seq);
+  if (header) *header = snap;
+  return snap.len < size ? snap.len : size;
+}
+
+#endif
@@ -0,0 +1,210 @@
+/**
+ * @file ShmRegisterImage.h
+ * @brief Shared memory image of polled values for consumers in other processes (Linux only).
+ * @details The polling process publishes decoded responses into a region under /dev/shm, consumers map it read-only
+ *          and read the latest values lock-free. Every block is guarded by a sequence lock, so one writer and any number
+ *          of readers need no system calls after mapping.
+ *
+ * Layout (all fields in host byte order, offsets in bytes):
+ * @code
+ * 0                    ShmImageHeader (32 bytes)
+ * 32 + i * blockStride ShmBlockHeader of block i (32 bytes)
+ * 64 + i * blockStride Data of block i (dataSize bytes, len valid)
+ * @endcode
+ * blockStride = 32 + dataSize rounded up to 8. A reader copies a block while ShmBlockHeader::seq is even and unchanged
+ * before and after the copy, an odd seq means a write is in progress.
+ */
+
+#pragma once
+#if defined(__linux__)
+#include <Arduino.h>
+
+#include "ModbusDef.h"
+
+class PDU;
+
+#define MB_SHM_MAGIC 0x4953424DUL  ///< "MBSI" in little-endian byte order.
+#define MB_SHM_VERSION 1           ///< Layout version.
+
+/**
+ * @struct ShmImageHeader
+ * @brief Header at the start of the shared memory region.
+ */
+struct ShmImageHeader {
+  uint32_t magic;          ///< MB_SHM_MAGIC.
+  uint16_t version;        ///< MB_SHM_VERSION.
+  uint16_t blockCount;     ///< Number of blocks.
+  uint32_t blockStride;    ///< Distance between block headers.
+  uint32_t dataSize;       ///< Data capacity of a block.
+  uint32_t headerSize;     ///< Size of this header (offset of block 0).
+  uint8_t reserved[12];    ///< Zero.
+};
+
+/**
+ * @struct ShmBlockHeader
+ * @brief Header of one block, followed by its data.
+ */
+struct ShmBlockHeader {
+  uint32_t seq;          ///< Sequence lock, odd while the writer updates the block.
+  uint16_t err;          ///< Error code of the last poll (MB_EX_*), data is kept from the last success.
+  uint16_t len;          ///< Valid data bytes.
+  uint64_t timestamp;    ///< Time of the last publish (µs since the Unix epoch).
+  uint8_t unit;          ///< Unit ID the block was read from.
+  uint8_t table;         ///< Data table (MB_TABLE_*).
+  uint16_t address;      ///< Start address.
+  uint16_t quantity;     ///< Number of registers or bits.
+  uint8_t elemSize;      ///< Size of a decoded element (1 for bits, 2 for uint16_t, 4 for float...).
+  uint8_t reserved0;     ///< Zero.
+  uint8_t reserved[8];   ///< Zero.
+};
+
+/**
+ * @class ShmRegisterImage
+ * @brief Writer side of the shared memory image.
+ * @details Call publish() from the response callback of a read, the block then holds the decoded values for
+ *          every consumer, so the bus is polled once.
+ */
+class ShmRegisterImage {
+ private:
+  uint8_t* _base = nullptr;   ///< Mapped region.
+  size_t _size = 0;           ///< Mapped size.
+  char _name[32]{};           ///< Shared memory object name.
+
+  /**
+   * @brief Returns the header of a block.
+   * @param block Block index.
+   * @return ShmBlockHeader* Block header, or nullptr if out of range.
+   */
+  ShmBlockHeader* blockAt(uint16_t block) const;
+
+  /**
+   * @brief Makes the sequence lock of a block odd, so readers retry until it is released.
+   * @param b Block header.
+   * @return uint32_t Odd sequence value, the block is released by storing it + 1.
+   */
+  static uint32_t lockBlock(ShmBlockHeader* b);
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an unmapped image.
+   */
+  ShmRegisterImage();
+
+  /**
+   * @brief Destructor.
+   * @details Unmaps the region, the shared memory object stays for the readers.
+   */
+  ~ShmRegisterImage();
+
+  /**
+   * @brief Creates (or recreates) and maps the shared memory object.
+   * @details An existing object is reused in place, so readers that still map it do not fault: its blocks stay
+   *          locked until they are cleared and getBlock() returns nullptr meanwhile. It may grow but is never shrunk,
+   *          a larger object is rejected (remove it first). A second call maps the object anew.
+   * @param name Object name starting with '/', e.g. "/modbus" for /dev/shm/modbus.
+   * @param blockCount Number of blocks.
+   * @param dataSize Data capacity of a block (e.g. 250 for a full read response).
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t begin(const char* name, uint16_t blockCount, uint16_t dataSize);
+
+  /**
+   * @brief Describes the source of a block for the consumers.
+   * @param block Block index.
+   * @param unit Unit ID.
+   * @param table Data table (MB_TABLE_*).
+   * @param address Start address.
+   * @param quantity Number of registers or bits.
+   * @param elemSize Size of a decoded element.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t defineBlock(uint16_t block, uint8_t unit, uint8_t table, uint16_t address, uint16_t quantity, uint8_t elemSize);
+
+  /**
+   * @brief Publishes decoded values into a block.
+   * @param block Block index.
+   * @param data Decoded values.
+   * @param len Data length in bytes.
+   * @param err Error code of the poll (MB_EX_*), on error the previous data is kept.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t publish(uint16_t block, const void* data, uint16_t len, uint16_t err = 0);
+
+  /**
+   * @brief Publishes the decoded response (or error) of a read.
+   * @param block Block index.
+   * @param pdu Response PDU, as passed to the callback.
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t publish(uint16_t block, const PDU& pdu);
+
+  /**
+   * @brief Unmaps and removes the shared memory object.
+   */
+  void end();
+};
+
+/**
+ * @class ShmRegisterReader
+ * @brief Reader side of the shared memory image, used by the consumer processes.
+ */
+class ShmRegisterReader {
+ private:
+  const uint8_t* _base = nullptr;  ///< Mapped region (read-only).
+  size_t _size = 0;                ///< Mapped size.
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an unmapped reader.
+   */
+  ShmRegisterReader();
+
+  /**
+   * @brief Destructor.
+   * @details Unmaps the region.
+   */
+  ~ShmRegisterReader();
+
+  /**
+   * @brief Maps an existing image read-only.
+   * @param name Object name given to ShmRegisterImage::begin().
+   * @return uint16_t Error code (MB_EX_*) or 0 if successful.
+   */
+  uint16_t begin(const char* name);
+
+  /**
+   * @brief Returns the number of blocks.
+   * @return uint16_t Block count, 0 if not mapped.
+   */
+  uint16_t getBlockCount() const;
+
+  /**
+   * @brief Returns the header of a block without a consistency check.
+   * @details Use the unit, table, address and quantity fields to find a block, they do not change after setup.
+   * @param block Block index.
+   * @return const ShmBlockHeader* Block header, or nullptr if out of range.
+   */
+  const ShmBlockHeader* getBlock(uint16_t block) const;
+
+  /**
+   * @brief Returns the data of a block for zero-copy access.
+   * @details Valid if getBlock(block)->seq was even before the access and is unchanged afterwards.
+   * @param block Block index.
+   * @return const uint8_t* Block data, or nullptr if out of range.
+   */
+  const uint8_t* getData(uint16_t block) const;
+
+  /**
+   * @brief Copies a consistent snapshot of a block.
+   * @param block Block index.
+   * @param dst Destination buffer.
+   * @param size Destination capacity in bytes.
+   * @param header Filled with the block header of the snapshot (optional).
+   * @return uint16_t Copied bytes, 0 if out of range.
+   */
+  uint16_t read(uint16_t block, void* dst, uint16_t size, ShmBlockHeader* header = nullptr) const;
+};
+
+#endif
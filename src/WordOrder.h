@@ -0,0 +1,46 @@
+/**
+ * @file WordOrder.h
+ * @brief Per-request word and byte order of multi-register values.
+ * @details Wrapping an element type in Ordered<T, ORDER> selects the register layout used by the read and write
+ *          templates of ModbusMaster. The conversion runs in the same pass as the default endian conversion.
+ */
+
+#pragma once
+#include <stdint.h>
+
+#include "ModbusDef.h"
+
+/**
+ * @struct Ordered
+ * @brief Element type carrying its register layout.
+ * @details Has the size and memory layout of T, so a response may also be read with getDataArray<T>().
+ * @tparam T Value type (e.g. float, int32_t, uint64_t, double).
+ * @tparam ORDER Register layout (MB_ORDER_*).
+ */
+template <typename T, uint8_t ORDER>
+struct Ordered {
+  T value;  ///< Value in host format.
+};
+
+/**
+ * @struct WordOrderOf
+ * @brief Register layout of an element type, MB_ORDER_HOST unless the type is an Ordered<T, ORDER>.
+ * @tparam T Element type.
+ */
+template <typename T>
+struct WordOrderOf {
+  static constexpr uint8_t value = MB_ORDER_HOST;  ///< Register layout.
+};
+
+/**
+ * @struct WordOrderOf
+ * @brief Register layout of an Ordered<T, ORDER> element type.
+ * @tparam T Value type.
+ * @tparam ORDER Register layout (MB_ORDER_*).
+ */
+template <typename T, uint8_t ORDER>
+struct WordOrderOf<Ordered<T, ORDER>> {
+  static_assert(sizeof(T) % 2 == 0, "Word orders apply to values of whole registers");
+  static_assert(ORDER <= MB_ORDER_DCBA, "Unknown word order");
+  static constexpr uint8_t value = ORDER;  ///< Register layout.
+};
@@ -0,0 +1,195 @@
+#include "WriteShadow.h"
+
+#include "ModbusUtility.h"
+#include "PDU.h"
+
+WriteShadow::WriteShadow() {}
+
+WriteShadow::~WriteShadow() {
+  if (_ranges) {
+    for (uint8_t i = 0; i < _rangeCount; i++) {
+      delete[] _ranges[i]._data;
+      delete[] _ranges[i]._valid;
+    }
+    delete[] _ranges;
+  }
+}
+
+void WriteShadow::begin(uint8_t rangeSize, uint32_t refreshMs) {
+  _rangeSize = rangeSize;
+  _ranges = new ShadowRange[_rangeSize];
+  _refresh = refreshMs;
+}
+
+uint16_t WriteShadow::addRange(uint8_t slave, uint8_t table, uint16_t address, uint16_t quantity) {
+  if (slave == 0 || slave > MB_MAX_SLAVE_ID) return MB_EX_LIB_INVALID_SLAVE;
+  if ((table != MB_TABLE_COILS && table != MB_TABLE_HOLDING_REGISTERS) || quantity == 0) return MB_EX_LIB_INVALID_ARGUMENT;
+  if ((uint32_t)address + quantity > 0x10000UL) return MB_EX_LIB_INVALID_ARGUMENT;
+  for (uint8_t i = 0; i < _rangeCount; i++) {
+    const ShadowRange& r = _ranges[i];
+    if (r._slave == slave && r._table == table && address < (uint32_t)r._address + r._quantity && r._address < (uint32_t)address + quantity) {
+      return MB_EX_LIB_INVALID_ARGUMENT;  // Overlap
+    }
+  }
+  if (_rangeCount == _rangeSize) return MB_EX_LIB_BUFFER_IS_TOO_SMALL;
+  ShadowRange& r = _ranges[_rangeCount++];
+  r._slave = slave;
+  r._table = table;
+  r._address = address;
+  r._quantity = quantity;
+  const uint16_t bytes = table == MB_TABLE_COILS ? (quantity + 7) / 8 : quantity * 2;
+  r._data = new uint8_t[bytes]();
+  r._valid = new uint8_t[(quantity + 7) / 8]();
+  return MB_EX_SUCCESS;
+}
+
+void WriteShadow::setRefreshInterval(uint32_t refreshMs) { _refresh = refreshMs; }
+
+void WriteShadow::invalidate(uint8_t slave) {
+  for (uint8_t i = 0; i < _rangeCount; i++) {
+    ShadowRange& r = _ranges[i];
+    if (r._slave == slave) memset(r._valid, 0, (r._quantity + 7) / 8);
+  }
+}
+
+void WriteShadow::invalidate(uint8_t slave, uint8_t table, uint16_t address, uint16_t quantity) {
+  for (uint8_t i = 0; i < _rangeCount; i++) {
+    ShadowRange& r = _ranges[i];
+    if (r._slave == slave && r._table == table) update(r, address, quantity, nullptr);
+  }
+}
+
+uint32_t WriteShadow::getSuppressedCount() const { return _suppressed; }
+
+bool WriteShadow::getBit(const uint8_t* buf, uint16_t bit) { return buf[bit >> 3] & (1 << (bit & 7)); }
+
+void WriteShadow::setBit(uint8_t* buf, uint16_t bit, bool value) {
+  if (value) {
+    buf[bit >> 3] |= 1 << (bit & 7);
+  } else {
+    buf[bit >> 3] &= ~(1 << (bit & 7));
+  }
+}
+
+const uint8_t* WriteShadow::writeOf(const PDU* pdu, uint8_t& table, uint16_t& address, uint16_t& quantity, uint8_t& coil) {
+  const uint8_t* tx = pdu->_TXPDUbuffer;
+  address = (tx[1] << 8) | tx[2];
+  switch (tx[0]) {
+    case MB_FC_WRITE_SINGLE_COIL:
+      table = MB_TABLE_COILS;
+      quantity = 1;
+      coil = tx[3] == 0xFF ? 0x01 : 0x00;
+      return &coil;
+    case MB_FC_WRITE_SINGLE_REGISTER:
+      table = MB_TABLE_HOLDING_REGISTERS;
+      quantity = 1;
+      return tx + 3;
+    case MB_FC_WRITE_MULTIPLE_COILS:
+      table = MB_TABLE_COILS;
+      quantity = (tx[3] << 8) | tx[4];
+      return tx + 6;
+    case MB_FC_WRITE_MULTIPLE_REGISTERS:
+      table = MB_TABLE_HOLDING_REGISTERS;
+      quantity = (tx[3] << 8) | tx[4];
+      return tx + 6;
+    case MB_FC_READ_AND_WRITE_REGISTERS:  // A write fused with a read by RequestCoalescer
+      table = MB_TABLE_HOLDING_REGISTERS;
+      address = (tx[5] << 8) | tx[6];
+      quantity = (tx[7] << 8) | tx[8];
+      return tx + 10;
+    default:
+      return nullptr;
+  }
+}
+
+void WriteShadow::update(ShadowRange& r, uint16_t address, uint16_t quantity, const uint8_t* data) {
+  // Overlapping part of the write, in addresses relative to both
+  const uint32_t lo = address > r._address ? address : r._address;
+  const uint32_t hi = (uint32_t)address + quantity < (uint32_t)r._address + r._quantity ? (uint32_t)address + quantity : (uint32_t)r._address + r._quantity;
+  for (uint32_t a = lo; a < hi; a++) {
+    const uint16_t dst = a - r._address;
+    const uint16_t src = a - address;
+    if (data) {
+      if (r._table == MB_TABLE_COILS) {
+        setBit(r._data, dst, getBit(data, src));
+      } else {
+        r._data[dst * 2] = data[src * 2];
+        r._data[dst * 2 + 1] = data[src * 2 + 1];
+      }
+    }
+    setBit(r._valid, dst, data != nullptr);
+  }
+}
+
+bool WriteShadow::matches(const PDU* pdu) {
+  uint8_t table, coil;
+  uint16_t address, quantity;
+  if (pdu->_TXPDUbuffer[0] == MB_FC_READ_AND_WRITE_REGISTERS) return false;  // The read must be sent anyway
+  if (pdu->_payload) return false;  // Values are read at transmit time
+  const uint8_t* data = writeOf(pdu, table, address, quantity, coil);
+  if (!data) return false;
+  const uint8_t slave = pdu->getSlaveId();
+  for (uint8_t i = 0; i < _rangeCount; i++) {
+    ShadowRange& r = _ranges[i];
+    if (r._slave != slave || r._table != table || address < r._address || (uint32_t)address + quantity > (uint32_t)r._address + r._quantity) continue;
+    if (_refresh && on_ms(&r._written, _refresh, false)) return false;  // Refresh due
+    const uint16_t offset = address - r._address;
+    for (uint16_t k = 0; k < quantity; k++) {
+      if (!getBit(r._valid, offset + k)) return false;
+    }
+    if (table == MB_TABLE_COILS) {
+      for (uint16_t k = 0; k < quantity; k++) {
+        if (getBit(r._data, offset + k) != getBit(data, k)) return false;
+      }
+    } else if (memcmp(r._data + offset * 2, data, quantity * 2) != 0) {
+      return false;
+    }
+    _suppressed++;
+    return true;
+  }
+  return false;
+}
+
+void WriteShadow::expect(PDU* pdu) {
+  uint8_t table, coil;
+  uint16_t address, quantity;
+  const uint8_t* tx = pdu->_TXPDUbuffer;
+  if (tx[0] == MB_FC_MASK_WRITE_REGISTER) {  // The resulting value stays unknown
+    table = MB_TABLE_HOLDING_REGISTERS;
+    address = (tx[1] << 8) | tx[2];
+    quantity = 1;
+  } else if (!writeOf(pdu, table, address, quantity, coil)) {
+    return;
+  }
+  pdu->_shadowSeq = ++_seq;
+  const uint8_t slave = pdu->getSlaveId();
+  for (uint8_t i = 0; i < _rangeCount; i++) {
+    ShadowRange& r = _ranges[i];
+    if (r._slave != slave || r._table != table) continue;
+    if (address >= (uint32_t)r._address + r._quantity || r._address >= (uint32_t)address + quantity) continue;
+    update(r, address, quantity, nullptr);
+    r._expected = _seq;
+  }
+}
+
+void WriteShadow::acknowledge(const PDU* pdu) {
+  const uint8_t slave = pdu->getSlaveId();
+  const uint8_t* tx = pdu->_TXPDUbuffer;
+  if (tx[0] == MB_FC_DIAGNOSTICS) {
+    if (pdu->_err == 0 && tx[1] == 0x00 && tx[2] == 0x01) invalidate(slave);  // Restart communications option
+    return;
+  }
+  uint8_t table, coil;
+  uint16_t address, quantity;
+  const uint8_t* data = writeOf(pdu, table, address, quantity, coil);
+  if (!data) return;
+  const uint32_t now = millis();
+  for (uint8_t i = 0; i < _rangeCount; i++) {
+    ShadowRange& r = _ranges[i];
+    if (r._slave != slave || r._table != table) continue;
+    if (address >= (uint32_t)r._address + r._quantity || r._address >= (uint32_t)address + quantity) continue;
+    // After a failure, a referenced write or while a newer write is pending the state is unknown
+    update(r, address, quantity, pdu->_err || pdu->_payload || r._expected != pdu->_shadowSeq ? nullptr : data);
+    if (pdu->_err == 0) r._written = now;
+  }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file WriteShadow.h
+ * @brief Shadow image of the last acknowledged writes, used to suppress unchanged writes.
+ * @details Attached to a master with ModbusMaster::setWriteShadow(). Writes into a shadowed range whose payload
+ *          equals the last acknowledged values are completed locally without a transaction.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+#include "ModbusDef.h"
+
+class PDU;
+
+/**
+ * @class ShadowRange
+ * @brief Shadowed address range of one slave and table.
+ * @details Registers are stored big-endian (wire format), bits packed LSB first. A valid bit per address tells
+ *          whether the value was acknowledged by the slave.
+ */
+class ShadowRange {
+  friend class WriteShadow;  ///< Access to private members for lookup.
+
+ private:
+  uint8_t _slave = 0;         ///< Slave ID.
+  uint8_t _table = 0;         ///< MB_TABLE_COILS or MB_TABLE_HOLDING_REGISTERS.
+  uint16_t _address = 0;      ///< First address.
+  uint16_t _quantity = 0;     ///< Number of registers or coils.
+  uint8_t* _data = nullptr;   ///< Last acknowledged values (wire format).
+  uint8_t* _valid = nullptr;  ///< Valid bit per address.
+  uint32_t _written = 0;      ///< Time of the last write sent to the slave (ms).
+  uint32_t _expected = 0;     ///< Sequence number of the newest write queued to the range.
+};
+
+/**
+ * @class WriteShadow
+ * @brief Remembers the last acknowledged write per address and suppresses writes that change nothing.
+ * @details A write is suppressed if it lies in one range, every address holds an acknowledged value equal to the
+ *          payload and the range was written within the refresh interval. Addresses of a pending write are unknown,
+ *          a successful write updates the shadow unless a newer write to the range is still pending, a failed one
+ *          (exception, timeout) leaves them unknown.
+ *          A mask write (FC 0x16) invalidates its register, a successful restart communications diagnostic
+ *          (FC 0x08, sub-function 0x0001) invalidates the slave.
+ *          Storage is allocated once in begin() and addRange().
+ */
+class WriteShadow {
+  friend class PDU;           ///< Reports completed writes.
+  friend class ModbusMaster;  ///< Checks writes before they are queued.
+
+ private:
+  ShadowRange* _ranges = nullptr;  ///< Shadowed ranges.
+  uint8_t _rangeSize = 0;          ///< Range capacity.
+  uint8_t _rangeCount = 0;         ///< Ranges in use.
+  uint32_t _refresh = 0;           ///< Forced refresh interval (ms, 0 = never).
+  uint32_t _suppressed = 0;        ///< Writes completed locally.
+  uint32_t _seq = 0;               ///< Sequence number of the last write queued.
+
+  /**
+   * @brief Extracts the written range of a write request.
+   * @param pdu Request (FC 0x05, 0x06, 0x0F, 0x10 or 0x17).
+   * @param table Set to the data table.
+   * @param address Set to the first address.
+   * @param quantity Set to the number of registers or coils.
+   * @param coil Buffer for the bit of a FC 0x05 request.
+   * @return const uint8_t* Written values (wire format), nullptr if pdu is no write.
+   */
+  static const uint8_t* writeOf(const PDU* pdu, uint8_t& table, uint16_t& address, uint16_t& quantity, uint8_t& coil);
+
+  /**
+   * @brief Reads a bit of a packed buffer.
+   * @param buf Buffer.
+   * @param bit Bit index.
+   * @return bool Bit value.
+   */
+  static bool getBit(const uint8_t* buf, uint16_t bit);
+
+  /**
+   * @brief Sets a bit of a packed buffer.
+   * @param buf Buffer.
+   * @param bit Bit index.
+   * @param value Bit value.
+   */
+  static void setBit(uint8_t* buf, uint16_t bit, bool value);
+
+  /**
+   * @brief Updates or invalidates the addresses of a range written by a request.
+   * @param r Range to update.
+   * @param address First written address.
+   * @param quantity Written registers or coils.
+   * @param data Written values (wire format), nullptr to invalidate.
+   */
+  static void update(ShadowRange& r, uint16_t address, uint16_t quantity, const uint8_t* data);
+
+  /**
+   * @brief Checks if a write would leave the shadowed values unchanged.
+   * @param pdu Write request, not queued yet.
+   * @return bool True if the write may be completed locally.
+   */
+  bool matches(const PDU* pdu);
+
+  /**
+   * @brief Invalidates the addresses of a queued write until its result is known.
+   * @details Keeps a later write of the previous values from being suppressed while this one is pending. Numbers the
+   *          write so that an older write completing meanwhile does not make the addresses known again.
+   * @param pdu Queued request.
+   */
+  void expect(PDU* pdu);
+
+  /**
+   * @brief Records the result of a completed request.
+   * @param pdu Completed request.
+   */
+  void acknowledge(const PDU* pdu);
+
+ public:
+  /**
+   * @brief Default constructor.
+   * @details Initializes an empty shadow.
+   */
+  WriteShadow();
+
+  /**
+   * @brief Destructor.
+   * @details Frees the ranges.
+   */
+  ~WriteShadow();
+
+  /**
+   * @brief Allocates the range array.
+   * @param rangeSize Maximum number of shadowed ranges.
+   * @param refreshMs Interval after which an unchanged write is sent anyway (ms, default: 0 = never).
+   */
+  void begin(uint8_t rangeSize, uint32_t refreshMs = 0);
+
+  /**
+   * @brief Adds a shadowed range, all values start unknown.
+   * @param slave Slave ID (1–247).
+   * @param table MB_TABLE_COILS or MB_TABLE_HOLDING_REGISTERS.
+   * @param address First address.
+   * @param quantity Number of registers or coils.
+   * @return uint16_t Error code (MB_EX_LIB_INVALID_SLAVE, MB_EX_LIB_INVALID_ARGUMENT, MB_EX_LIB_BUFFER_IS_TOO_SMALL) or 0
+   *         if successful.
+   */
+  uint16_t addRange(uint8_t slave, uint8_t table, uint16_t address, uint16_t quantity);
+
+  /**
+   * @brief Sets the forced refresh interval.
+   * @param refreshMs Interval after which an unchanged write is sent anyway (ms, 0 = never).
+   */
+  void setRefreshInterval(uint32_t refreshMs);
+
+  /**
+   * @brief Forgets every value of a slave, e.g. after the device restarted.
+   * @param slave Slave ID.
+   */
+  void invalidate(uint8_t slave);
+
+  /**
+   * @brief Forgets the values of an address range.
+   * @param slave Slave ID.
+   * @param table MB_TABLE_COILS or MB_TABLE_HOLDING_REGISTERS.
+   * @param address First address.
+   * @param quantity Number of registers or coils.
+   */
+  void invalidate(uint8_t slave, uint8_t table, uint16_t address, uint16_t quantity);
+
+  /**
+   * @brief Returns the number of writes completed without a transaction.
+   * @return uint32_t Suppressed writes.
+   */
+  uint32_t getSuppressedCount() const;
+};
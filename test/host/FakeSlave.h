@@ -0,0 +1,108 @@
+/**
+ * @file FakeSlave.h
+ * @brief RTU slave on a loopback stream, answering the requests of a ModbusRTUMaster from its register image.
+ */
+
+#pragma once
+#include <Crc16.h>
+#include <ModbusMaster.h>
+
+#include "check.h"
+
+/**
+ * @class FakeSlave
+ * @brief Answers FC 0x01–0x04, 0x0F and 0x10 for every unit ID from one image, other functions with exception 1.
+ */
+class FakeSlave : public Stream {
+ private:
+  uint8_t _request[260];     ///< Frame being written by the master.
+  uint16_t _requestLen = 0;  ///< Bytes of _request.
+  uint8_t _response[260];    ///< Frame read by the master.
+  uint16_t _responseLen = 0; ///< Bytes of _response.
+  uint16_t _responsePos = 0; ///< Next byte of _response to read.
+
+  void respond() {
+    uint8_t* r = _response;
+    const uint8_t* q = _request;
+    uint16_t addr = (q[2] << 8) | q[3];
+    uint16_t count = (q[4] << 8) | q[5];
+    r[0] = q[0];
+    r[1] = q[1];
+    _responseLen = 2;
+    bool data = q[1] <= 0x04 || q[1] == 0x0F || q[1] == 0x10;
+    if (data && addr + count > 512) {
+      r[1] |= 0x80;
+      r[_responseLen++] = MB_EX_ILLEGAL_DATA_ADDRESS;
+    } else if (q[1] == 0x01 || q[1] == 0x02) {
+      r[_responseLen++] = (count + 7) / 8;
+      memset(r + _responseLen, 0, (count + 7) / 8);
+      for (uint16_t i = 0; i < count; i++) r[_responseLen + i / 8] |= coils[addr + i] << (i % 8);
+      _responseLen += (count + 7) / 8;
+    } else if (q[1] == 0x03 || q[1] == 0x04) {
+      r[_responseLen++] = count * 2;
+      for (uint16_t i = 0; i < count; i++) {
+        r[_responseLen++] = regs[addr + i] >> 8;
+        r[_responseLen++] = regs[addr + i] & 0xFF;
+      }
+    } else if (q[1] == 0x0F || q[1] == 0x10) {
+      for (uint16_t i = 0; i < count; i++) {
+        if (q[1] == 0x0F) coils[addr + i] = (q[7 + i / 8] >> (i % 8)) & 0x01;
+        else regs[addr + i] = (q[7 + 2 * i] << 8) | q[8 + 2 * i];
+      }
+      memcpy(r + 2, q + 2, 4);
+      _responseLen = 6;
+    } else {
+      r[1] |= 0x80;
+      r[_responseLen++] = MB_EX_ILLEGAL_FUNCTION;
+    }
+    crc16Set(r, _responseLen);
+    _responseLen += 2;
+    _responsePos = 0;
+  }
+
+ public:
+  uint16_t regs[512] = {};  ///< Holding and input registers.
+  uint8_t coils[512] = {};  ///< Coils and discrete inputs.
+  uint16_t requests = 0;    ///< Requests answered.
+  uint8_t lastRequest[260];    ///< Last frame written by the master.
+  uint16_t lastRequestLen = 0; ///< Bytes of lastRequest.
+
+  size_t write(uint8_t b) override {
+    if (_requestLen < sizeof(_request)) _request[_requestLen++] = b;
+    return 1;
+  }
+
+  size_t write(const uint8_t* buffer, size_t size) override {
+    for (size_t i = 0; i < size; i++) write(buffer[i]);
+    return size;
+  }
+
+  void flush() override {
+    if (!_requestLen) return;
+    memcpy(lastRequest, _request, _requestLen);
+    lastRequestLen = _requestLen;
+    if (crc16Check(_request, _requestLen) && _request[0] != 0) {
+      respond();
+      requests++;
+    }
+    _requestLen = 0;
+  }
+
+  int available() override { return _responseLen - _responsePos; }
+
+  int read() override { return _responsePos < _responseLen ? _response[_responsePos++] : -1; }
+
+  int peek() override { return _responsePos < _responseLen ? _response[_responsePos] : -1; }
+};
+
+/**
+ * @brief Runs the master loop while the clock advances.
+ * @param master Master to run.
+ * @param ms Simulated time (ms).
+ */
+inline void runFor(ModbusMaster& master, uint32_t ms) {
+  for (uint32_t i = 0; i < ms * 10; i++) {
+    advanceTime(100);
+    master.loop();
+  }
+}
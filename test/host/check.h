@@ -0,0 +1,38 @@
+/**
+ * @file check.h
+ * @brief Assertions of the host tests. A failed check is reported and counted, main() returns checkResult().
+ */
+
+#pragma once
+#include <Arduino.h>
+
+extern int checkFailures;
+
+/**
+ * @brief Reports the failed checks.
+ * @return int Exit code, 1 if a check failed, 0 otherwise.
+ */
+int checkResult();
+
+/**
+ * @brief Advances the clock returned by millis() and micros().
+ * @param us Microseconds.
+ */
+void advanceTime(uint32_t us);
+
+#define CHECK(cond)                                                   \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      checkFailures++;                                                \
+    }                                                                 \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                               \
+  do {                                                                                                           \
+    long long a_ = static_cast<long long>(actual), e_ = static_cast<long long>(expected);                       \
+    if (a_ != e_) {                                                                                              \
+      printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #actual, #expected, a_, e_); \
+      checkFailures++;                                                                                           \
+    }                                                                                                            \
+  } while (0)
@@ -0,0 +1,29 @@
+/**
+ * @file host.cpp
+ * @brief Clock and serial port of the host build. Tests advance the clock with advanceTime().
+ */
+
+#include <Arduino.h>
+
+#include "check.h"
+
+static uint32_t nowUs = 1000000;
+
+uint32_t millis() { return nowUs / 1000; }
+
+uint32_t micros() { return nowUs; }
+
+void advanceTime(uint32_t us) { nowUs += us; }
+
+HardwareSerial Serial;
+
+int checkFailures = 0;
+
+int checkResult() {
+  if (checkFailures) {
+    printf("%d check(s) failed\n", checkFailures);
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file Arduino.h
+ * @brief Minimal stand-in for the Arduino core, enough to build the library on the host.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <initializer_list>
+
+typedef bool boolean;
+
+#define HEX 16
+#define OUTPUT 1
+#define HIGH 1
+#define LOW 0
+#define PROGMEM
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define lowByte(w) ((uint8_t)((w) & 0xff))
+
+uint32_t millis();
+uint32_t micros();
+inline void pinMode(int, int) {}
+inline void digitalWrite(int, int) {}
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  virtual void flush() {}
+  void print(int v, int = 10) { printf("%d", v); }
+  void print(const char* s) { printf("%s", s); }
+  void println() { printf("\n"); }
+  void println(int v) { printf("%d\n", v); }
+  void println(const char* s) { printf("%s\n", s); }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  size_t readBytes(uint8_t* buffer, size_t length) {
+    size_t n = 0;
+    while (n < length && available()) buffer[n++] = read();
+    return n;
+  }
+};
+
+class IPAddress {
+ public:
+  IPAddress() {}
+  IPAddress(uint8_t, uint8_t, uint8_t, uint8_t) {}
+};
+
+class HardwareSerial : public Stream {
+ public:
+  void begin(uint32_t) {}
+  size_t write(uint8_t) override { return 1; }
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
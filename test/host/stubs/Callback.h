@@ -0,0 +1,21 @@
+/**
+ * @file Callback.h
+ * @brief Minimal stand-in for the Callback library (function pointers and captureless lambdas only).
+ */
+
+#pragma once
+
+template <typename RET, typename... ARGS>
+class Callback {
+ private:
+  RET (*_fn)(ARGS...) = nullptr;
+
+ public:
+  Callback() {}
+  Callback(RET (*fn)(ARGS...)) : _fn(fn) {}
+  template <typename L>
+  Callback(L fn) : _fn(static_cast<RET (*)(ARGS...)>(fn)) {}
+  bool valid() const { return _fn != nullptr; }
+  void clear() { _fn = nullptr; }
+  RET operator()(ARGS... args) const { return _fn(args...); }
+};
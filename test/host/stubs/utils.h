@@ -0,0 +1,21 @@
+/**
+ * @file utils.h
+ * @brief Minimal stand-in for the interval helpers of the utils library.
+ */
+
+#pragma once
+#include <Arduino.h>
+
+inline bool on_ms(uint32_t* last, uint32_t interval, bool reset) {
+  uint32_t now = millis();
+  if (now - *last < interval) return false;
+  if (reset) *last = now;
+  return true;
+}
+
+inline bool on_us(uint32_t* last, uint32_t interval, bool reset) {
+  uint32_t now = micros();
+  if (now - *last < interval) return false;
+  if (reset) *last = now;
+  return true;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file test_coil_bits.cpp
+ * @brief CoilBits: the bitset view on its own and over coil responses packed and unpacked by the master.
+ */
+
+#include <CoilBits.h>
+#include <ModbusRTUMaster.h>
+
+#include "FakeSlave.h"
+#include "check.h"
+
+static uint16_t lastErr = 0;
+static uint16_t bitCount = 0;
+static uint16_t setCount = 0;
+static uint16_t firstSet = 0;
+static bool bools[MB_MAX_READ_COILS];
+
+static void onWrite(PDU& pdu) { lastErr = pdu.getErr(); }
+
+static void onRead(PDU& pdu) {
+  lastErr = pdu.getErr();
+  CoilBits bits = pdu.getBits();
+  bitCount = bits.size();
+  setCount = bits.count();
+  firstSet = bits.next(0);
+  CHECK_EQ(bits.copyTo(bools, MB_MAX_READ_COILS), bitCount);
+}
+
+static void testView() {
+  // Bits 0, 2, 9, 15, 64 and 69 of 70.
+  const uint8_t data[9] = {0x05, 0x82, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE1};
+  CoilBits bits(data, 70);
+  CHECK_EQ(bits.size(), 70);
+  CHECK(bits.data() == data);
+  CHECK(bits[0] && !bits[1] && bits[2] && bits[9] && bits[15] && bits[64]);
+  CHECK(bits.test(69));
+  CHECK(!bits.test(70));  // Bits 70 and 71 of the last byte are padding
+  CHECK_EQ(bits.count(), 6);
+
+  uint16_t found[8];
+  uint16_t n = 0;
+  for (uint16_t i = bits.next(0); i < bits.size() && n < 8; i = bits.next(i + 1)) found[n++] = i;
+  CHECK_EQ(n, 6);
+  CHECK(found[0] == 0 && found[1] == 2 && found[2] == 9 && found[3] == 15 && found[4] == 64 && found[5] == 69);
+  CHECK_EQ(bits.next(70), 70);
+
+  bool dst[4];
+  CHECK_EQ(bits.copyTo(dst, 4, 8), 4);
+  CHECK(!dst[0] && dst[1] && !dst[2] && !dst[3]);
+  CHECK_EQ(bits.copyTo(dst, 4, 68), 2);
+
+  uint64_t words[3] = {~0ULL, ~0ULL, ~0ULL};
+  CHECK_EQ(bits.copyTo(words, 3), 2);
+  CHECK(words[0] == ((1ULL << 0) | (1ULL << 2) | (1ULL << 9) | (1ULL << 15)));
+  CHECK(words[1] == ((1ULL << 0) | (1ULL << 5)));
+  CHECK(words[2] == ~0ULL);
+
+  CoilBits empty(nullptr, 0);
+  CHECK_EQ(empty.size(), 0);
+  CHECK_EQ(empty.count(), 0);
+  CHECK_EQ(empty.next(0), 0);
+}
+
+static void testMaster() {
+  FakeSlave slave;
+  ModbusRTUMaster master;
+  master.begin(253, 4, &slave, 9600);
+
+  for (uint16_t i = 0; i < 512; i++) slave.coils[i] = (i % 7) == 3;
+  master.readCoils(1, 0, 500, modbusCallback(onRead));
+  runFor(master, 50);
+  CHECK_EQ(lastErr, 0);
+  CHECK_EQ(bitCount, 500);
+  CHECK_EQ(setCount, 71);
+  CHECK_EQ(firstSet, 3);
+  bool same = true;
+  for (uint16_t i = 0; i < 500; i++) same &= bools[i] == slave.coils[i];
+  CHECK(same);
+
+  // 13 bits from an unaligned address, the last byte is partly padding.
+  master.readDiscreteInputs(1, 5, 13, modbusCallback(onRead));
+  runFor(master, 50);
+  CHECK_EQ(lastErr, 0);
+  CHECK_EQ(bitCount, 13);
+  CHECK_EQ(setCount, 2);
+  CHECK_EQ(firstSet, 5);
+
+  bool values[100];
+  for (uint16_t i = 0; i < 100; i++) values[i] = i % 3 == 0;
+  master.writeCoils(1, 100, values, 100, modbusCallback(onWrite));
+  runFor(master, 50);
+  CHECK_EQ(lastErr, 0);
+  same = true;
+  for (uint16_t i = 0; i < 100; i++) same &= slave.coils[100 + i] == values[i];
+  CHECK(same);
+}
+
+int main() {
+  testView();
+  testMaster();
+  return checkResult();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_poll_plan.cpp
+ * @brief PollPlan: compiling a tag list, and polling from a plan image written, checked and loaded in place.
+ */
+
+#include <ModbusRTUMaster.h>
+#include <PollPlan.h>
+
+#include "FakeSlave.h"
+#include "check.h"
+
+alignas(4) static uint8_t image[512];
+alignas(4) static uint8_t damaged[512];
+static uint32_t imageSize = 0;
+static uint16_t delivered = 0;
+
+static void onTag(const PollTag& tag) { delivered++; }
+
+static void poll(ModbusMaster& master, PollPlan& plan, uint32_t ms) {
+  for (uint32_t i = 0; i < ms * 10; i++) {
+    advanceTime(100);
+    plan.loop();
+    master.loop();
+  }
+}
+
+static uint32_t fnv1a(const uint8_t* data, uint32_t size) {
+  uint32_t hash = 2166136261UL;
+  for (uint32_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 16777619UL;
+  return hash;
+}
+
+static void checkValues(const PollPlan& plan) {
+  CHECK_EQ(plan.getTagCount(), 3);
+  for (uint16_t i = 0; i < plan.getTagCount(); i++) {
+    CHECK(plan.getTag(i)->hasValue());
+    CHECK_EQ(plan.getTag(i)->getErr(), 0);
+  }
+  CHECK_EQ(plan.getTag(0)->getRaw(), 0x1234);
+  CHECK_EQ(plan.getTag(1)->getRaw(), 0x00010002);
+  CHECK(plan.getTag(2)->getBool());
+}
+
+static void testCompile(ModbusMaster& master) {
+  PollPlan plan;
+  CHECK_EQ(plan.begin(&master, 8, 4), 0);
+  CHECK_EQ(plan.addTag(1, MB_TABLE_HOLDING_REGISTERS, 10, MB_TAG_UINT16, 1000, tagCallback(onTag)), 0);
+  CHECK_EQ(plan.addTag(1, MB_TABLE_HOLDING_REGISTERS, 12, MB_TAG_UINT32, 1000, tagCallback(onTag)), 0);
+  CHECK_EQ(plan.addTag(1, MB_TABLE_COILS, 3, MB_TAG_BOOL, 1000, tagCallback(onTag)), 0);
+  CHECK_EQ(plan.writeImage(image, sizeof(image)), MB_EX_LIB_INVALID_ARGUMENT);
+  CHECK_EQ(plan.compile(), 0);
+
+  // The registers 10–13 are read by one request, the coil by another.
+  CHECK_EQ(plan.getBlockCount(), 2);
+  uint8_t slave = 0, table = 0;
+  uint16_t address = 0, quantity = 0;
+  uint32_t period = 0;
+  bool found = false;
+  for (uint16_t i = 0; i < plan.getBlockCount(); i++) {
+    CHECK(plan.getBlock(i, slave, table, address, quantity, period));
+    if (table != MB_TABLE_HOLDING_REGISTERS) continue;
+    found = true;
+    CHECK_EQ(address, 10);
+    CHECK_EQ(quantity, 4);
+    CHECK_EQ(period, 1000);
+  }
+  CHECK(found);
+
+  delivered = 0;
+  poll(master, plan, 100);
+  CHECK_EQ(delivered, 3);
+  checkValues(plan);
+
+  imageSize = plan.getImageSize();
+  CHECK(imageSize > sizeof(PollImageHeader) && imageSize <= sizeof(image));
+  CHECK_EQ(plan.writeImage(image, imageSize - 1), MB_EX_LIB_BUFFER_IS_TOO_SMALL);
+  CHECK_EQ(plan.writeImage(image, sizeof(image)), 0);
+  CHECK_EQ(plan.loadImage(&master, image, imageSize), MB_EX_LIB_NOT_SUPPORTED);
+}
+
+static void testLoad(ModbusMaster& master) {
+  PollPlan plan;
+  plan.setCallback(tagCallback(onTag));
+  CHECK_EQ(plan.loadImage(&master, image, imageSize), 0);
+  CHECK_EQ(plan.loadImage(&master, image, imageSize), MB_EX_LIB_NOT_SUPPORTED);
+  CHECK_EQ(plan.addTag(1, MB_TABLE_HOLDING_REGISTERS, 20, MB_TAG_UINT16, 1000), MB_EX_LIB_NOT_SUPPORTED);
+  CHECK_EQ(plan.getBlockCount(), 2);
+
+  delivered = 0;
+  poll(master, plan, 100);
+  CHECK_EQ(delivered, 3);
+  checkValues(plan);
+}
+
+static uint16_t loadDamaged(ModbusMaster& master, uint32_t offset, uint8_t value, bool fixChecksum) {
+  memcpy(damaged, image, imageSize);
+  damaged[offset] = value;
+  PollImageHeader* header = reinterpret_cast<PollImageHeader*>(damaged);
+  if (fixChecksum) header->checksum = fnv1a(damaged + header->headerSize, imageSize - header->headerSize);
+  PollPlan plan;
+  return plan.loadImage(&master, damaged, imageSize);
+}
+
+static void testDamaged(ModbusMaster& master) {
+  const PollImageHeader* header = reinterpret_cast<const PollImageHeader*>(image);
+  uint32_t blocks = header->headerSize;
+  uint32_t tags = blocks + header->blockCount * header->blockSize;
+
+  PollPlan plan;
+  CHECK_EQ(plan.loadImage(&master, image + 2, imageSize), MB_EX_LIB_INVALID_ARGUMENT);
+  CHECK_EQ(plan.loadImage(&master, image, imageSize - 1), MB_EX_LIB_BUFFER_IS_TOO_SMALL);
+  CHECK_EQ(loadDamaged(master, offsetof(PollImageHeader, version), MB_PLAN_VERSION + 1, false), MB_EX_LIB_NOT_SUPPORTED);
+  CHECK_EQ(loadDamaged(master, tags + offsetof(PollImageTag, offset), 0x7F, false), MB_EX_LIB_INVALID_DATA);
+  // With a valid checksum the records themselves are still checked against their requests.
+  CHECK_EQ(loadDamaged(master, tags + offsetof(PollImageTag, offset), 0x7F, true), MB_EX_LIB_INVALID_DATA);
+  CHECK_EQ(loadDamaged(master, blocks + offsetof(PollImageBlock, request), 0x10, true), MB_EX_LIB_INVALID_DATA);
+  CHECK_EQ(loadDamaged(master, blocks + offsetof(PollImageBlock, responseBytes), 0xFF, true), MB_EX_LIB_INVALID_DATA);
+}
+
+int main() {
+  FakeSlave slave;
+  slave.regs[10] = 0x1234;
+  slave.regs[12] = 0x0001;
+  slave.regs[13] = 0x0002;
+  slave.coils[3] = 1;
+  ModbusRTUMaster master;
+  master.begin(64, 4, &slave, 9600);
+
+  testCompile(master);
+  testLoad(master);
+  testDamaged(master);
+  return checkResult();
+}
@@ -0,0 +1,71 @@
+/**
+ * @file test_register_store.cpp
+ * @brief RegisterStore: dense ranges, scattered addresses and bit tables.
+ */
+
+#include <RegisterStore.h>
+
+#include "check.h"
+
+static void testRegisters() {
+  RegisterStore store;
+  CHECK_EQ(store.begin(4, 8), 0);
+  CHECK_EQ(store.begin(4, 8), MB_EX_LIB_NOT_SUPPORTED);
+  CHECK_EQ(store.addRange(1, MB_TABLE_HOLDING_REGISTERS, 100, 10), 0);
+  CHECK_EQ(store.addRange(1, MB_TABLE_HOLDING_REGISTERS, 105, 2), MB_EX_LIB_INVALID_ARGUMENT);
+  CHECK_EQ(store.addAddress(1, MB_TABLE_HOLDING_REGISTERS, 110), 0);
+  CHECK_EQ(store.addAddress(1, MB_TABLE_HOLDING_REGISTERS, 104), MB_EX_LIB_INVALID_ARGUMENT);
+
+  // A range may span a segment and the scattered address right after it.
+  CHECK(store.contains(1, MB_TABLE_HOLDING_REGISTERS, 100, 11));
+  CHECK(!store.contains(1, MB_TABLE_HOLDING_REGISTERS, 100, 12));
+  CHECK(!store.contains(2, MB_TABLE_HOLDING_REGISTERS, 100, 1));
+  CHECK(!store.contains(1, MB_TABLE_INPUT_REGISTERS, 100, 1));
+
+  uint8_t src[22];
+  for (uint8_t i = 0; i < sizeof(src); i++) src[i] = i;
+  CHECK_EQ(store.write(1, MB_TABLE_HOLDING_REGISTERS, 100, 11, src), 0);
+
+  uint8_t dst[22] = {};
+  CHECK_EQ(store.read(1, MB_TABLE_HOLDING_REGISTERS, 101, 10, dst), 0);
+  CHECK(memcmp(dst, src + 2, 20) == 0);
+  CHECK_EQ(store.read(1, MB_TABLE_HOLDING_REGISTERS, 101, 11, dst), MB_EX_ILLEGAL_DATA_ADDRESS);
+
+  uint16_t value = 0;
+  CHECK_EQ(store.getRegister(1, MB_TABLE_HOLDING_REGISTERS, 110, value), 0);
+  CHECK_EQ(value, 0x1415);
+  CHECK_EQ(store.setRegister(1, MB_TABLE_HOLDING_REGISTERS, 102, 0xABCD), 0);
+  const uint8_t* ptr = store.rangePtr(1, MB_TABLE_HOLDING_REGISTERS, 102, 3);
+  CHECK(ptr != nullptr);
+  if (ptr) CHECK(ptr[0] == 0xAB && ptr[1] == 0xCD && ptr[2] == 6);
+  CHECK(store.rangePtr(1, MB_TABLE_HOLDING_REGISTERS, 108, 3) == nullptr);
+}
+
+static void testBits() {
+  RegisterStore store;
+  store.begin(2, 2);
+  CHECK_EQ(store.addRange(1, MB_TABLE_COILS, 3, 20), 0);
+
+  // Unaligned writes and reads shift the packed bits.
+  const uint8_t src[3] = {0xA5, 0x3C, 0x0F};
+  CHECK_EQ(store.write(1, MB_TABLE_COILS, 5, 18, src), 0);
+  uint8_t dst[3] = {0xFF, 0xFF, 0xFF};
+  CHECK_EQ(store.read(1, MB_TABLE_COILS, 5, 18, dst), 0);
+  CHECK(dst[0] == 0xA5 && dst[1] == 0x3C && dst[2] == 0x03);
+  CHECK_EQ(store.read(1, MB_TABLE_COILS, 3, 20, dst), 0);
+  CHECK(dst[0] == 0x94 && dst[1] == 0xF2 && dst[2] == 0x0C);
+
+  bool bit = false;
+  CHECK_EQ(store.getBit(1, MB_TABLE_COILS, 5, bit), 0);
+  CHECK(bit);
+  CHECK_EQ(store.setBit(1, MB_TABLE_COILS, 5, false), 0);
+  CHECK_EQ(store.getBit(1, MB_TABLE_COILS, 5, bit), 0);
+  CHECK(!bit);
+  CHECK(store.getBit(1, MB_TABLE_DISCRETE_INPUTS, 5, bit) != 0);
+}
+
+int main() {
+  testRegisters();
+  testBits();
+  return checkResult();
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_scaling_table.cpp
+ * @brief ScalingTable: entry validation and conversion of register images and responses.
+ */
+
+#include <ModbusRTUMaster.h>
+#include <ScalingTable.h>
+
+#include "FakeSlave.h"
+#include "check.h"
+
+static uint16_t lastErr = 0;
+
+static void onRead(PDU& pdu) { lastErr = pdu.getErr(); }
+
+static bool near(double a, double b) { return a - b < 1e-3 && b - a < 1e-3; }
+
+// Registers 0–8: 1234, -200, 65536 (2 registers), -2 (2 registers), 2.5f (2 registers), 5.
+static void fill(uint16_t* regs) {
+  const uint16_t values[9] = {1234, 0xFF38, 0x0001, 0x0000, 0xFFFF, 0xFFFE, 0x4020, 0x0000, 5};
+  memcpy(regs, values, sizeof(values));
+}
+
+static void addEntries(ScalingTable& table) {
+  CHECK_EQ(table.add(6, MB_TAG_FLOAT, 2, 1), 0);
+  CHECK_EQ(table.add(0, MB_TAG_UINT16, 0.1f), 0);
+  CHECK_EQ(table.add(1, MB_TAG_INT16), 0);
+  CHECK_EQ(table.add(2, MB_TAG_UINT32), 0);
+  CHECK_EQ(table.add(4, MB_TAG_INT32), 0);
+  CHECK_EQ(table.add(8, MB_TAG_BOOL, 1, 0, 6), 0);
+}
+
+template <typename T>
+static void checkOutput(const T* out) {
+  CHECK(near(out[0], 6));  // 2.5 * 2 + 1
+  CHECK(near(out[1], 123.4));
+  CHECK(near(out[2], -200));
+  CHECK(near(out[3], 65536));
+  CHECK(near(out[4], -2));
+  CHECK(near(out[5], -99));  // No entry, left unchanged
+  CHECK(near(out[6], 1));
+}
+
+static void testTable() {
+  ScalingTable table;
+  CHECK_EQ(table.add(0, MB_TAG_UINT16), MB_EX_LIB_BUFFER_IS_TOO_SMALL);
+  CHECK_EQ(table.begin(8), 0);
+  CHECK_EQ(table.begin(8), MB_EX_LIB_NOT_SUPPORTED);
+  addEntries(table);
+  CHECK_EQ(table.add(0, MB_TAG_FLOAT + 1), MB_EX_LIB_INVALID_ARGUMENT);
+  CHECK_EQ(table.add(0xFFFE, MB_TAG_INT32), MB_EX_LIB_INVALID_ARGUMENT);  // Would end beyond register 0xFFFF
+  CHECK_EQ(table.getCount(), 6);
+  CHECK_EQ(table.getRegisters(), 9);
+  CHECK_EQ(table.getSlots(), 7);
+
+  uint16_t regs[9];
+  fill(regs);
+  uint8_t wire[18];
+  for (uint8_t i = 0; i < 9; i++) {
+    wire[2 * i] = regs[i] >> 8;
+    wire[2 * i + 1] = regs[i] & 0xFF;
+  }
+  float out[7];
+  for (float& v : out) v = -99;
+  CHECK_EQ(table.apply(wire, 9, out), 0);
+  checkOutput(out);
+  CHECK_EQ(table.apply(wire, 8, out), MB_EX_LIB_INVALID_BYTE_LENGTH);
+
+  table.clear();
+  CHECK_EQ(table.getCount(), 0);
+  CHECK_EQ(table.getSlots(), 0);
+  CHECK_EQ(table.add(0, MB_TAG_UINT16), 0);
+}
+
+static void testMaster() {
+  FakeSlave slave;
+  fill(slave.regs);
+  ModbusRTUMaster master;
+  master.begin(64, 4, &slave, 9600);
+  ScalingTable table;
+  table.begin(8);
+  addEntries(table);
+
+  float out[7];
+  for (float& v : out) v = -99;
+  lastErr = 0xFFFF;
+  master.readHoldingRegisters(1, 0, 9, table, out, modbusCallback(onRead));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  checkOutput(out);
+
+  // Doubles keep the full precision of 32-bit integers.
+  double dbl[7];
+  for (double& v : dbl) v = -99;
+  lastErr = 0xFFFF;
+  master.readInputRegisters((uint8_t)1, 0, 9, table, dbl, modbusCallback(onRead));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  checkOutput(dbl);
+
+  lastErr = 0xFFFF;
+  master.readHoldingRegisters(1, 0, 8, table, out, modbusCallback(onRead));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, MB_EX_LIB_INVALID_ARGUMENT);
+}
+
+int main() {
+  testTable();
+  testMaster();
+  return checkResult();
+}
@@ -0,0 +1,94 @@
+/**
+ * @file test_word_order.cpp
+ * @brief Ordered<T, ORDER>: register layout of written values and decoding of read ones.
+ */
+
+#include <ModbusRTUMaster.h>
+
+#include "FakeSlave.h"
+#include "check.h"
+
+typedef Ordered<double, MB_ORDER_CDAB> DoubleCDAB;
+typedef Ordered<uint32_t, MB_ORDER_ABCD> UintABCD;
+typedef Ordered<uint32_t, MB_ORDER_CDAB> UintCDAB;
+
+static float readFloat = 0;
+static double readDouble = 0;
+static uint32_t readUint = 0;
+static uint16_t lastErr = 0;
+
+static void onWrite(PDU& pdu) { lastErr = pdu.getErr(); }
+
+static void onFloat(PDU& pdu) {
+  lastErr = pdu.getErr();
+  readFloat = pdu.getDataArray<float>()[0];
+}
+
+static void onDouble(PDU& pdu) {
+  lastErr = pdu.getErr();
+  readDouble = pdu.getData<DoubleCDAB>(0).value;
+}
+
+static void onUint(PDU& pdu) {
+  lastErr = pdu.getErr();
+  readUint = pdu.getDataArray<uint32_t>()[0];
+}
+
+template <uint8_t ORDER>
+static void checkFloat(ModbusMaster& master, FakeSlave& slave, uint16_t addr, uint16_t high, uint16_t low) {
+  typedef Ordered<float, ORDER> FloatOrdered;
+  const FloatOrdered value[1] = {{1.0f}};
+  lastErr = 0xFFFF;
+  master.writeHoldingRegisters(1, addr, value, 1, modbusCallback(onWrite));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  CHECK_EQ(slave.regs[addr], high);
+  CHECK_EQ(slave.regs[addr + 1], low);
+
+  readFloat = 0;
+  lastErr = 0xFFFF;
+  master.readHoldingRegisters<FloatOrdered>(1, addr, 1, modbusCallback(onFloat));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  CHECK(readFloat == 1.0f);
+}
+
+int main() {
+  FakeSlave slave;
+  ModbusRTUMaster master;
+  master.begin(64, 4, &slave, 9600);
+
+  // 1.0f is 0x3F800000: A = 0x3F, B = 0x80, C = D = 0x00.
+  checkFloat<MB_ORDER_ABCD>(master, slave, 0, 0x3F80, 0x0000);
+  checkFloat<MB_ORDER_CDAB>(master, slave, 2, 0x0000, 0x3F80);
+  checkFloat<MB_ORDER_BADC>(master, slave, 4, 0x803F, 0x0000);
+  checkFloat<MB_ORDER_DCBA>(master, slave, 6, 0x0000, 0x803F);
+
+  // 64-bit values keep the rule per register: MB_ORDER_CDAB sends the lowest register first.
+  const DoubleCDAB value[1] = {{3.25}};
+  lastErr = 0xFFFF;
+  master.writeHoldingRegisters(1, 20, value, 1, modbusCallback(onWrite));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  CHECK_EQ(slave.regs[20], 0x0000);
+  CHECK_EQ(slave.regs[23], 0x400A);
+  lastErr = 0xFFFF;
+  master.readHoldingRegisters<DoubleCDAB>(1, 20, 1, modbusCallback(onDouble));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  CHECK(readDouble == 3.25);
+
+  slave.regs[30] = 0x1234;
+  slave.regs[31] = 0x5678;
+  lastErr = 0xFFFF;
+  master.readHoldingRegisters<UintABCD>(1, 30, 1, modbusCallback(onUint));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  CHECK_EQ(readUint, 0x12345678);
+  lastErr = 0xFFFF;
+  master.readHoldingRegisters<UintCDAB>(1, 30, 1, modbusCallback(onUint));
+  runFor(master, 20);
+  CHECK_EQ(lastErr, 0);
+  CHECK_EQ(readUint, 0x56781234);
+  return checkResult();
+}